@@ -0,0 +1,75 @@
+#ifndef BACKGROUNDTASK_H
+#define BACKGROUNDTASK_H
+
+#include <QObject>
+#include <QString>
+#include <functional>
+#include <memory>
+
+class QThreadPool;
+struct BackgroundTaskState;
+
+// Runs a unit of work on a thread pool and reports back on the owner's
+// thread. Starting again or destroying the task detaches the previous run,
+// so its late progress/finished notifications are dropped. Neither waits for
+// the run to return, so work must own (or share) everything it touches.
+class BackgroundTask : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Handed to the work function on the pool thread
+    class Control
+    {
+    public:
+        bool isCancelled() const;
+        void reportProgress(double percent, const QString &status = QString());
+        // Runs function on the owner's thread, unless the run has been detached by then
+        void post(const std::function<void()> &function);
+
+    private:
+        friend class BackgroundTask;
+        explicit Control(std::shared_ptr<BackgroundTaskState> state);
+        void dispatch(const std::function<void(BackgroundTask *owner)> &function);
+
+        std::shared_ptr<BackgroundTaskState> m_state;
+    };
+
+    using Work = std::function<void(Control &control)>;
+
+    explicit BackgroundTask(QObject *parent = nullptr);
+    ~BackgroundTask() override;
+
+    void start(Work work);
+    void cancel();
+    bool isRunning() const { return m_running; }
+    // The pool later start() calls run on; the global pool by default
+    void setThreadPool(QThreadPool *pool) { m_pool = pool; }
+
+    // For short reads the user is waiting on, such as grid blocks. Long COPY, SUMMARIZE and
+    // chart queries stay on the global pool, so they cannot take every thread these need.
+    static QThreadPool *interactivePool();
+
+    // Calls work(0) ... work(count - 1) on the calling thread and whichever pool threads are
+    // idle, and returns when every call has finished. It never waits for a busy pool, so
+    // work already running on the pool may call it.
+    static void parallelFor(int count, const std::function<void(int index)> &work);
+    // Drops this reference to retired on a pool thread; freeing millions of result cells takes
+    // long enough to stall the GUI. Data still shared with another holder just loses a reference.
+    static void release(std::shared_ptr<void> retired);
+
+signals:
+    void progress(double percent, const QString &status);
+    void finished(bool cancelled);
+
+private:
+    void detachCurrent();
+
+    std::shared_ptr<BackgroundTaskState> m_state;
+    QThreadPool *m_pool;
+    bool m_running;
+
+    static constexpr int INTERACTIVE_THREADS = 4;
+};
+
+#endif // BACKGROUNDTASK_H
@@ -0,0 +1,70 @@
+#ifndef CHARTDATACACHE_H
+#define CHARTDATACACHE_H
+
+#include <QCache>
+#include <QImage>
+#include <QList>
+#include <QPointF>
+#include <QSize>
+#include <QString>
+#include <memory>
+#include "chartmanager.h"
+
+// Prepared chart data shared by every chart of every tab, keyed by the result it was
+// computed from and the chart settings. Switching a chart back to earlier settings,
+// adding a chart that shows the same thing or zooming back out reuses the entry
+// instead of reading the result again. Used from the GUI thread only.
+class ChartDataCache
+{
+public:
+    struct Key {
+        quint64 resultId = 0;      // ResultsTableModel::resultId() of the charted result
+        QString sourceQuery;
+        int chartType = 0;
+        QString xColumn;
+        QString yColumn;
+        QString groupBy;
+        int aggregation = 0;
+        int bins = 0;
+        int binning = 0;
+        bool density = false;
+        QSize size;                // Line buckets or density cells, which follow the plot size
+        bool zoomed = false;
+        double minX = 0.0;
+        double maxX = 0.0;
+
+        bool operator==(const Key &other) const;
+    };
+
+    // Everything a chart is drawn from, computed off the GUI thread
+    struct Entry {
+        ChartManager::ChartData chartData;
+        QList<QPointF> points;           // Line or scatter points to draw
+        QList<QPointF> linePoints;       // Every loaded line point, kept for re-sampling
+        ChartManager::DensityGrid density;
+        QImage densityImage;
+        bool fromQuery = false;          // Computed by DuckDB over the source query
+        QString message;                 // Shown as the title instead of a chart
+    };
+
+    // The one cache for the process, so its budget does not grow with the number of tabs
+    static std::shared_ptr<ChartDataCache> shared();
+
+    bool find(const Key &key, Entry *entry) const;
+    void insert(const Key &key, const Entry &entry);
+    void remove(const Key &key);
+    // Drops every entry computed from resultId
+    void removeResult(quint64 resultId);
+
+private:
+    ChartDataCache();
+    static int costKb(const Entry &entry);
+
+    QCache<Key, Entry> m_entries;
+
+    static constexpr int MAX_COST_KB = 32 * 1024;
+};
+
+size_t qHash(const ChartDataCache::Key &key, size_t seed = 0);
+
+#endif // CHARTDATACACHE_H
@@ -12,9 +12,14 @@
 #include <QStringList>
 #include <QPair>
 #include <QDateTime>
+#include <QPointF>
+#include <QtMath>
 #include <memory>
 #include "duckdbmanager.h"
 
+class CompressedResult;
+class ChartDataCache;
+
 class ChartWidget;
 
 class ChartManager : public QWidget
@@ -32,6 +37,13 @@ public:
         StandardDeviation
     };
 
+    // How a histogram places its bin edges
+    enum BinningType {
+        EqualWidthBins,
+        LogScaleBins,     // Equal width in log10; values <= 0 are left out
+        QuantileBins      // Edges at approximate quantiles, so bins hold similar counts
+    };
+
     enum DataType {
         NumericType,
         StringType,
@@ -41,11 +53,16 @@ public:
 
     struct ColumnInfo {
         QString name;
-        DataType type;
-        int index;
-        double minValue;
-        double maxValue;
-        QStringList uniqueValues;  // For categorical data
+        DataType type = StringType;
+        int index = -1;
+        qint64 count = 0;           // Non-null values
+        qint64 nullCount = 0;
+        qint64 approxDistinct = 0;  // HyperLogLog estimate over the non-null values
+        double minValue = 0.0;      // Min, max, mean and variance are set for numeric columns
+        double maxValue = 0.0;
+        double mean = 0.0;
+        double variance = 0.0;      // Sample variance; 0 with fewer than two values
+        QStringList uniqueValues;   // For categorical data, at most MAX_UNIQUE_VALUES
     };
 
     struct ChartData {
@@ -56,53 +73,153 @@ public:
         QString xAxisTitle;
         QString yAxisTitle;
         QString chartTitle;
+        bool truncated = false;  // Only the first MAX_CHART_GROUPS groups were returned
+        QString timeBucket;      // Time series: the bucket x values start, e.g. "15 minutes"
+        QString timeUnit;        // Time series: the date part of the bucket (second ... year)
+        QString error;           // Set when DuckDB could not compute the chart
+    };
+
+    // Bars or slices beyond this many groups are left out of a chart
+    static constexpr int MAX_CHART_GROUPS = 1000;
+    // Values read to guess the type of a text column, and distinct labels kept per category column
+    static constexpr int TYPE_SNIFF_SAMPLE = 1000;
+    static constexpr int MAX_UNIQUE_VALUES = 100;
+
+    // Point counts of a scatter plot binned into a columns x rows grid over [minX, maxX] x [minY, maxY]
+    struct DensityGrid {
+        int columns = 0;
+        int rows = 0;
+        double minX = 0.0;
+        double maxX = 0.0;
+        double minY = 0.0;
+        double maxY = 0.0;
+        QList<double> counts;  // rows * columns, row 0 at minY
+        qint64 points = 0;
+        QString error;
     };
 
     explicit ChartManager(QWidget *parent = nullptr);
     ~ChartManager() override;
 
-    // Data analysis
-    QList<ColumnInfo> analyzeColumns(const DuckDBManager::QueryResult &results);
-    DataType detectColumnType(const QVariantList &columnData);
+    // Data analysis and preparation are static and keep no state, so chart widgets can run
+    // them on worker threads without a ChartManager
+    // One pass per column, columns in parallel; memory does not grow with the row count
+    static QList<ColumnInfo> analyzeColumns(const DuckDBManager::QueryResult &results);
+    // Looks at no more than TYPE_SNIFF_SAMPLE non-null values
+    static DataType detectColumnType(const QVariantList &columnData);
+    // Maps a DuckDB type name; *known is false for VARCHAR, ENUM and unknown types, whose values need sniffing
+    static DataType dataTypeForDuckDBType(const QString &type, bool *known = nullptr);
     
     // Data processing for charts
-    ChartData prepareBarChartData(const DuckDBManager::QueryResult &results, 
-                                  const QString &xColumn, const QString &yColumn,
-                                  const QString &groupBy = QString(),
-                                  AggregationType aggregation = NoAggregation);
+    static ChartData prepareBarChartData(const DuckDBManager::QueryResult &results, 
+                                         const QString &xColumn, const QString &yColumn,
+                                         const QString &groupBy = QString(),
+                                         AggregationType aggregation = NoAggregation);
     
-    ChartData prepareLineChartData(const DuckDBManager::QueryResult &results,
-                                   const QString &xColumn, const QString &yColumn,
-                                   const QString &groupBy = QString());
+    static ChartData prepareLineChartData(const DuckDBManager::QueryResult &results,
+                                          const QString &xColumn, const QString &yColumn,
+                                          const QString &groupBy = QString());
     
-    ChartData prepareScatterData(const DuckDBManager::QueryResult &results,
-                                 const QString &xColumn, const QString &yColumn,
-                                 const QString &colorBy = QString());
+    static ChartData prepareScatterData(const DuckDBManager::QueryResult &results,
+                                        const QString &xColumn, const QString &yColumn,
+                                        const QString &colorBy = QString());
     
-    ChartData preparePieChartData(const DuckDBManager::QueryResult &results,
-                                  const QString &labelColumn, const QString &valueColumn,
-                                  AggregationType aggregation = Count);
+    static ChartData preparePieChartData(const DuckDBManager::QueryResult &results,
+                                         const QString &labelColumn, const QString &valueColumn,
+                                         AggregationType aggregation = Count);
     
-    ChartData prepareHistogramData(const DuckDBManager::QueryResult &results,
-                                   const QString &column, int bins = 20);
+    static ChartData prepareHistogramData(const DuckDBManager::QueryResult &results,
+                                          const QString &column, int bins = 20);
+
+    // The same aggregations run by DuckDB as GROUP BY over every row of query, embedded as a
+    // subquery; only one row per group comes back. Reads on the manager's background connection;
+    // progress returning false interrupts the query. NoAggregation has no SQL form: a GROUP BY
+    // would pick an arbitrary row of each group, so it stays on the loaded rows.
+    static ChartData prepareBarChartData(DuckDBManager *dbManager, const QString &query,
+                                         const QString &xColumn, const QString &yColumn,
+                                         const QString &groupBy, AggregationType aggregation,
+                                         const DuckDBManager::ProgressCallback &progress = DuckDBManager::ProgressCallback());
+    static ChartData preparePieChartData(DuckDBManager *dbManager, const QString &query,
+                                         const QString &labelColumn, const QString &valueColumn,
+                                         AggregationType aggregation = Count,
+                                         const DuckDBManager::ProgressCallback &progress = DuckDBManager::ProgressCallback());
+    // Line points over every row of query, reduced to the lowest and highest y of each of
+    // `buckets` equal x ranges (min/max per pixel column), so the drawn line looks the same.
+    // With minX/maxX set only that x range is read, for re-sampling a zoomed chart.
+    static ChartData prepareLineChartData(DuckDBManager *dbManager, const QString &query,
+                                          const QString &xColumn, const QString &yColumn, int buckets,
+                                          double minX = qQNaN(), double maxX = qQNaN(),
+                                          const DuckDBManager::ProgressCallback &progress = DuckDBManager::ProgressCallback());
+    // Scatter points of every row of query binned into a grid by DuckDB; only the non-empty
+    // cells come back. With minX/maxX set only that x range is binned.
+    static DensityGrid prepareDensityGrid(DuckDBManager *dbManager, const QString &query,
+                                          const QString &xColumn, const QString &yColumn, int columns, int rows,
+                                          double minX = qQNaN(), double maxX = qQNaN(),
+                                          const DuckDBManager::ProgressCallback &progress = DuckDBManager::ProgressCallback());
+    // The same binning over points already in memory
+    static DensityGrid binDensity(const QList<double> &xValues, const QList<double> &yValues,
+                                  int columns, int rows, double minX = qQNaN(), double maxX = qQNaN());
+    // A time series aggregates y per time bucket of a DATE or TIMESTAMP column x, with the
+    // smallest bucket that splits the range into no more than maxBuckets. x values are bucket
+    // starts in milliseconds since the epoch, reading timestamps as UTC the way epoch_ms does.
+    // DuckDB buckets with date_trunc (one unit) or time_bucket (several); with minMs/maxMs set
+    // only that range is read, so a zoomed chart gets finer buckets.
+    static ChartData prepareTimeSeriesData(DuckDBManager *dbManager, const QString &query,
+                                           const QString &xColumn, const QString &yColumn,
+                                           AggregationType aggregation, int maxBuckets,
+                                           double minMs = qQNaN(), double maxMs = qQNaN(),
+                                           const DuckDBManager::ProgressCallback &progress = DuckDBManager::ProgressCallback());
+    // The same bucketing over rows already in memory
+    static ChartData prepareTimeSeriesData(const DuckDBManager::QueryResult &results,
+                                           const QString &xColumn, const QString &yColumn,
+                                           AggregationType aggregation, int maxBuckets,
+                                           double minMs = qQNaN(), double maxMs = qQNaN());
+    // DATE and the TIMESTAMP types; TIME has no date to bucket by
+    static bool isTimestampType(const QString &type);
+    // Largest-Triangle-Three-Buckets: keeps `threshold` points of an x-sorted series that
+    // preserve its visual shape
+    static QList<QPointF> downsampleLttb(const QList<QPointF> &points, int threshold);
+
+    // Bins every numeric value of column in two passes: range (or quantile edges), then a
+    // GROUP BY over the bin number. Only the bin counts come back.
+    static ChartData prepareHistogramData(DuckDBManager *dbManager, const QString &query,
+                                          const QString &column, int bins = 20,
+                                          BinningType binning = EqualWidthBins,
+                                          const DuckDBManager::ProgressCallback &progress = DuckDBManager::ProgressCallback());
+    // SELECT group[, split], aggregate FROM (query) GROUP BY group[, split], ordered the same way
+    static QString groupedAggregationQuery(const QString &query, const QString &groupColumn,
+                                           const QString &valueColumn, AggregationType aggregation,
+                                           int limit, const QString &splitColumn = QString());
 
     // Statistical functions
-    double calculateStatistic(const QList<double> &values, AggregationType type);
-    QList<double> createBins(const QList<double> &values, int binCount);
-    QStringList createCategoricalGroups(const QVariantList &values);
+    static double calculateStatistic(const QList<double> &values, AggregationType type);
+    static QList<double> createBins(const QList<double> &values, int binCount);
+    static QStringList createCategoricalGroups(const QVariantList &values);
 
     // Utility functions
-    QString aggregationTypeToString(AggregationType type);
-    AggregationType stringToAggregationType(const QString &str);
-    QString dataTypeToString(DataType type);
+    static QString aggregationTypeToString(AggregationType type);
+    static AggregationType stringToAggregationType(const QString &str);
+    static QString dataTypeToString(DataType type);
     
     // Data conversion helpers
-    double variantToDouble(const QVariant &value, bool *ok = nullptr);
-    QDateTime variantToDateTime(const QVariant &value, bool *ok = nullptr);
-    QString formatValue(const QVariant &value, DataType type);
+    static double variantToDouble(const QVariant &value, bool *ok = nullptr);
+    static QDateTime variantToDateTime(const QVariant &value, bool *ok = nullptr);
+    static QString formatValue(const QVariant &value, DataType type);
 
     // UI Management methods
-    void setData(const DuckDBManager::QueryResult &results, const QString &fileName = QString());
+    // resultId identifies the result (ResultsTableModel::resultId()); charts of the same result and
+    // settings are only computed once. 0 keeps the charts from being cached.
+    // With compressed set, results carries no rows; charts decompress them page by page on their workers.
+    // Spilled results carry none either; the workers read a sample from the spill file.
+    void setData(const DuckDBManager::QueryResult &results, const QString &fileName = QString(),
+                 quint64 resultId = 0, const std::shared_ptr<CompressedResult> &compressed = nullptr);
+    // The query the data came from; charts that aggregate run over its full result through dbManager.
+    // Set before setData(); an empty query keeps every chart on the rows passed to setData().
+    void setQuerySource(std::shared_ptr<DuckDBManager> dbManager, const QString &query);
+    // Swaps rows shared with `rows` for their compressed form in the manager and every chart
+    void compactData(const QList<QVariantList> &rows, const std::shared_ptr<CompressedResult> &compressed);
+    // Frees the prepared charts of the current result; they are computed again when next drawn
+    void releaseCachedData();
     void clearCharts();
     void setVisible(bool visible);
     bool isVisible() const;
@@ -129,11 +246,30 @@ private:
     void restoreFileCharts(const QString &fileName);
 
     // Helper methods
-    int findColumnIndex(const QStringList &columnNames, const QString &columnName);
-    QVariantList getColumnData(const DuckDBManager::QueryResult &results, int columnIndex);
-    QMap<QString, QList<double>> groupNumericData(const DuckDBManager::QueryResult &results,
-                                                   const QString &groupColumn, const QString &valueColumn,
-                                                   AggregationType aggregation);
+    static int findColumnIndex(const QStringList &columnNames, const QString &columnName);
+    static QVariantList getColumnData(const DuckDBManager::QueryResult &results, int columnIndex);
+    static ColumnInfo analyzeColumn(const DuckDBManager::QueryResult &results, int columnIndex);
+    static quint64 hashValue(const QVariant &value, DataType type);
+    // A split column divides each group, labelled "group / split"
+    static QMap<QString, QList<double>> groupNumericData(const DuckDBManager::QueryResult &results,
+                                                         const QString &groupColumn, const QString &valueColumn,
+                                                         AggregationType aggregation,
+                                                         const QString &splitColumn = QString());
+    struct TimeBucket {
+        int count = 1;
+        QString unit;        // DuckDB date part
+        qint64 approxMs = 0; // Nominal length; months and years vary
+
+        QString label() const { return count == 1 ? unit : QString("%1 %2s").arg(count).arg(unit); }
+    };
+    static TimeBucket chooseTimeBucket(double spanMs, int maxBuckets);
+    static qint64 truncateTime(qint64 utcMs, const TimeBucket &bucket);
+    static bool timestampValue(const QVariant &value, qint64 *utcMs);
+    static QString aggregateExpression(const QString &valueColumn, AggregationType aggregation);
+    static ChartData queryGroupedData(DuckDBManager *dbManager, const QString &query, const QString &groupColumn,
+                                      const QString &valueColumn, AggregationType aggregation,
+                                      const QString &splitColumn, const DuckDBManager::ProgressCallback &progress);
+    void applyData(ChartWidget *chartWidget);
 
     // UI Components
     QVBoxLayout *m_mainLayout;
@@ -145,6 +281,11 @@ private:
     
     // Data management
     DuckDBManager::QueryResult m_currentData;
+    std::shared_ptr<CompressedResult> m_compressedData;  // Holds m_currentData's rows while set
+    std::shared_ptr<DuckDBManager> m_dbManager;
+    QString m_sourceQuery;
+    quint64 m_resultId;
+    std::shared_ptr<ChartDataCache> m_dataCache;  // ChartDataCache::shared()
     QString m_currentFileName;
     QMap<QString, QList<ChartWidget*>> m_fileCharts; // Charts per file
     int m_chartCounter;
@@ -12,8 +12,14 @@
 #include <QGroupBox>
 #include <QSpinBox>
 #include <QCheckBox>
+#include <QImage>
 #include <memory>
 #include "duckdbmanager.h"
+#include "chartmanager.h"
+#include "backgroundtask.h"
+#include "chartdatacache.h"
+
+class CompressedResult;
 
 QT_BEGIN_NAMESPACE
 class QBarSeries;
@@ -23,6 +29,9 @@ class QPieSeries;
 class QValueAxis;
 class QBarCategoryAxis;
 class QDateTimeAxis;
+class QTimer;
+class QGraphicsPixmapItem;
+class QProgressBar;
 QT_END_NAMESPACE
 
 class ChartWidget : public QWidget
@@ -35,13 +44,24 @@ public:
         LineChart,
         ScatterChart,
         PieChart,
-        Histogram
+        Histogram,
+        TimeSeriesChart   // Aggregated per time bucket of a DATE or TIMESTAMP column
     };
 
     explicit ChartWidget(QWidget *parent = nullptr);
     ~ChartWidget();
 
-    void setData(const DuckDBManager::QueryResult &results);
+    // With compressed set, results carries no rows and they are decompressed when a chart is drawn;
+    // a spilled result is likewise sampled from its file on the chart's worker
+    // resultId identifies the result for the data cache; 0 computes the chart without caching it
+    void setData(const DuckDBManager::QueryResult &results,
+                 const std::shared_ptr<CompressedResult> &compressed = nullptr, quint64 resultId = 0);
+    // Drops this chart's copy of rows in favour of their compressed form
+    void compactData(const QList<QVariantList> &rows, const std::shared_ptr<CompressedResult> &compressed);
+    // Aggregating charts are computed by DuckDB over every row of query; empty uses the rows in setData()
+    void setQuerySource(std::shared_ptr<DuckDBManager> dbManager, const QString &query);
+    // Prepared chart data shared with the other charts of the panel
+    void setDataCache(const std::shared_ptr<ChartDataCache> &cache);
     void clearChart();
 
 public slots:
@@ -55,14 +75,71 @@ signals:
     void chartConfigChanged();
 
 private:
+    // The chart settings and data, copied so the chart can be prepared on a worker thread
+    struct ChartRequest {
+        ChartType type = BarChart;
+        QString xColumn;
+        QString yColumn;
+        QString groupBy;
+        ChartManager::AggregationType aggregation = ChartManager::NoAggregation;
+        int bins = 0;
+        ChartManager::BinningType binning = ChartManager::EqualWidthBins;
+        bool density = false;            // Scatter points drawn as a density raster
+        int lineBuckets = 0;             // Plot width in pixels; time series buckets are a few pixels wide
+        QSize densityCells;
+        double minX = qQNaN();           // The zoomed x range when re-sampling
+        double maxX = qQNaN();
+        QList<QPointF> linePoints;       // Loaded line points when re-sampling without DuckDB
+        DuckDBManager::QueryResult data; // No rows while compressed holds them
+        std::shared_ptr<CompressedResult> compressed;
+        std::shared_ptr<DuckDBManager> dbManager;
+        QString sourceQuery;
+        quint64 resultId = 0;
+    };
+
+    // What a worker hands back to be turned into series on the GUI thread
+    using PreparedChart = ChartDataCache::Entry;
+
     void setupUI();
     void setupConnections();
     void populateColumnSelectors();
-    void createBarChart();
-    void createLineChart();
-    void createScatterChart();
-    void createPieChart();
-    void createHistogram();
+    ChartRequest chartRequest() const;
+    static ChartDataCache::Key cacheKey(const ChartRequest &request);
+    void onDisplayOptionsChanged();
+    void cancelPreparation();
+    void showChart(const ChartRequest &request, const PreparedChart &prepared);
+    static DuckDBManager::QueryResult loadedData(const ChartRequest &request);
+    static DuckDBManager::ProgressCallback interruptWhenCancelled(BackgroundTask::Control &control);
+
+    // prepare* run on a worker thread; create* build the series from their result
+    static PreparedChart prepareChart(const ChartRequest &request, BackgroundTask::Control &control);
+    static void prepareBarChart(const ChartRequest &request, PreparedChart &prepared, BackgroundTask::Control &control);
+    static void prepareLineChart(const ChartRequest &request, PreparedChart &prepared, BackgroundTask::Control &control);
+    static void prepareScatterChart(const ChartRequest &request, PreparedChart &prepared,
+                                    BackgroundTask::Control &control);
+    static void preparePieChart(const ChartRequest &request, PreparedChart &prepared, BackgroundTask::Control &control);
+    static void prepareHistogram(const ChartRequest &request, PreparedChart &prepared, BackgroundTask::Control &control);
+    // Also re-buckets a zoomed time series: with minX/maxX set only that range is read
+    static void prepareTimeSeries(const ChartRequest &request, PreparedChart &prepared, BackgroundTask::Control &control);
+    static void resampleLine(const ChartRequest &request, PreparedChart &prepared, BackgroundTask::Control &control);
+    static void rebinDensity(const ChartRequest &request, PreparedChart &prepared, BackgroundTask::Control &control);
+    void createBarChart(const ChartRequest &request, const PreparedChart &prepared);
+    void createLineChart(const ChartRequest &request, const PreparedChart &prepared);
+    void createScatterChart(const ChartRequest &request, const PreparedChart &prepared);
+    void createPieChart(const ChartRequest &request, const PreparedChart &prepared);
+    void createHistogram(const ChartRequest &request, const PreparedChart &prepared);
+    void createTimeSeriesChart(const ChartRequest &request, const PreparedChart &prepared);
+    void resampleZoomed();
+    void updateDensityImage();
+    QSize densityGridSize() const;
+    static QImage renderDensity(const ChartManager::DensityGrid &grid);
+    int lineSampleBuckets() const;
+    void selectTimeColumn();
+    // QDateTimeAxis shows local time while DuckDB's epoch_ms reads timestamps as UTC; shifting
+    // by the local offset keeps the axis labels on the timestamps' own wall clock
+    static double wallClockToAxis(double utcMs);
+    static double axisToWallClock(double axisMs);
+    static QString timeAxisFormat(const QString &unit);
     void updateChartTheme();
     void configureAxes();
 
@@ -84,6 +161,9 @@ private:
     QCheckBox *m_showGridCheck;
     QCheckBox *m_showLegendCheck;
     QSpinBox *m_binsSpin;
+    QComboBox *m_binningCombo;
+    QComboBox *m_scatterModeCombo;
+    QProgressBar *m_busyIndicator;
     QLabel *m_statsLabel;
 
     // Chart components
@@ -92,6 +172,23 @@ private:
     
     // Data
     DuckDBManager::QueryResult m_data;
+    std::shared_ptr<CompressedResult> m_compressedData;
+    std::shared_ptr<DuckDBManager> m_dbManager;
+    QString m_sourceQuery;
+    quint64 m_resultId;
+    std::shared_ptr<ChartDataCache> m_dataCache;
+    QStringList m_categoryLabels;  // X labels of the bars on screen
+    QList<QPointF> m_linePoints;  // Every loaded point of a line drawn from loaded rows, sorted by x
+    bool m_lineFromQuery;         // The line is sampled by DuckDB over the source query instead
+    QString m_timeBucket;         // Bucket of the time series on screen, e.g. "15 minutes"
+    QString m_timeUnit;           // Its date part, which picks the axis label format
+    BackgroundTask *m_prepareTask;   // Prepares the chart off the GUI thread
+    BackgroundTask *m_resampleTask;  // Re-samples a zoomed line or density
+    QTimer *m_resampleTimer;      // Re-samples the line (or re-bins the density) once zooming settles
+    ChartManager::DensityGrid m_density;  // Binned scatter points while in density mode
+    bool m_densityFromQuery;
+    QImage m_densityImage;
+    QGraphicsPixmapItem *m_densityItem;   // The density raster, drawn over the plot area behind the grid
     ChartType m_currentType;
     
     // Chart series (Qt manages these through parent-child ownership)
@@ -107,6 +204,11 @@ private:
     QDateTimeAxis *m_xDateTimeAxis;
 
     static constexpr int DEFAULT_HISTOGRAM_BINS = 20;
+    static constexpr int RESAMPLE_DELAY_MS = 150;
+    static constexpr qint64 DENSITY_POINT_THRESHOLD = 50000;  // Auto mode draws more points as a density
+    static constexpr int DENSITY_CELL_PIXELS = 4;
+    static constexpr int TIME_BUCKET_PIXELS = 4;  // Narrowest time bucket on screen
+    static constexpr qint64 SPILL_SAMPLE_ROWS = 100000;  // Rows of a spilled result charted without DuckDB
 };
 
 #endif // CHARTWIDGET_H
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef CLIPBOARDCOPIER_H
+#define CLIPBOARDCOPIER_H
+
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <memory>
+
+class BackgroundTask;
+class CompressedResult;
+class DuckDBManager;
+
+// Builds tab-separated text for the clipboard off the GUI thread, either from
+// rows already held by the results model or from a full query via DuckDB COPY.
+// Rows too large for the clipboard can be saved to a file the same way.
+class ClipboardCopier : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Result {
+        QString text;
+        QString error;
+        bool success = false;
+        bool cancelled = false;
+        bool exceededLimit = false;   // Output grew past MAX_CLIPBOARD_BYTES; nothing is copied
+        QString filePath;             // Set by saveRows(): the rows went to this file, not text
+        qint64 rowsCopied = 0;
+        qint64 bytes = 0;
+        qint64 elapsedMs = 0;
+    };
+
+    // Selected rows of an in-memory result. The rows are shared with the results model, not
+    // copied, and are only looked up (and decompressed) on the worker thread.
+    struct RowSelection {
+        QList<QVariantList> rows;                       // Every row of the result...
+        std::shared_ptr<CompressedResult> compressed;   // ...or, when set, its compressed pages
+        QList<QPair<qint64, qint64>> ranges;            // View rows, inclusive, in copy order
+        bool reversed = false;                          // View row r is result row rowCount-1-r
+        QList<int> columnIndexes;                       // Empty keeps every column
+
+        qint64 rowCount() const;
+        qint64 selectedRowCount() const;
+    };
+
+    explicit ClipboardCopier(std::shared_ptr<DuckDBManager> dbManager, QObject *parent = nullptr);
+    ~ClipboardCopier() override;
+
+    void copyRows(const QStringList &columns, const RowSelection &selection);
+    // Writes the same text to filePath, with no size limit
+    void saveRows(const QStringList &columns, const RowSelection &selection, const QString &filePath);
+    void copyQuery(const QString &query);
+    void cancel();
+    bool isRunning() const;
+
+    static constexpr qint64 MAX_CLIPBOARD_BYTES = 64LL * 1024 * 1024;
+
+signals:
+    void progress(double percent, const QString &status);
+    void finished(const ClipboardCopier::Result &result);
+
+private:
+    void startRows(const QStringList &columns, const RowSelection &selection, const QString &filePath);
+    static void appendField(QString &out, const QString &value);
+
+    std::shared_ptr<DuckDBManager> m_dbManager;
+    BackgroundTask *m_task;
+    std::shared_ptr<Result> m_result;
+
+    static constexpr int PROGRESS_INTERVAL_MS = 200;
+    static constexpr int SAVE_FLUSH_CHARS = 1024 * 1024;
+};
+
+#endif // CLIPBOARDCOPIER_H
@@ -0,0 +1,82 @@
+#ifndef COLUMNPROFILER_H
+#define COLUMNPROFILER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+#include <functional>
+#include <memory>
+
+class BackgroundTask;
+class DuckDBManager;
+
+// Profiles every column of a loaded file in the background: Parquet footer
+// statistics first (min, max, null count - no data scan), then SUMMARIZE for
+// approximate distinct counts, mean and quartiles. Finished profiles are cached
+// on disk by source file fingerprint, so reopening an unchanged file is instant.
+class ColumnProfiler : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct ColumnStats {
+        QString name;
+        QString type;
+        QString min;             // Empty when unknown
+        QString max;
+        qint64 nullCount = -1;   // -1 when unknown
+        qint64 approxDistinct = -1;
+        QString mean;
+        QString q25;
+        QString q50;
+        QString q75;
+    };
+
+    struct Profile {
+        QString filePath;
+        QString fingerprint;
+        qint64 rowCount = -1;
+        QList<ColumnStats> columns;
+        bool complete = false;   // SUMMARIZE has run; otherwise only footer statistics
+        bool fromCache = false;
+        QString error;
+        qint64 elapsedMs = 0;
+
+        QJsonObject toJson() const;
+        static Profile fromJson(const QJsonObject &json);
+    };
+
+    explicit ColumnProfiler(std::shared_ptr<DuckDBManager> dbManager, QObject *parent = nullptr);
+    ~ColumnProfiler() override;
+
+    void profileTable(const QString &filePath, const QString &tableName);
+    void cancel();
+    bool isRunning() const;
+    const Profile &profile() const { return m_profile; }
+
+    static QString tooltip(const ColumnStats &stats, qint64 rowCount);
+
+signals:
+    void progress(double percent, const QString &status);
+    void profileUpdated(const ColumnProfiler::Profile &profile);  // Partial, then final
+    void finished(const ColumnProfiler::Profile &profile);
+
+private:
+    static void readFooterStatistics(DuckDBManager *dbManager, Profile &profile);
+    static bool summarize(DuckDBManager *dbManager, const QString &tableName, Profile &profile,
+                          const std::function<bool(double)> &progress);
+    static QString cachePath(const QString &fingerprint);
+    static bool loadCached(const QString &fingerprint, Profile &profile);
+    static void saveCached(const Profile &profile);
+
+    std::shared_ptr<DuckDBManager> m_dbManager;
+    BackgroundTask *m_task;
+    std::shared_ptr<Profile> m_result;
+    Profile m_profile;
+    int m_generation;  // Drops partial updates from a superseded run
+
+    static constexpr int PROGRESS_INTERVAL_MS = 200;
+};
+
+#endif // COLUMNPROFILER_H
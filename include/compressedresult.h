@@ -0,0 +1,66 @@
+#ifndef COMPRESSEDRESULT_H
+#define COMPRESSEDRESULT_H
+
+#include <QByteArray>
+#include <QList>
+#include <QStringList>
+#include <QVariantList>
+#include <functional>
+#include <memory>
+
+// The rows of an in-memory result held as zlib-compressed pages, for tabs that are
+// not on screen. Each page stores its cells column by column, so similar values sit
+// together, and decompresses on its own when the grid scrolls to it.
+//
+// Built on a worker thread; once published, page() may be called from any thread,
+// while rows() and releaseRows() belong to the GUI thread.
+class CompressedResult
+{
+public:
+    static constexpr int PAGE_ROWS = 1000;
+
+    // Returns nullptr when cancelled
+    static std::shared_ptr<CompressedResult> compress(const QList<QVariantList> &rows, int columnCount,
+                                                      const std::function<bool()> &isCancelled = std::function<bool()>());
+
+    qint64 rowCount() const { return m_rowCount; }
+    int columnCount() const { return m_columnCount; }
+    int pageCount() const { return static_cast<int>(m_pages.size()); }
+    qint64 rawBytes() const { return m_rawBytes; }  // Estimated in-memory size of the rows
+    qint64 compressedBytes() const { return m_compressedBytes; }
+
+    QList<QVariantList> page(int index) const;
+    // Every row, decompressed on first use and shared by later callers until releaseRows()
+    QList<QVariantList> rows() const;
+    bool hasRows() const { return !m_rows.isEmpty(); }
+    void releaseRows();
+
+private:
+    enum Tag : quint8 {
+        NullTag,
+        BoolTag,
+        IntTag,
+        LongLongTag,
+        FloatTag,
+        DoubleTag,
+        StringTag,
+        DictionaryTag,
+        TruncatedTag,
+        VariantTag
+    };
+
+    CompressedResult() = default;
+    static qint64 estimateBytes(const QVariant &value);
+
+    QList<QByteArray> m_pages;
+    QList<QStringList> m_dictionaries;  // Per column; empty unless its text is encoded
+    qint64 m_rowCount = 0;
+    int m_columnCount = 0;
+    qint64 m_rawBytes = 0;
+    qint64 m_compressedBytes = 0;
+    mutable QList<QVariantList> m_rows;
+
+    static constexpr int COMPRESSION_LEVEL = 1;  // zlib's fastest; decompression speed is the same at any level
+};
+
+#endif // COMPRESSEDRESULT_H
@@ -5,8 +5,13 @@
 #include <QString>
 #include <QStringList>
 #include <QVariantList>
+#include <QMap>
+#include <QPair>
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 extern "C" {
     #include <duckdb.h>
@@ -17,30 +22,123 @@ class DuckDBManager : public QObject
     Q_OBJECT
 
 public:
+    // A query result written to a scratch Parquet file instead of being held in
+    // memory. The file is deleted when the last result referencing it goes away.
+    struct SpillFile {
+        QString path;
+        qint64 rowCount = 0;
+        qint64 sizeBytes = 0;
+        ~SpillFile();
+    };
+
+    struct SpillSettings {
+        bool enabled = true;
+        qint64 rowThreshold = 1000000;  // Results with more rows than this are spilled
+        int columnThreshold = 200;      // Results with more columns than this always spill
+        QString scratchDirectory;
+    };
+
+    // A long text value cut down to its first MAX_CELL_PREVIEW_CHARS characters. Only results
+    // backed by a spill file are truncated, so the full value can be read back by row number.
+    struct TruncatedText {
+        QString prefix;
+        qint64 fullBytes = 0;  // UTF-8 size of the full value
+    };
+
     struct QueryResult {
         QStringList columnNames;
-        QList<QVariantList> rows;
+        QStringList columnTypes;        // DuckDB type of each column as DESCRIBE names it; empty if unknown
+        QList<QVariantList> rows;       // All rows, or only the first page when spilled
         QString error;
         bool success = false;
         qint64 executionTimeMs = 0;
-        int totalRows = 0;
+        qint64 totalRows = 0;
+        std::shared_ptr<SpillFile> spill;
+        qint64 truncatedValues = 0;     // Cells held as TruncatedText
+        int dictionaryColumns = 0;      // Text columns whose repeated values share one QString
+
+        bool isSpilled() const { return spill != nullptr; }
+    };
+
+    struct IndexBuildResult {
+        QString tableName;
+        QStringList keyColumns;
+        QString error;
+        bool success = false;
+        qint64 buildTimeMs = 0;
+        qint64 scanLookupUs = -1;     // Sample point lookup before indexing, -1 if not measured
+        qint64 indexedLookupUs = -1;  // Same lookup against the sorted, indexed table
     };
 
+    // Called between execution tasks with DuckDB's progress estimate (-1 when unknown);
+    // returning false cancels the query.
+    using ProgressCallback = std::function<bool(double percent)>;
+
+    // Result text is held in memory up to this many characters per cell
+    static constexpr int MAX_CELL_PREVIEW_CHARS = 200;
+    // Text columns share repeated values while they have at most this many distinct values
+    static constexpr int MAX_DICTIONARY_ENTRIES = 1024;
+    static constexpr int MAX_DICTIONARY_TEXT_BYTES = 64;
+
+
     explicit DuckDBManager(QObject *parent = nullptr);
     ~DuckDBManager();
 
     bool initialize(bool useDiskDatabase = false, const QString &dbPath = QString());
     bool loadFile(const QString &filePath);
     QueryResult executeQuery(const QString &query);
+    // Runs on a connection of its own, so it neither waits for nor blocks the tab's query
+    QueryResult executeBackgroundQuery(const QString &query, const ProgressCallback &progress = ProgressCallback(),
+                                       int maxTextChars = 0);
     bool interruptQuery();
     bool isConnected() const { return m_connected; }
 
     QStringList getLoadedTables() const;
     QStringList getAllTables() const;
+    QStringList getTableColumns(const QString &tableName) const;
+    // Binds the query without running it and returns its output column names (and DuckDB types)
+    QStringList describeQuery(const QString &query, QStringList *columnTypes = nullptr);
     QString getLastLoadedTableName() const { return m_lastLoadedTable; }
     QString getLastError() const { return m_lastError; }
     QString getCurrentDatabasePath() const { return m_databasePath; }
     bool isDiskBased() const { return m_isDiskBased; }
+    // True once a statement other than a query (DDL, DML, SET, ATTACH, ...) has run or an index
+    // was built: the session then holds state that loading the file again would not bring back
+    bool hasSessionChanges() const { return m_sessionChanged.load(); }
+
+    // Reads rows [offset, offset + count) of a spilled result on a separate connection
+    // columns are select expressions over the spill file's columns; empty reads every column.
+    // Text longer than maxTextChars comes back as TruncatedText; 0 reads full values.
+    QueryResult readSpillRows(const SpillFile &spill, qint64 offset, qint64 count,
+                              const QStringList &columns = QStringList(),
+                              int maxTextChars = MAX_CELL_PREVIEW_CHARS);
+    // Runs query again straight into a scratch Parquet file and returns it spilled, with no rows
+    // in memory. Fails once the session has changed, as the query may no longer give the same rows.
+    QueryResult snapshotQuery(const QString &query);
+    // A query that scans a spilled result back in its original (or reversed) row order
+    static QString spillScanQuery(const SpillFile &spill, bool descending = false);
+    // Same, restricted to the inclusive [first, second] row ranges and, when given, to columns
+    static QString spillRangesQuery(const SpillFile &spill, const QList<QPair<qint64, qint64>> &ranges,
+                                    bool descending = false, const QStringList &columns = QStringList());
+
+    // Persisted in QSettings under "spill/"
+    static SpillSettings spillSettings();
+    static void setSpillSettings(const SpillSettings &settings);
+
+    // Rewrites a loaded table (or Parquet view) as a table physically sorted by
+    // keyColumns with an ART index on them, for fast point lookups.
+    IndexBuildResult buildLookupIndex(const QString &tableName, const QStringList &keyColumns);
+
+    // Path, size and modification time; changes whenever the file is rewritten
+    static QString sourceFingerprint(const QString &filePath);
+
+    static QString quoteIdentifier(const QString &identifier);
+    static QString quoteLiteral(const QString &value);
+    // Strips trailing semicolons so a user query can be embedded as "(query)"
+    static QString asSubquery(const QString &query);
+    // Wraps query in ORDER BY over 0-based output column positions. Ascending keys put NULLs
+    // last and descending keys first, so flipping every direction exactly reverses the order.
+    static QString orderedQuery(const QString &query, const QList<QPair<int, Qt::SortOrder>> &sortColumns);
 
 private:
     bool setupDatabase();
@@ -49,16 +147,47 @@ private:
     bool loadParquetFile(const QString &filePath);
     bool loadCSVFile(const QString &filePath);
     QString generateTableName(const QString &filePath);
+    bool runStatement(const QString &sql, QString *error = nullptr);
+    QStringList queryFirstRow(const QString &sql) const;
+    QString buildSampleLookupPredicate(const QString &tableName, const QStringList &keyColumns);
+    qint64 timeLookup(const QString &tableName, const QString &predicate);
+    // Output column names and full DuckDB types of a query, bound on m_connection
+    bool describeColumns(const QString &query, QStringList &names, QStringList &types);
+    bool inTransaction();
+    // Runs a SELECT once, keeping it in memory up to the spill thresholds and spilling it past them
+    bool streamQuery(const QString &query, const QStringList &columnNames, const QStringList &columnTypes,
+                     const SpillSettings &settings, QueryResult &result);
+    // Stores the held chunks and the rest of the stream in a TEMP table on a connection of its own,
+    // then spills that table
+    bool spillStream(duckdb_result &stream, std::vector<duckdb_data_chunk> &held,
+                     const QStringList &definitions, const QStringList &columnNames,
+                     const SpillSettings &settings, QueryResult &result);
+    bool spillQuery(duckdb_connection connection, const QString &query, const SpillSettings &settings,
+                    QueryResult &result, qint64 previewRows);
+    static bool extractResult(duckdb_result &duckResult, QueryResult &result, int maxTextChars = 0);
+    static QString typeName(duckdb_type type);
+    static QString spillReadQuery(const SpillFile &spill, qint64 offset, qint64 count,
+                                  const QStringList &columns = QStringList());
+    static bool executePending(duckdb_connection connection, const QString &query,
+                               const ProgressCallback &progress, duckdb_result *out, QString *error);
     
     duckdb_database *m_database;
     duckdb_connection *m_connection;
     bool m_connected;
     bool m_isDiskBased;
+    std::atomic<bool> m_sessionChanged{false};
     QString m_databasePath;
     QString m_lastError;
     QStringList m_loadedTables;
     QString m_lastLoadedTable;
     mutable std::mutex m_mutex;
+    std::mutex m_interruptMutex; // Guards m_interruptConnection only, so a query can be interrupted while it runs
+    duckdb_connection m_interruptConnection = nullptr; // Set while m_connection is open
+
+    static constexpr qint64 SPILL_PREVIEW_ROWS = 1000;
+    static constexpr qint64 SPILL_ROW_GROUP_SIZE = 100000;
 };
 
+Q_DECLARE_METATYPE(DuckDBManager::TruncatedText)
+
 #endif // DUCKDBMANAGER_H
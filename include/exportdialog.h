@@ -0,0 +1,59 @@
+#ifndef EXPORTDIALOG_H
+#define EXPORTDIALOG_H
+
+#include <QDialog>
+#include <QStringList>
+#include "queryexporter.h"
+
+class QLineEdit;
+class QPushButton;
+class QComboBox;
+class QSpinBox;
+class QCheckBox;
+class QGroupBox;
+class QListWidget;
+class QDialogButtonBox;
+
+// Collects QueryExporter::Options: output path, format, Parquet codec and
+// row-group settings, and the partitioned/parallel file layout.
+class ExportDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    // The output defaults to a file next to sourcePath, or in Documents when that folder is read-only
+    explicit ExportDialog(const QString &sourcePath, QWidget *parent = nullptr);
+
+    QueryExporter::Options options() const;
+    // Fills the PARTITION_BY choices; they are read from DuckDB while the dialog is already open
+    void setColumns(const QStringList &columns);
+
+public slots:
+    void accept() override;
+
+private slots:
+    void onBrowse();
+    void updateControls();
+
+private:
+    void setupUI();
+    void setupConnections();
+    QStringList checkedPartitionColumns() const;
+    QString absolutePath(const QString &path) const;
+
+    QString m_defaultDirectory;  // Relative output paths resolve against this
+
+    QLineEdit *m_pathEdit;
+    QPushButton *m_browseButton;
+    QComboBox *m_formatCombo;
+    QGroupBox *m_parquetGroup;
+    QComboBox *m_compressionCombo;
+    QSpinBox *m_compressionLevelSpin;
+    QSpinBox *m_rowGroupSizeSpin;
+    QListWidget *m_partitionList;
+    QCheckBox *m_perThreadCheck;
+    QCheckBox *m_overwriteCheck;
+    QDialogButtonBox *m_buttonBox;
+};
+
+#endif // EXPORTDIALOG_H
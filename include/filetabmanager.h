@@ -12,34 +12,82 @@
 #include <QLabel>
 #include <QLineEdit>
 #include <QMap>
+#include <QSet>
+#include <QElapsedTimer>
 #include <memory>
+#include <functional>
 #include "duckdbmanager.h"
+#include "clipboardcopier.h"
 
 class SQLEditor;
 class ResultsTableModel;
 class ChartManager;
-class QSortFilterProxyModel;
 
 class SQLExecutor;
+class QueryExporter;
+class ColumnProfiler;
+class BackgroundTask;
+class QTableWidget;
+class QProgressDialog;
+class QTimer;
+
+// All a hibernated tab keeps once its database, executor, results and charts are released
+struct HibernatedTab {
+    QString sqlText;
+    QString filterText;
+    int verticalScroll = 0;
+    int horizontalScroll = 0;
+    std::shared_ptr<DuckDBManager::SpillFile> snapshot; // The result on screen; null if there was none
+    QStringList columnNames;
+    QStringList columnTypes;
+    bool reversed = false;
+    QSet<int> hiddenColumns;
+    QList<QPair<int, Qt::SortOrder>> sortMarkers;
+    BackgroundTask *restoreTask = nullptr; // Reloading the file; parented to the placeholder page
+};
 
 struct FileTabData {
     QString filePath;
     QString fileName;
-    std::unique_ptr<DuckDBManager> dbManager;
+    QString lastQuery; // Most recently executed SQL, re-run for full-result copies
+    QString baseQuery; // The user's query before any grid sort or filter was applied
+    QList<QPair<int, Qt::SortOrder>> sortColumns; // Grid sort keys pushed down as ORDER BY
+    QString filterPredicate; // Filter box compiled to a WHERE predicate over baseQuery
+    QStringList columnNames; // baseQuery's columns and DuckDB types, described on first filter
+    QStringList columnTypes;
+    QString runningQuery;
+    QList<QPair<int, Qt::SortOrder>> runningSortColumns;
+    bool resultQueryRunning = false; // The running query is a sort or filter over baseQuery
+    bool runningQuerySuperseded = false; // Cancelled in favour of newer input; fail silently
+    QString pendingQuery; // Started once the running query stops
+    bool pendingIsResultQuery = false;
+    QTimer *filterTimer; // Debounces filter box edits
+    std::shared_ptr<DuckDBManager> dbManager;  // Shared with background work still reading through it
     std::unique_ptr<SQLExecutor> sqlExecutor;
+    std::unique_ptr<QueryExporter> queryExporter;
+    std::unique_ptr<ClipboardCopier> clipboardCopier;
+    std::unique_ptr<ColumnProfiler> columnProfiler;
     std::unique_ptr<ResultsTableModel> resultsModel;
     ChartManager *chartManager; // Qt widget - managed by Qt parent/child system
-    QSortFilterProxyModel *proxyModel;
     SQLEditor *sqlEditor;
     QTableView *resultsTableView;
     QLineEdit *tableFilterEdit;
     QPushButton *cancelQueryButton;
-    QPushButton *firstPageButton;
-    QPushButton *prevPageButton;
-    QPushButton *nextPageButton;
-    QPushButton *lastPageButton;
-    QLabel *pageInfoLabel;
+    QLabel *rowRangeLabel;
     QLabel *rowCountLabel;
+    QWidget *profilePanel;
+    QLabel *profileStatusLabel;
+    QTableWidget *profileTable;
+    QWidget *rowDetailPanel;
+    QTableWidget *rowDetailTable;
+    BackgroundTask *rowDetailTask; // Reads the full current row of a spilled result
+    BackgroundTask *snapshotTask; // Prepares the next result for the grid off the GUI thread
+    BackgroundTask *compressTask; // Compresses the result while the tab is in the background
+    BackgroundTask *hibernateTask; // Copies an in-memory result to disk before the tab hibernates
+    BackgroundTask *describeTask; // Reads baseQuery's columns the first time the results are filtered
+    BackgroundTask *indexTask; // Sorts and indexes the loaded table for Build Lookup Index
+    QElapsedTimer idleTimer; // Running while the tab is in the background
+    std::unique_ptr<HibernatedTab> hibernated; // Set while the tab is hibernated
     
     // Destructor: chartManager will be deleted by Qt's parent-child system
     // when the tab widget is deleted, so we don't need to manually delete it
@@ -64,14 +112,15 @@ public:
     void executeQuery(const QString &query);
     void cancelCurrentQuery();
     void clearCurrentTab();
+    void buildLookupIndex();
+    void exportCurrentQuery();
+    void copySelectedRows();
+    void copyAllRows();
+    void benchmarkScrolling();
 
 public slots:
     void onTabChanged(int index);
     void onTabCloseRequested(int index);
-    void onFirstPage();
-    void onPreviousPage();
-    void onNextPage();
-    void onLastPage();
 
 signals:
     void tabChanged(const QString &filePath);
@@ -84,15 +133,51 @@ private:
     void setupUI();
     void setupConnections();
     QWidget* createFileTabWidget(FileTabData *tabData);
-    void updatePaginationControls(FileTabData *tabData);
+    void updateRowInfo(FileTabData *tabData);
+    void sortResults(FileTabData *tabData, int column, bool addToSort);
+    void applyFilter(FileTabData *tabData);
+    void describeFilterColumns(FileTabData *tabData);
+    QString resultQuery(FileTabData *tabData, const QList<QPair<int, Qt::SortOrder>> &sortColumns) const;
+    void startTabQuery(FileTabData *tabData, const QString &query, bool isResultQuery);
+    void updateSortIndicator(FileTabData *tabData);
+    void showColumnMenu(FileTabData *tabData, const QPoint &pos);
+    void startColumnProfile(FileTabData *tabData);
+    void showColumnProfile(FileTabData *tabData);
+    void showRowDetails(FileTabData *tabData);
+    void showCellValue(FileTabData *tabData, const QModelIndex &index);
+    void compressTabResults(FileTabData *tabData);
+    bool openTabDatabase(FileTabData *tabData);
+    void attachTabDatabase(FileTabData *tabData, std::shared_ptr<DuckDBManager> dbManager);
+    bool isTabBusy(FileTabData *tabData) const;
+    void hibernateIdleTabs();
+    void hibernateTab(FileTabData *tabData);
+    // reversed: the grid shows the snapshot's rows in reverse
+    void releaseTab(FileTabData *tabData, const std::shared_ptr<DuckDBManager::SpillFile> &snapshot,
+                    bool reversed);
+    void restoreTab(FileTabData *tabData);
+    void finishRestoreTab(FileTabData *tabData, std::shared_ptr<DuckDBManager> dbManager);
     void updateStatusForTab(FileTabData *tabData);
     QString generateTabTitle(const QString &filePath);
+    QString resultSourceQuery(FileTabData *tabData) const;
+    DuckDBManager::QueryResult chartResults(FileTabData *tabData) const;
+    void exportQuery(FileTabData *tabData, const QString &query);
+    void saveRowsToFile(FileTabData *tabData, const QStringList &columns, const ClipboardCopier::RowSelection &selection);
+    // fallback runs when the copy is too large for the clipboard and the user asks for a file instead
+    void startClipboardCopy(FileTabData *tabData, const std::function<void(ClipboardCopier*)> &start,
+                            const std::function<void()> &fallback);
+    QProgressDialog* createTaskProgressDialog(const QString &title, const QString &label);
+    static void updateTaskProgress(QProgressDialog *progressDialog, double percent, const QString &status);
 
     QVBoxLayout *m_mainLayout;
     QTabWidget *m_tabWidget;
     QList<FileTabData*> m_tabData;
+    QTimer *m_hibernateTimer;
 
-    static constexpr int ROWS_PER_PAGE = 1000;
+    static constexpr int SCROLL_BENCHMARK_FRAMES = 300;
+    static constexpr int FILTER_DEBOUNCE_MS = 300;
+    static constexpr qint64 COMPRESS_MIN_ROWS = 10000; // Smaller background results stay as they are
+    static constexpr qint64 HIBERNATE_IDLE_MS = 10 * 60 * 1000; // Background time before a tab hibernates
+    static constexpr int HIBERNATE_CHECK_MS = 60 * 1000;
 };
 
 #endif // FILETABMANAGER_H
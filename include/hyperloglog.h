@@ -0,0 +1,27 @@
+#ifndef HYPERLOGLOG_H
+#define HYPERLOGLOG_H
+
+#include <QByteArray>
+#include <QtGlobal>
+
+// Approximate distinct count in a fixed 4 KB of registers, whatever the number
+// of values added. The estimate is typically within about 2% of the true count.
+class HyperLogLog
+{
+public:
+    HyperLogLog();
+
+    void addHash(quint64 hash);
+    qint64 estimate() const;
+
+    // Spreads the bits of a weak hash (such as qHash of a small integer) over all 64
+    static quint64 mix(quint64 hash);
+
+private:
+    static constexpr int PRECISION = 12;
+    static constexpr int REGISTERS = 1 << PRECISION;
+
+    QByteArray m_registers;  // Longest run of leading zero bits + 1 seen per register
+};
+
+#endif // HYPERLOGLOG_H
@@ -41,6 +41,7 @@ private slots:
     void onQueryExecuted(bool success, const QString &error);
     void onResultsReady();
     void onExecutionProgress(const QString &status);
+    void onSpillSettings();
 
 private:
     void setupUI();
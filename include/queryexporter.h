@@ -0,0 +1,87 @@
+#ifndef QUERYEXPORTER_H
+#define QUERYEXPORTER_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <memory>
+
+class BackgroundTask;
+class DuckDBManager;
+
+// Writes the full result of a query to disk with DuckDB's COPY ... TO,
+// independent of how many rows the results grid has loaded.
+class QueryExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Format {
+        CSV,
+        TSV,
+        Parquet,
+        JSON
+    };
+
+    struct Options {
+        Format format = CSV;
+        QString filePath;              // A directory when partitioning or writing per-thread files
+
+        // Parquet only
+        QString compression;           // "zstd", "snappy", "lz4", "uncompressed"; empty uses DuckDB's default
+        int compressionLevel = 0;      // zstd level 1-22, 0 keeps the default
+        qint64 rowGroupSize = 0;       // Rows per row group, 0 keeps the default
+
+        QStringList partitionBy;       // Hive-style col=value/ directories, one writer per partition
+        bool perThreadOutput = false;  // One file per writer thread; cannot be combined with partitionBy
+        bool overwrite = false;        // Allow writing into an existing output directory
+
+        bool writesDirectory() const { return !partitionBy.isEmpty() || perThreadOutput; }
+    };
+
+    struct Summary {
+        QString filePath;
+        QString error;
+        bool success = false;
+        bool cancelled = false;
+        qint64 rowsWritten = 0;
+        qint64 bytesWritten = 0;
+        int filesWritten = 0;
+        qint64 elapsedMs = 0;
+
+        double megabytesPerSecond() const;
+        double rowsPerSecond() const;
+    };
+
+    explicit QueryExporter(std::shared_ptr<DuckDBManager> dbManager, QObject *parent = nullptr);
+    ~QueryExporter() override;
+
+    void exportQuery(const QString &query, const Options &options);
+    void cancel();
+    bool isRunning() const;
+
+    static QString buildCopyStatement(const QString &query, const Options &options);
+    static Format formatForPath(const QString &filePath, Format fallback = CSV);
+    static QString formatBytes(qint64 bytes);
+
+signals:
+    void progress(double percent, const QString &status);
+    void finished(const QueryExporter::Summary &summary);
+
+private:
+    // Last-modified time of every file under an output path, keyed by absolute path
+    using OutputSnapshot = QHash<QString, QDateTime>;
+    static OutputSnapshot snapshotOutput(const QString &path);
+    static void measureOutput(const QString &path, const OutputSnapshot &existing, qint64 *bytes, int *files);
+
+    std::shared_ptr<DuckDBManager> m_dbManager;
+    BackgroundTask *m_task;
+    std::shared_ptr<Summary> m_summary;
+
+    static constexpr int PROGRESS_INTERVAL_MS = 200;
+    static constexpr int MEASURE_INTERVAL_MS = 1000;
+};
+
+#endif // QUERYEXPORTER_H
@@ -0,0 +1,30 @@
+#ifndef RESULTFILTER_H
+#define RESULTFILTER_H
+
+#include <QString>
+#include <QStringList>
+
+// Compiles the results filter box into a SQL predicate so DuckDB filters the
+// full result instead of the grid scanning loaded rows as strings.
+//
+//   text            case-insensitive substring across text columns; a number
+//                   also matches numeric columns equal to it
+//   column op value typed comparison (=, !=, <>, <, <=, >, >=) on one column
+//   where <sql>     raw SQL predicate, passed through as written
+class ResultFilter
+{
+public:
+    // Returns an empty string for empty text, or on error with *error set
+    static QString compile(const QString &text, const QStringList &columns, const QStringList &types,
+                           QString *error = nullptr);
+    // Wraps query as SELECT * ... WHERE predicate; an empty predicate returns query unchanged
+    static QString apply(const QString &query, const QString &predicate);
+
+    static bool isNumericType(const QString &type);
+    static bool isTextType(const QString &type);
+
+private:
+    static QString numericLiteral(const QString &value);
+};
+
+#endif // RESULTFILTER_H
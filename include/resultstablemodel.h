@@ -4,14 +4,26 @@
 #include <QAbstractTableModel>
 #include <QStringList>
 #include <QVariantList>
+#include <QHash>
+#include <QSet>
+#include <vector>
+#include <memory>
 #include "duckdbmanager.h"
 
+class BackgroundTask;
+class CompressedResult;
+
+// Exposes every row of a result to the view. In-memory results are served
+// directly; spilled results are fetched in chunks of rows and columns as the
+// view scrolls, so wide results only read the columns on screen, with
+// neighbouring chunks prefetched in the background and a bounded chunk cache.
 class ResultsTableModel : public QAbstractTableModel
 {
     Q_OBJECT
 
 public:
     explicit ResultsTableModel(QObject *parent = nullptr);
+    ~ResultsTableModel() override;
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
@@ -21,38 +33,130 @@ public:
     
     Qt::ItemFlags flags(const QModelIndex &index) const override;
     
-    void setResults(const DuckDBManager::QueryResult &results);
+    // Formatted display strings of one chunk of result cells, filled lazily as cells are painted
+    struct DisplayBlock {
+        std::vector<QString> text;
+        std::vector<bool> ready;
+    };
+
+    // Everything setSnapshot() needs, built off the GUI thread by prepareSnapshot()
+    struct Snapshot {
+        DuckDBManager::QueryResult results;
+        DisplayBlock firstChunk;  // The first chunk of cells, already formatted for the first paint
+    };
+
+    // Thread-safe; does the per-cell work so setSnapshot() is a constant-time swap
+    static std::shared_ptr<Snapshot> prepareSnapshot(const DuckDBManager::QueryResult &results);
+
+    // Used to fetch blocks of spilled results
+    void setDatabaseManager(std::shared_ptr<DuckDBManager> dbManager) { m_dbManager = std::move(dbManager); }
+    void setSnapshot(const std::shared_ptr<Snapshot> &snapshot);
     void clear();
 
-    int getCurrentPage() const { return m_currentPage; }
-    int getTotalPages() const;
-    int getTotalRows() const { return m_totalRows; }
-    int getRowsPerPage() const { return m_rowsPerPage; }
+    qint64 getTotalRows() const { return m_totalRows; }
+    // Changes whenever the model is given another result, so data derived from it can be cached by it
+    quint64 resultId() const { return m_resultId; }
+    bool isSpilled() const { return m_spill != nullptr; }
+    std::shared_ptr<DuckDBManager::SpillFile> getSpillFile() const { return m_spill; }
 
-    void setCurrentPage(int page);
-    void setRowsPerPage(int rowsPerPage);
+    // Swaps the in-memory rows for a compressed copy of them (a tab going into the background);
+    // pages are decompressed as the grid reaches them
+    void setCompressed(const std::shared_ptr<CompressedResult> &compressed);
+    bool isCompressed() const { return m_compressed != nullptr; }
+    std::shared_ptr<CompressedResult> compressedResult() const { return m_compressed; }
 
-    // Export functionality
-    bool exportToCSV(const QString &filePath) const;
-    bool exportToTSV(const QString &filePath) const;
+    // Shows the result bottom-up, which is how a sort with every direction flipped
+    // reads when ascending sorts put NULLs last and descending ones put them first
+    void setReversed(bool reversed);
+    bool isReversed() const { return m_reversed; }
+    // Hidden columns are projected away when spilled chunks are fetched
+    void setColumnHidden(int column, bool hidden);
+    bool isColumnHidden(int column) const { return m_hiddenColumns.contains(column); }
+    QSet<int> hiddenColumns() const { return m_hiddenColumns; }
 
-signals:
-    void pageChanged(int currentPage, int totalPages);
+    // (column, order) per sort key, used to number the headers of multi-column sorts
+    void setSortMarkers(const QList<QPair<int, Qt::SortOrder>> &sortColumns);
+    QList<QPair<int, Qt::SortOrder>> sortMarkers() const { return m_sortMarkers; }
+    // Header tooltips by column name; they outlive setSnapshot so every query over the file gets them
+    void setColumnTooltips(const QHash<QString, QString> &tooltips);
+
+    // Raw (unformatted) access for copy/export; rows are indices into the full result
+    QStringList getColumnNames() const { return m_columnNames; }
+    QStringList getColumnTypes() const { return m_columnTypes; }
+    // Sorting and filtering run in DuckDB, so the only view-to-result mapping is the reversal
+    qint64 resultRow(int viewRow) const;
+    // The loaded value of a cell, or an invalid QVariant while its chunk is being fetched.
+    // Long text of spilled results is a DuckDBManager::TruncatedText preview.
+    QVariant cellValue(qint64 row, int column) const;
+    static bool isTruncated(const QVariant &value);
+    QList<QVariantList> getRows(const QList<qint64> &rows) const;
+    // Every row of an in-memory result (decompressed if need be); empty for spilled results
+    QList<QVariantList> allRows() const;
 
 private:
-    void updateVisibleData();
-    QString formatValue(const QVariant &value) const;
-    bool exportToDelimitedFile(const QString &filePath, const QString &delimiter) const;
+    const QVariant *cellData(qint64 row, int column) const;
+    // Spilled results are fetched in chunks of BLOCK_ROWS rows by COLUMN_GROUP_SIZE columns
+    static qint64 chunkKey(qint64 block, int group) { return block * MAX_COLUMN_GROUPS + group; }
+    int columnGroupCount() const;
+    QStringList chunkColumns(int group) const;
+    void requestChunk(qint64 block, int group);  // Queues only; startFetches() runs the queue
+    void prefetchAround(qint64 block, int group);
+    void startFetches();
+    void onChunkFetched(qint64 key, int version, const DuckDBManager::QueryResult &result);
+    void touchChunk(qint64 key) const;
+    void cancelFetches();
+    // Compressed results decompress one page per task on the interactive pool, queued like chunks
+    void requestPage(int page);
+    void startPageLoads();
+    void onPageLoaded(int page, const QList<QVariantList> &rows);
+    QString displayText(qint64 row, int column, const QVariant &value) const;
+    void releaseStorage();
+    static quint64 nextResultId();
+    static QString formatValue(const QVariant &value);
+    static QString formatDouble(double d);
 
     QStringList m_columnNames;
-    QList<QVariantList> m_allData;
-    QList<QVariantList> m_visibleData;
+    QStringList m_columnTypes;
+    QList<QVariantList> m_allData;   // Every row, or only the first block of a spilled result
+    std::shared_ptr<DuckDBManager::SpillFile> m_spill;
+    std::shared_ptr<CompressedResult> m_compressed;  // Replaces m_allData while set
+    std::shared_ptr<DuckDBManager> m_dbManager;
+    qint64 m_totalRows;
+    quint64 m_resultId;
+
+    bool m_reversed;
+    QList<QPair<int, Qt::SortOrder>> m_sortMarkers;
+    QHash<QString, QString> m_columnTooltips;
+    QSet<int> m_hiddenColumns;
+    QHash<int, int> m_groupVersions;  // Bumped when a column of the group is unhidden
+
+    // Spilled results: chunk key -> rows of the chunk's columns, least recently used first in m_blockLru
+    mutable QHash<qint64, QList<QVariantList>> m_blockCache;
+    mutable QList<qint64> m_blockLru;
+    mutable qint64 m_lastTouchedChunk;
+    // Formatted display strings per chunk of result cells
+    mutable QHash<qint64, DisplayBlock> m_displayCache;
+    mutable QList<qint64> m_displayLru;
+    mutable qint64 m_lastDisplayChunk;
+    // Compressed results: decompressed pages, least recently used first in m_pageLru
+    mutable QHash<int, QList<QVariantList>> m_pageCache;
+    mutable QList<int> m_pageLru;
+    mutable int m_lastTouchedPage;
+    QList<int> m_wantedPages;        // Most recently requested last
+    QHash<int, BackgroundTask*> m_pendingPages;
 
-    int m_currentPage;
-    int m_rowsPerPage;
-    int m_totalRows;
+    QList<qint64> m_wantedChunks;    // Most recently requested last
+    QHash<qint64, BackgroundTask*> m_pendingFetches;
 
-    static constexpr int DEFAULT_ROWS_PER_PAGE = 1000;
+    static constexpr int BLOCK_ROWS = 1000;
+    static constexpr int PREFETCH_BLOCKS = 2;
+    static constexpr int COLUMN_GROUP_SIZE = 64;
+    static constexpr qint64 MAX_COLUMN_GROUPS = 1 << 16;
+    static constexpr int MAX_CACHED_CHUNKS = 64;
+    static constexpr int MAX_DISPLAY_CHUNKS = 32;
+    static constexpr int MAX_WANTED_CHUNKS = 16;
+    static constexpr int MAX_CONCURRENT_FETCHES = 3;
+    static constexpr int MAX_CACHED_PAGES = 8;
 };
 
-#endif // RESULTSTABLEMODEL_H
\ No newline at end of file
+#endif // RESULTSTABLEMODEL_H
@@ -36,7 +36,8 @@ public:
     void executeQuery(const QString &query);
     bool isExecuting() const;
     
-    DuckDBManager::QueryResult getResults() const;
+    // Hands the last result over; the caller becomes its only in-memory holder
+    DuckDBManager::QueryResult takeResults();
     void cancelExecution();
 
 signals:
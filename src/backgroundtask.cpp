@@ -0,0 +1,190 @@
+#include "backgroundtask.h"
+#include <QThreadPool>
+#include <QDebug>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+struct BackgroundTaskState {
+    std::mutex mutex;
+    BackgroundTask *owner = nullptr;  // Cleared once the run is detached
+    std::atomic<bool> cancelled{false};
+};
+
+Q_GLOBAL_STATIC(QThreadPool, s_interactivePool)
+
+BackgroundTask::Control::Control(std::shared_ptr<BackgroundTaskState> state)
+    : m_state(std::move(state))
+{
+}
+
+bool BackgroundTask::Control::isCancelled() const
+{
+    return m_state->cancelled.load();
+}
+
+void BackgroundTask::Control::reportProgress(double percent, const QString &status)
+{
+    dispatch([percent, status](BackgroundTask *owner) {
+        emit owner->progress(percent, status);
+    });
+}
+
+void BackgroundTask::Control::post(const std::function<void()> &function)
+{
+    dispatch([function](BackgroundTask *) {
+        function();
+    });
+}
+
+void BackgroundTask::Control::dispatch(const std::function<void(BackgroundTask *owner)> &function)
+{
+    // Holding the lock keeps the owner from detaching (and so from being deleted) while this is queued;
+    // once queued, Qt drops the call if the owner is deleted before it runs
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    BackgroundTask *owner = m_state->owner;
+    if (!owner) {
+        return;
+    }
+
+    std::shared_ptr<BackgroundTaskState> state = m_state;
+    QMetaObject::invokeMethod(owner, [owner, state, function]() {
+        if (owner->m_state == state) {
+            function(owner);
+        }
+    }, Qt::QueuedConnection);
+}
+
+BackgroundTask::BackgroundTask(QObject *parent)
+    : QObject(parent)
+    , m_pool(QThreadPool::globalInstance())
+    , m_running(false)
+{
+}
+
+BackgroundTask::~BackgroundTask()
+{
+    // Only detaches: a run still going finishes on its own, holding what its work captured
+    detachCurrent();
+}
+
+QThreadPool *BackgroundTask::interactivePool()
+{
+    static QThreadPool *pool = []() {
+        QThreadPool *interactive = s_interactivePool();
+        interactive->setMaxThreadCount(INTERACTIVE_THREADS);
+        return interactive;
+    }();
+    return pool;
+}
+
+void BackgroundTask::start(Work work)
+{
+    detachCurrent();
+
+    auto state = std::make_shared<BackgroundTaskState>();
+    state->owner = this;
+    m_state = state;
+    m_running = true;
+
+    m_pool->start([state, work]() {
+        Control control(state);
+
+        if (!state->cancelled.load()) {
+            try {
+                work(control);
+            } catch (const std::exception &e) {
+                qCritical() << "BackgroundTask exception:" << e.what();
+            } catch (...) {
+                qCritical() << "BackgroundTask unknown exception";
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (BackgroundTask *owner = state->owner) {
+            bool cancelled = state->cancelled.load();
+            QMetaObject::invokeMethod(owner, [owner, state, cancelled]() {
+                if (owner->m_state == state) {
+                    owner->m_running = false;
+                    emit owner->finished(cancelled);
+                }
+            }, Qt::QueuedConnection);
+        }
+    });
+}
+
+void BackgroundTask::parallelFor(int count, const std::function<void(int index)> &work)
+{
+    struct Shared {
+        std::atomic<int> next{0};
+        std::mutex mutex;
+        std::condition_variable helpersDone;
+        int helpers = 0;
+    };
+    auto shared = std::make_shared<Shared>();
+
+    auto drain = [shared, count, &work]() {
+        for (int index = shared->next++; index < count; index = shared->next++) {
+            work(index);
+        }
+    };
+
+    // Helpers only run if a pool thread is free right now; the calling thread takes whatever is left
+    QThreadPool *pool = QThreadPool::globalInstance();
+    for (int helper = 1; helper < count; ++helper) {
+        {
+            std::lock_guard<std::mutex> lock(shared->mutex);
+            ++shared->helpers;
+        }
+        bool started = pool->tryStart([shared, drain]() {
+            drain();
+            std::lock_guard<std::mutex> lock(shared->mutex);
+            if (--shared->helpers == 0) {
+                shared->helpersDone.notify_all();
+            }
+        });
+        if (!started) {
+            std::lock_guard<std::mutex> lock(shared->mutex);
+            --shared->helpers;
+            break;
+        }
+    }
+
+    drain();
+
+    std::unique_lock<std::mutex> lock(shared->mutex);
+    shared->helpersDone.wait(lock, [&shared]() { return shared->helpers == 0; });
+}
+
+void BackgroundTask::release(std::shared_ptr<void> retired)
+{
+    if (!retired) {
+        return;
+    }
+    QThreadPool::globalInstance()->start([retired]() mutable {
+        retired.reset();
+    });
+}
+
+void BackgroundTask::cancel()
+{
+    if (m_state) {
+        m_state->cancelled.store(true);
+    }
+}
+
+void BackgroundTask::detachCurrent()
+{
+    if (!m_state) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->cancelled.store(true);
+        m_state->owner = nullptr;
+    }
+
+    m_state.reset();
+    m_running = false;
+}
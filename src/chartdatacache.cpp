@@ -0,0 +1,70 @@
+#include "chartdatacache.h"
+#include <QHashFunctions>
+
+bool ChartDataCache::Key::operator==(const Key &other) const
+{
+    return resultId == other.resultId && sourceQuery == other.sourceQuery && chartType == other.chartType
+        && xColumn == other.xColumn && yColumn == other.yColumn && groupBy == other.groupBy
+        && aggregation == other.aggregation && bins == other.bins && binning == other.binning
+        && density == other.density && size == other.size && zoomed == other.zoomed
+        && minX == other.minX && maxX == other.maxX;
+}
+
+size_t qHash(const ChartDataCache::Key &key, size_t seed)
+{
+    return qHashMulti(seed, key.resultId, key.sourceQuery, key.chartType, key.xColumn, key.yColumn,
+                      key.groupBy, key.aggregation, key.bins, key.binning, key.density,
+                      key.size.width(), key.size.height(), key.zoomed, key.minX, key.maxX);
+}
+
+ChartDataCache::ChartDataCache()
+    : m_entries(MAX_COST_KB)
+{
+}
+
+std::shared_ptr<ChartDataCache> ChartDataCache::shared()
+{
+    static const std::shared_ptr<ChartDataCache> cache(new ChartDataCache());
+    return cache;
+}
+
+bool ChartDataCache::find(const Key &key, Entry *entry) const
+{
+    const Entry *cached = m_entries.object(key);
+    if (!cached) {
+        return false;
+    }
+    *entry = *cached;  // Lists and images are implicitly shared, so the copy is cheap
+    return true;
+}
+
+void ChartDataCache::insert(const Key &key, const Entry &entry)
+{
+    m_entries.insert(key, new Entry(entry), costKb(entry));
+}
+
+void ChartDataCache::remove(const Key &key)
+{
+    m_entries.remove(key);
+}
+
+void ChartDataCache::removeResult(quint64 resultId)
+{
+    const QList<Key> keys = m_entries.keys();
+    for (const Key &key : keys) {
+        if (key.resultId == resultId) {
+            m_entries.remove(key);
+        }
+    }
+}
+
+int ChartDataCache::costKb(const Entry &entry)
+{
+    // Rough heap size; labels count as short strings
+    qint64 bytes = (entry.points.size() + entry.linePoints.size()) * qint64(sizeof(QPointF));
+    bytes += (entry.chartData.xValues.size() + entry.chartData.yValues.size()) * qint64(sizeof(double));
+    bytes += entry.chartData.xLabels.size() * 64;
+    bytes += entry.density.counts.size() * qint64(sizeof(double));
+    bytes += entry.densityImage.sizeInBytes();
+    return static_cast<int>(qMin<qint64>(bytes / 1024 + 1, MAX_COST_KB));
+}
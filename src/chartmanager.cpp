@@ -1,5 +1,9 @@
 #include "chartmanager.h"
 #include "chartwidget.h"
+#include "chartdatacache.h"
+#include "resultfilter.h"
+#include "backgroundtask.h"
+#include "hyperloglog.h"
 #include <QDebug>
 #include <QRegularExpression>
 #include <QtMath>
@@ -10,8 +14,10 @@
 #include <QPushButton>
 #include <QTabWidget>
 #include <QFileInfo>
+#include <QTimeZone>
 #include <algorithm>
 #include <numeric>
+#include <cmath>
 
 ChartManager::ChartManager(QWidget *parent)
     : QWidget(parent)
@@ -21,6 +27,8 @@ ChartManager::ChartManager(QWidget *parent)
     , m_addChartButton(nullptr)
     , m_closePanelButton(nullptr)
     , m_tabWidget(nullptr)
+    , m_resultId(0)
+    , m_dataCache(ChartDataCache::shared())
     , m_chartCounter(0)
     , m_isVisible(true)
 {
@@ -30,6 +38,7 @@ ChartManager::ChartManager(QWidget *parent)
 
 ChartManager::~ChartManager()
 {
+    m_dataCache->removeResult(m_resultId);
     for (auto it = m_fileCharts.begin(); it != m_fileCharts.end(); ++it) {
         qDeleteAll(it.value());
     }
@@ -38,45 +47,103 @@ ChartManager::~ChartManager()
 
 QList<ChartManager::ColumnInfo> ChartManager::analyzeColumns(const DuckDBManager::QueryResult &results)
 {
-    QList<ColumnInfo> columnInfos;
+    QList<ColumnInfo> columnInfos(results.columnNames.size());
+    BackgroundTask::parallelFor(static_cast<int>(columnInfos.size()), [&](int column) {
+        columnInfos[column] = analyzeColumn(results, column);
+    });
+    return columnInfos;
+}
+
+ChartManager::ColumnInfo ChartManager::analyzeColumn(const DuckDBManager::QueryResult &results, int columnIndex)
+{
+    ColumnInfo info;
+    info.name = results.columnNames.value(columnIndex);
+    info.index = columnIndex;
+    
+    // DuckDB already knows the type; only VARCHAR and friends need a look at the values
+    bool known = false;
+    info.type = dataTypeForDuckDBType(results.columnTypes.value(columnIndex), &known);
+    if (!known) {
+        QVariantList sample;
+        for (const QVariantList &row : results.rows) {
+            if (sample.size() >= TYPE_SNIFF_SAMPLE) {
+                break;
+            }
+            if (columnIndex < row.size() && !row[columnIndex].isNull()) {
+                sample.append(row[columnIndex]);
+            }
+        }
+        info.type = detectColumnType(sample);
+    }
     
-    for (int i = 0; i < results.columnNames.size(); ++i) {
-        ColumnInfo info;
-        info.name = results.columnNames[i];
-        info.index = i;
+    HyperLogLog distinct;
+    QSet<QString> uniqueSet;
+    qint64 numericCount = 0;
+    double sumOfSquares = 0.0;  // Of differences from the running mean (Welford)
+    
+    for (const QVariantList &row : results.rows) {
+        if (columnIndex >= row.size() || row[columnIndex].isNull()) {
+            ++info.nullCount;
+            continue;
+        }
         
-        QVariantList columnData = getColumnData(results, i);
-        info.type = detectColumnType(columnData);
+        const QVariant &value = row[columnIndex];
+        ++info.count;
+        distinct.addHash(hashValue(value, info.type));
         
         if (info.type == NumericType) {
-            QList<double> numericValues;
-            for (const QVariant &value : columnData) {
-                bool ok;
-                double numValue = variantToDouble(value, &ok);
-                if (ok) {
-                    numericValues.append(numValue);
-                }
-            }
-            
-            if (!numericValues.isEmpty()) {
-                info.minValue = *std::min_element(numericValues.begin(), numericValues.end());
-                info.maxValue = *std::max_element(numericValues.begin(), numericValues.end());
-            }
-        } else if (info.type == StringType) {
+            bool ok;
+            double numValue = variantToDouble(value, &ok);
+            if (!ok) continue;
+            ++numericCount;
+            info.minValue = numericCount == 1 ? numValue : qMin(info.minValue, numValue);
+            info.maxValue = numericCount == 1 ? numValue : qMax(info.maxValue, numValue);
+            const double delta = numValue - info.mean;
+            info.mean += delta / numericCount;
+            sumOfSquares += delta * (numValue - info.mean);
+        } else if (info.type == StringType && uniqueSet.size() < MAX_UNIQUE_VALUES) {
             // Get unique values for categorical data (limit to reasonable number)
-            QSet<QString> uniqueSet;
-            for (const QVariant &value : columnData) {
-                if (!value.isNull() && uniqueSet.size() < 100) {
-                    uniqueSet.insert(value.toString());
-                }
-            }
-            info.uniqueValues = uniqueSet.values();
+            uniqueSet.insert(value.toString());
         }
-        
-        columnInfos.append(info);
     }
     
-    return columnInfos;
+    info.variance = numericCount > 1 ? sumOfSquares / (numericCount - 1) : 0.0;
+    info.approxDistinct = info.count > 0 ? qMin(distinct.estimate(), info.count) : 0;
+    info.uniqueValues = uniqueSet.values();
+    return info;
+}
+
+quint64 ChartManager::hashValue(const QVariant &value, DataType type)
+{
+    if (type == NumericType) {
+        bool ok;
+        double number = variantToDouble(value, &ok);
+        if (ok) {
+            // 1 and 1.0 count as one value, and so do 0.0 and -0.0
+            return qHash(number == 0.0 ? 0.0 : number);
+        }
+    }
+    if (value.typeId() == QMetaType::Bool) {
+        return value.toBool() ? 1 : 2;
+    }
+    return qHash(value.toString());
+}
+
+ChartManager::DataType ChartManager::dataTypeForDuckDBType(const QString &type, bool *known)
+{
+    const QString upper = type.trimmed().toUpper();
+    // VARCHAR may hold numbers or dates written as text, and an ENUM's labels are text too
+    if (upper.isEmpty() || upper == "VARCHAR" || upper == "ENUM") {
+        if (known) *known = false;
+        return StringType;
+    }
+    
+    if (known) *known = true;
+    if (ResultFilter::isNumericType(upper)) return NumericType;
+    if (upper == "BOOLEAN") return BooleanType;
+    if (upper == "DATE" || upper.startsWith("TIME")) return DateTimeType;
+    // INTERVAL, BLOB, UUID and nested types chart as categories
+    return StringType;
 }
 
 ChartManager::DataType ChartManager::detectColumnType(const QVariantList &columnData)
@@ -92,6 +159,7 @@ ChartManager::DataType ChartManager::detectColumnType(const QVariantList &column
     
     for (const QVariant &value : columnData) {
         if (value.isNull()) continue;
+        if (totalCount >= TYPE_SNIFF_SAMPLE) break;
         
         totalCount++;
         
@@ -162,7 +230,7 @@ ChartManager::ChartData ChartManager::prepareBarChartData(const DuckDBManager::Q
         }
     } else {
         // Aggregation required
-        QMap<QString, QList<double>> groupedData = groupNumericData(results, xColumn, yColumn, aggregation);
+        QMap<QString, QList<double>> groupedData = groupNumericData(results, xColumn, yColumn, aggregation, groupBy);
         
         for (auto it = groupedData.begin(); it != groupedData.end(); ++it) {
             data.xLabels.append(it.key());
@@ -192,7 +260,8 @@ ChartManager::ChartData ChartManager::prepareLineChartData(const DuckDBManager::
     }
     
     // Collect data points
-    QList<QPair<double, double>> points;
+    QList<QPointF> points;
+    points.reserve(results.rows.size());
     
     for (const QVariantList &row : results.rows) {
         if (xIndex < row.size() && yIndex < row.size()) {
@@ -201,25 +270,459 @@ ChartManager::ChartData ChartManager::prepareLineChartData(const DuckDBManager::
             double yValue = variantToDouble(row[yIndex], &yOk);
             
             if (xOk && yOk) {
-                points.append(qMakePair(xValue, yValue));
+                points.append(QPointF(xValue, yValue));
             }
         }
     }
     
-    // Sort by x-value for proper line drawing
-    std::sort(points.begin(), points.end(), [](const QPair<double, double> &a, const QPair<double, double> &b) {
-        return a.first < b.first;
-    });
+    // Sort by x-value for proper line drawing; results ordered by x are already sorted
+    auto byX = [](const QPointF &a, const QPointF &b) {
+        return a.x() < b.x();
+    };
+    if (!std::is_sorted(points.begin(), points.end(), byX)) {
+        std::stable_sort(points.begin(), points.end(), byX);
+    }
     
     // Extract sorted values
-    for (const auto &point : points) {
-        data.xValues.append(point.first);
-        data.yValues.append(point.second);
+    data.xValues.reserve(points.size());
+    data.yValues.reserve(points.size());
+    for (const QPointF &point : std::as_const(points)) {
+        data.xValues.append(point.x());
+        data.yValues.append(point.y());
     }
     
     return data;
 }
 
+ChartManager::ChartData ChartManager::prepareLineChartData(DuckDBManager *dbManager, const QString &query,
+                                                           const QString &xColumn, const QString &yColumn,
+                                                           int buckets, double minX, double maxX,
+                                                           const DuckDBManager::ProgressCallback &progress)
+{
+    ChartData data;
+    data.xAxisTitle = xColumn;
+    data.yAxisTitle = yColumn;
+    data.chartTitle = QString("%1 vs %2").arg(yColumn).arg(xColumn);
+    if (!dbManager || query.trimmed().isEmpty()) {
+        data.error = "No query to chart";
+        return data;
+    }
+    buckets = qMax(1, buckets);
+
+    QString points = QString("(SELECT TRY_CAST(%1 AS DOUBLE) AS x, TRY_CAST(%2 AS DOUBLE) AS y FROM %3) AS points "
+                             "WHERE x IS NOT NULL AND y IS NOT NULL")
+                         .arg(DuckDBManager::quoteIdentifier(xColumn), DuckDBManager::quoteIdentifier(yColumn),
+                              DuckDBManager::asSubquery(query));
+
+    if (std::isnan(minX) || std::isnan(maxX)) {
+        DuckDBManager::QueryResult range = dbManager->executeBackgroundQuery(
+            QString("SELECT min(x), max(x) FROM %1").arg(points), progress);
+        if (!range.success || range.rows.isEmpty()) {
+            data.error = range.success ? QString("No rows") : range.error;
+            return data;
+        }
+        bool minOk = false;
+        bool maxOk = false;
+        minX = variantToDouble(range.rows.first().value(0), &minOk);
+        maxX = variantToDouble(range.rows.first().value(1), &maxOk);
+        if (!minOk || !maxOk) {
+            return data;  // No numeric points
+        }
+    } else {
+        points += QString(" AND x BETWEEN %1 AND %2").arg(minX, 0, 'g', 17).arg(maxX, 0, 'g', 17);
+    }
+
+    double bucketWidth = (maxX - minX) / buckets;
+    if (bucketWidth <= 0) {
+        bucketWidth = 1.0;
+    }
+
+    // The lowest and highest point of each bucket, with the x they occur at
+    DuckDBManager::QueryResult sampled = dbManager->executeBackgroundQuery(
+        QString("SELECT least(CAST(floor((x - %1) / %2) AS BIGINT), %3) AS bucket, "
+                "arg_min(x, y), min(y), arg_max(x, y), max(y) FROM %4 GROUP BY bucket ORDER BY bucket")
+            .arg(minX, 0, 'g', 17).arg(bucketWidth, 0, 'g', 17).arg(buckets - 1).arg(points), progress);
+    if (!sampled.success) {
+        data.error = sampled.error;
+        return data;
+    }
+
+    for (const QVariantList &row : std::as_const(sampled.rows)) {
+        if (row.size() < 5) {
+            continue;
+        }
+        QPointF low(variantToDouble(row[1]), variantToDouble(row[2]));
+        QPointF high(variantToDouble(row[3]), variantToDouble(row[4]));
+        if (high.x() < low.x()) {
+            std::swap(low, high);
+        }
+        data.xValues.append(low.x());
+        data.yValues.append(low.y());
+        if (high != low) {
+            data.xValues.append(high.x());
+            data.yValues.append(high.y());
+        }
+    }
+    return data;
+}
+
+ChartManager::TimeBucket ChartManager::chooseTimeBucket(double spanMs, int maxBuckets)
+{
+    static constexpr qint64 second = 1000;
+    static constexpr qint64 minute = 60 * second;
+    static constexpr qint64 hour = 60 * minute;
+    static constexpr qint64 day = 24 * hour;
+    static const QList<TimeBucket> buckets = {
+        {1, "second", second}, {5, "second", 5 * second}, {15, "second", 15 * second}, {30, "second", 30 * second},
+        {1, "minute", minute}, {5, "minute", 5 * minute}, {15, "minute", 15 * minute}, {30, "minute", 30 * minute},
+        {1, "hour", hour}, {3, "hour", 3 * hour}, {6, "hour", 6 * hour}, {12, "hour", 12 * hour},
+        {1, "day", day}, {1, "week", 7 * day}, {1, "month", 30 * day}, {3, "month", 91 * day},
+        {1, "year", 365 * day}, {5, "year", 5 * 365 * day}, {10, "year", 10 * 365 * day},
+        {100, "year", 100 * 365 * day}
+    };
+
+    maxBuckets = qMax(1, maxBuckets);
+    for (const TimeBucket &bucket : buckets) {
+        if (spanMs / bucket.approxMs <= maxBuckets) {
+            return bucket;
+        }
+    }
+    return buckets.last();
+}
+
+bool ChartManager::isTimestampType(const QString &type)
+{
+    const QString upper = type.trimmed().toUpper();
+    return upper == "DATE" || upper.startsWith("TIMESTAMP");
+}
+
+ChartManager::ChartData ChartManager::prepareTimeSeriesData(DuckDBManager *dbManager, const QString &query,
+                                                            const QString &xColumn, const QString &yColumn,
+                                                            AggregationType aggregation, int maxBuckets,
+                                                            double minMs, double maxMs,
+                                                            const DuckDBManager::ProgressCallback &progress)
+{
+    ChartData data;
+    data.xAxisTitle = xColumn;
+    data.yAxisTitle = yColumn;
+    if (!dbManager || query.trimmed().isEmpty()) {
+        data.error = "No query to chart";
+        return data;
+    }
+
+    // Text holding timestamps is read too; anything else that is not a timestamp is skipped
+    QString rows = QString("(SELECT TRY_CAST(%1 AS TIMESTAMP) AS __chart_time, %2 AS __chart_value FROM %3) AS timed "
+                           "WHERE __chart_time IS NOT NULL")
+                       .arg(DuckDBManager::quoteIdentifier(xColumn), DuckDBManager::quoteIdentifier(yColumn),
+                            DuckDBManager::asSubquery(query));
+
+    if (std::isnan(minMs) || std::isnan(maxMs)) {
+        DuckDBManager::QueryResult range = dbManager->executeBackgroundQuery(
+            QString("SELECT epoch_ms(min(__chart_time)), epoch_ms(max(__chart_time)) FROM %1").arg(rows), progress);
+        if (!range.success || range.rows.isEmpty()) {
+            data.error = range.success ? QString("No rows") : range.error;
+            return data;
+        }
+        bool minOk = false;
+        bool maxOk = false;
+        minMs = variantToDouble(range.rows.first().value(0), &minOk);
+        maxMs = variantToDouble(range.rows.first().value(1), &maxOk);
+        if (!minOk || !maxOk) {
+            return data;  // No timestamps
+        }
+    } else {
+        // Compared as timestamps, so the range can be pushed down to the scan
+        rows += QString(" AND __chart_time BETWEEN epoch_ms(%1) AND epoch_ms(%2)")
+                    .arg(qint64(std::floor(minMs))).arg(qint64(std::ceil(maxMs)));
+    }
+
+    const TimeBucket bucket = chooseTimeBucket(maxMs - minMs, maxBuckets);
+    data.timeUnit = bucket.unit;
+    data.timeBucket = bucket.label();
+    const QString start = bucket.count == 1
+        ? QString("date_trunc('%1', __chart_time)").arg(bucket.unit)
+        : QString("time_bucket(INTERVAL '%1 %2', __chart_time)").arg(bucket.count).arg(bucket.unit);
+    const QString value = aggregateExpression("__chart_value", aggregation == NoAggregation ? Average : aggregation);
+
+    DuckDBManager::QueryResult bucketed = dbManager->executeBackgroundQuery(
+        QString("SELECT epoch_ms(%1) AS bucket, %2 FROM %3 GROUP BY bucket ORDER BY bucket")
+            .arg(start, value, rows), progress);
+    if (!bucketed.success) {
+        data.error = bucketed.error;
+        return data;
+    }
+
+    for (const QVariantList &row : std::as_const(bucketed.rows)) {
+        bool xOk = false;
+        bool yOk = false;
+        double x = variantToDouble(row.value(0), &xOk);
+        double y = variantToDouble(row.value(1), &yOk);
+        if (xOk && yOk) {
+            data.xValues.append(x);
+            data.yValues.append(y);
+        }
+    }
+    return data;
+}
+
+ChartManager::ChartData ChartManager::prepareTimeSeriesData(const DuckDBManager::QueryResult &results,
+                                                            const QString &xColumn, const QString &yColumn,
+                                                            AggregationType aggregation, int maxBuckets,
+                                                            double minMs, double maxMs)
+{
+    ChartData data;
+    data.xAxisTitle = xColumn;
+    data.yAxisTitle = yColumn;
+
+    int xIndex = findColumnIndex(results.columnNames, xColumn);
+    int yIndex = findColumnIndex(results.columnNames, yColumn);
+    if (xIndex == -1 || yIndex == -1) {
+        return data;
+    }
+
+    const bool zoomed = !std::isnan(minMs) && !std::isnan(maxMs);
+    if (!zoomed) {
+        bool found = false;
+        for (const QVariantList &row : results.rows) {
+            qint64 time = 0;
+            if (timestampValue(row.value(xIndex), &time)) {
+                minMs = found ? qMin(minMs, double(time)) : time;
+                maxMs = found ? qMax(maxMs, double(time)) : time;
+                found = true;
+            }
+        }
+        if (!found) {
+            return data;
+        }
+    }
+
+    const TimeBucket bucket = chooseTimeBucket(maxMs - minMs, maxBuckets);
+    data.timeUnit = bucket.unit;
+    data.timeBucket = bucket.label();
+
+    QMap<qint64, QList<double>> buckets;
+    for (const QVariantList &row : results.rows) {
+        qint64 time = 0;
+        if (!timestampValue(row.value(xIndex), &time) || time < minMs || time > maxMs) {
+            continue;
+        }
+        bool ok = false;
+        double value = variantToDouble(row.value(yIndex), &ok);
+        if (ok || aggregation == Count) {
+            buckets[truncateTime(time, bucket)].append(value);
+        }
+    }
+
+    for (auto it = buckets.cbegin(); it != buckets.cend(); ++it) {
+        data.xValues.append(it.key());
+        data.yValues.append(calculateStatistic(it.value(), aggregation == NoAggregation ? Average : aggregation));
+    }
+    return data;
+}
+
+qint64 ChartManager::truncateTime(qint64 utcMs, const TimeBucket &bucket)
+{
+    const QDateTime time = QDateTime::fromMSecsSinceEpoch(utcMs, QTimeZone::utc());
+    QDate date = time.date();
+    if (bucket.unit == "year") {
+        date = QDate(date.year() - date.year() % bucket.count, 1, 1);
+    } else if (bucket.unit == "month") {
+        date = QDate(date.year(), date.month() - (date.month() - 1) % bucket.count, 1);
+    } else if (bucket.unit == "week") {
+        date = date.addDays(1 - date.dayOfWeek());  // Weeks start on Monday, as in date_trunc
+    } else if (bucket.unit != "day") {
+        return utcMs - (utcMs % bucket.approxMs + bucket.approxMs) % bucket.approxMs;
+    }
+    return QDateTime(date, QTime(0, 0), QTimeZone::utc()).toMSecsSinceEpoch();
+}
+
+bool ChartManager::timestampValue(const QVariant &value, qint64 *utcMs)
+{
+    // Loaded rows hold DuckDB's text form, e.g. "2024-03-01 12:30:00.25"
+    QDateTime time;
+    if (value.typeId() == QMetaType::QDateTime) {
+        time = value.toDateTime();
+    } else if (!value.isNull()) {
+        QString string = value.toString();
+        if (string.size() > 10 && string[10] == ' ') {
+            string[10] = 'T';
+        }
+        time = QDateTime::fromString(string, Qt::ISODateWithMs);
+        if (!time.isValid()) {
+            time = variantToDateTime(value);
+        }
+    }
+    if (!time.isValid()) {
+        return false;
+    }
+    *utcMs = QDateTime(time.date(), time.time(), QTimeZone::utc()).toMSecsSinceEpoch();
+    return true;
+}
+
+ChartManager::DensityGrid ChartManager::prepareDensityGrid(DuckDBManager *dbManager, const QString &query,
+                                                           const QString &xColumn, const QString &yColumn,
+                                                           int columns, int rows, double minX, double maxX,
+                                                           const DuckDBManager::ProgressCallback &progress)
+{
+    DensityGrid grid;
+    if (!dbManager || query.trimmed().isEmpty()) {
+        grid.error = "No query to chart";
+        return grid;
+    }
+    const bool zoomed = !std::isnan(minX) && !std::isnan(maxX);
+
+    QString points = QString("(SELECT TRY_CAST(%1 AS DOUBLE) AS x, TRY_CAST(%2 AS DOUBLE) AS y FROM %3) AS points "
+                             "WHERE x IS NOT NULL AND y IS NOT NULL")
+                         .arg(DuckDBManager::quoteIdentifier(xColumn), DuckDBManager::quoteIdentifier(yColumn),
+                              DuckDBManager::asSubquery(query));
+    if (zoomed) {
+        points += QString(" AND x BETWEEN %1 AND %2").arg(minX, 0, 'g', 17).arg(maxX, 0, 'g', 17);
+    }
+
+    DuckDBManager::QueryResult range = dbManager->executeBackgroundQuery(
+        QString("SELECT min(x), max(x), min(y), max(y), count(*) FROM %1").arg(points), progress);
+    if (!range.success || range.rows.isEmpty() || range.rows.first().size() < 5) {
+        grid.error = range.success ? QString("No rows") : range.error;
+        return grid;
+    }
+    const QVariantList &bounds = range.rows.first();
+    grid.points = bounds[4].toLongLong();
+    if (grid.points == 0) {
+        return grid;
+    }
+    grid.columns = qMax(1, columns);
+    grid.rows = qMax(1, rows);
+    grid.minX = zoomed ? minX : variantToDouble(bounds[0]);
+    grid.maxX = zoomed ? maxX : variantToDouble(bounds[1]);
+    grid.minY = variantToDouble(bounds[2]);
+    grid.maxY = variantToDouble(bounds[3]);
+    grid.counts = QList<double>(grid.columns * grid.rows, 0.0);
+
+    const double cellWidth = grid.maxX > grid.minX ? (grid.maxX - grid.minX) / grid.columns : 1.0;
+    const double cellHeight = grid.maxY > grid.minY ? (grid.maxY - grid.minY) / grid.rows : 1.0;
+    DuckDBManager::QueryResult cells = dbManager->executeBackgroundQuery(
+        QString("SELECT least(CAST(floor((x - %1) / %2) AS BIGINT), %3) AS cx, "
+                "least(CAST(floor((y - %4) / %5) AS BIGINT), %6) AS cy, count(*) FROM %7 GROUP BY cx, cy")
+            .arg(grid.minX, 0, 'g', 17).arg(cellWidth, 0, 'g', 17).arg(grid.columns - 1)
+            .arg(grid.minY, 0, 'g', 17).arg(cellHeight, 0, 'g', 17).arg(grid.rows - 1)
+            .arg(points), progress);
+    if (!cells.success) {
+        grid.error = cells.error;
+        return grid;
+    }
+    for (const QVariantList &row : std::as_const(cells.rows)) {
+        if (row.size() < 3) {
+            continue;
+        }
+        const int cx = row[0].toInt();
+        const int cy = row[1].toInt();
+        if (cx >= 0 && cx < grid.columns && cy >= 0 && cy < grid.rows) {
+            grid.counts[cy * grid.columns + cx] = variantToDouble(row[2]);
+        }
+    }
+    return grid;
+}
+
+ChartManager::DensityGrid ChartManager::binDensity(const QList<double> &xValues, const QList<double> &yValues,
+                                                   int columns, int rows, double minX, double maxX)
+{
+    DensityGrid grid;
+    const qsizetype count = qMin(xValues.size(), yValues.size());
+    const bool zoomed = !std::isnan(minX) && !std::isnan(maxX);
+    const double *xs = xValues.constData();
+    const double *ys = yValues.constData();
+
+    // Two tight passes over the raw arrays: the bounds, then one cell increment per point
+    double lowX = qInf();
+    double highX = -qInf();
+    double lowY = qInf();
+    double highY = -qInf();
+    for (qsizetype i = 0; i < count; ++i) {
+        if (zoomed && (xs[i] < minX || xs[i] > maxX)) {
+            continue;
+        }
+        lowX = qMin(lowX, xs[i]);
+        highX = qMax(highX, xs[i]);
+        lowY = qMin(lowY, ys[i]);
+        highY = qMax(highY, ys[i]);
+        ++grid.points;
+    }
+    if (grid.points == 0) {
+        return grid;
+    }
+
+    grid.columns = qMax(1, columns);
+    grid.rows = qMax(1, rows);
+    grid.minX = zoomed ? minX : lowX;
+    grid.maxX = zoomed ? maxX : highX;
+    grid.minY = lowY;
+    grid.maxY = highY;
+    grid.counts = QList<double>(grid.columns * grid.rows, 0.0);
+
+    const double scaleX = grid.maxX > grid.minX ? grid.columns / (grid.maxX - grid.minX) : 0.0;
+    const double scaleY = grid.maxY > grid.minY ? grid.rows / (grid.maxY - grid.minY) : 0.0;
+    double *cells = grid.counts.data();
+    for (qsizetype i = 0; i < count; ++i) {
+        if (zoomed && (xs[i] < minX || xs[i] > maxX)) {
+            continue;
+        }
+        const int cx = qMin(grid.columns - 1, int((xs[i] - grid.minX) * scaleX));
+        const int cy = qMin(grid.rows - 1, int((ys[i] - grid.minY) * scaleY));
+        cells[cy * grid.columns + cx] += 1.0;
+    }
+    return grid;
+}
+
+QList<QPointF> ChartManager::downsampleLttb(const QList<QPointF> &points, int threshold)
+{
+    if (threshold < 3 || points.size() <= threshold) {
+        return points;
+    }
+
+    QList<QPointF> sampled;
+    sampled.reserve(threshold);
+    sampled.append(points.first());
+
+    // The first and last points are kept; the rest are split into threshold - 2 buckets and
+    // each bucket keeps the point forming the largest triangle with the previous pick and the
+    // average of the next bucket
+    const double bucketSize = double(points.size() - 2) / (threshold - 2);
+    qsizetype previous = 0;
+    for (int bucket = 0; bucket < threshold - 2; ++bucket) {
+        const qsizetype start = qsizetype(bucket * bucketSize) + 1;
+        const qsizetype end = qsizetype((bucket + 1) * bucketSize) + 1;
+
+        const qsizetype nextStart = end;
+        const qsizetype nextEnd = qMin<qsizetype>(qsizetype((bucket + 2) * bucketSize) + 1, points.size());
+        double averageX = 0.0;
+        double averageY = 0.0;
+        for (qsizetype i = nextStart; i < nextEnd; ++i) {
+            averageX += points[i].x();
+            averageY += points[i].y();
+        }
+        const qsizetype nextCount = qMax<qsizetype>(1, nextEnd - nextStart);
+        averageX /= nextCount;
+        averageY /= nextCount;
+
+        const QPointF &anchor = points[previous];
+        double largestArea = -1.0;
+        qsizetype picked = start;
+        for (qsizetype i = start; i < end; ++i) {
+            const double area = std::abs((anchor.x() - averageX) * (points[i].y() - anchor.y()) -
+                                         (anchor.x() - points[i].x()) * (averageY - anchor.y()));
+            if (area > largestArea) {
+                largestArea = area;
+                picked = i;
+            }
+        }
+        sampled.append(points[picked]);
+        previous = picked;
+    }
+
+    sampled.append(points.last());
+    return sampled;
+}
+
 ChartManager::ChartData ChartManager::prepareScatterData(const DuckDBManager::QueryResult &results,
                                                          const QString &xColumn, const QString &yColumn,
                                                          const QString &colorBy)
@@ -260,30 +763,8 @@ ChartManager::ChartData ChartManager::preparePieChartData(const DuckDBManager::Q
     ChartData data;
     data.chartTitle = QString("%1 Distribution").arg(labelColumn);
     
-    int labelIndex = findColumnIndex(results.columnNames, labelColumn);
-    int valueIndex = findColumnIndex(results.columnNames, valueColumn);
-    
-    if (labelIndex == -1) {
-        return data;
-    }
-    
-    QMap<QString, QList<double>> groupedData;
-    
-    for (const QVariantList &row : results.rows) {
-        if (labelIndex < row.size()) {
-            QString label = row[labelIndex].toString();
-            
-            if (aggregation == Count) {
-                groupedData[label].append(1.0);
-            } else if (valueIndex != -1 && valueIndex < row.size()) {
-                bool ok;
-                double value = variantToDouble(row[valueIndex], &ok);
-                if (ok) {
-                    groupedData[label].append(value);
-                }
-            }
-        }
-    }
+    // Grouping returns nothing when the label column is missing
+    QMap<QString, QList<double>> groupedData = groupNumericData(results, labelColumn, valueColumn, aggregation);
     
     // Calculate aggregated values
     for (auto it = groupedData.begin(); it != groupedData.end(); ++it) {
@@ -354,6 +835,234 @@ ChartManager::ChartData ChartManager::prepareHistogramData(const DuckDBManager::
     return data;
 }
 
+ChartManager::ChartData ChartManager::prepareBarChartData(DuckDBManager *dbManager, const QString &query,
+                                                          const QString &xColumn, const QString &yColumn,
+                                                          const QString &groupBy, AggregationType aggregation,
+                                                          const DuckDBManager::ProgressCallback &progress)
+{
+    ChartData data = queryGroupedData(dbManager, query, xColumn, yColumn, aggregation, groupBy, progress);
+    data.xAxisTitle = xColumn;
+    data.yAxisTitle = yColumn;
+    data.chartTitle = QString("%1 by %2").arg(yColumn).arg(xColumn);
+    for (int i = 0; i < data.yValues.size(); ++i) {
+        data.xValues.append(i);
+    }
+    return data;
+}
+
+ChartManager::ChartData ChartManager::preparePieChartData(DuckDBManager *dbManager, const QString &query,
+                                                          const QString &labelColumn, const QString &valueColumn,
+                                                          AggregationType aggregation,
+                                                          const DuckDBManager::ProgressCallback &progress)
+{
+    ChartData data = queryGroupedData(dbManager, query, labelColumn, valueColumn, aggregation, QString(), progress);
+    data.chartTitle = QString("%1 Distribution").arg(labelColumn);
+    return data;
+}
+
+ChartManager::ChartData ChartManager::prepareHistogramData(DuckDBManager *dbManager, const QString &query,
+                                                           const QString &column, int bins, BinningType binning,
+                                                           const DuckDBManager::ProgressCallback &progress)
+{
+    ChartData data;
+    data.xAxisTitle = column;
+    data.yAxisTitle = "Frequency";
+    data.chartTitle = QString("Histogram of %1").arg(column);
+    if (!dbManager || query.trimmed().isEmpty()) {
+        data.error = "No query to chart";
+        return data;
+    }
+    bins = qMax(1, bins);
+
+    // Binned values: numbers as variantToDouble reads them, on a log10 scale for log bins
+    QString value = QString("TRY_CAST(%1 AS DOUBLE)").arg(DuckDBManager::quoteIdentifier(column));
+    if (binning == LogScaleBins) {
+        value = QString("CASE WHEN %1 > 0 THEN log10(%1) END").arg(value);
+    }
+    const QString values = QString("(SELECT %1 AS x FROM %2) AS binned")
+                               .arg(value, DuckDBManager::asSubquery(query));
+
+    // First pass: the range, or the quantile edges, of the values
+    QStringList rangeColumns = {"min(x)", "max(x)"};
+    if (binning == QuantileBins) {
+        for (int i = 1; i < bins; ++i) {
+            rangeColumns.append(QString("approx_quantile(x, %1)").arg(double(i) / bins, 0, 'g', 17));
+        }
+    }
+    DuckDBManager::QueryResult range = dbManager->executeBackgroundQuery(
+        QString("SELECT %1 FROM %2").arg(rangeColumns.join(", "), values), progress);
+    if (!range.success || range.rows.isEmpty()) {
+        data.error = range.success ? QString("No rows") : range.error;
+        return data;
+    }
+    const QVariantList &bounds = range.rows.first();
+    bool minOk = false;
+    bool maxOk = false;
+    const double minVal = variantToDouble(bounds.value(0), &minOk);
+    const double maxVal = variantToDouble(bounds.value(1), &maxOk);
+    if (!minOk || !maxOk) {
+        return data;  // No numeric values
+    }
+
+    QList<double> edges;
+    QString binExpression;
+    if (binning == QuantileBins) {
+        // Ties can repeat an edge; the bins between repeated edges stay empty
+        edges.append(minVal);
+        QStringList cases;
+        for (int i = 1; i < bins; ++i) {
+            double edge = variantToDouble(bounds.value(i + 1));
+            edges.append(edge);
+            cases.append(QString("WHEN x < %1 THEN %2").arg(edge, 0, 'g', 17).arg(i - 1));
+        }
+        edges.append(maxVal);
+        binExpression = QString("CASE %1 ELSE %2 END").arg(cases.join(" ")).arg(bins - 1);
+    } else {
+        double binWidth = (maxVal - minVal) / bins;
+        if (qFuzzyIsNull(maxVal - minVal)) {
+            binWidth = 1.0;
+        }
+        for (int i = 0; i <= bins; ++i) {
+            edges.append(minVal + i * binWidth);
+        }
+        binExpression = QString("least(CAST(floor((x - %1) / %2) AS BIGINT), %3)")
+                            .arg(minVal, 0, 'g', 17).arg(binWidth, 0, 'g', 17).arg(bins - 1);
+    }
+
+    // Second pass: one row per non-empty bin
+    DuckDBManager::QueryResult counts = dbManager->executeBackgroundQuery(
+        QString("SELECT %1 AS bin, count(*) FROM %2 WHERE x IS NOT NULL GROUP BY bin ORDER BY bin")
+            .arg(binExpression, values), progress);
+    if (!counts.success) {
+        data.error = counts.error;
+        return data;
+    }
+
+    QList<double> binCounts(bins, 0.0);
+    for (const QVariantList &row : std::as_const(counts.rows)) {
+        int bin = row.value(0).toInt();
+        if (row.size() >= 2 && bin >= 0 && bin < bins) {
+            binCounts[bin] = variantToDouble(row[1]);
+        }
+    }
+
+    for (int i = 0; i < bins; ++i) {
+        double binStart = edges[i];
+        double binEnd = edges[i + 1];
+        if (binning == LogScaleBins) {
+            binStart = std::pow(10.0, binStart);
+            binEnd = std::pow(10.0, binEnd);
+        }
+        if (binning == EqualWidthBins) {
+            data.xLabels.append(QString("[%1, %2)").arg(binStart, 0, 'f', 1).arg(binEnd, 0, 'f', 1));
+        } else {
+            data.xLabels.append(QString("[%1, %2)").arg(binStart, 0, 'g', 4).arg(binEnd, 0, 'g', 4));
+        }
+        data.yValues.append(binCounts[i]);
+        data.xValues.append(i);
+    }
+    return data;
+}
+
+QString ChartManager::groupedAggregationQuery(const QString &query, const QString &groupColumn,
+                                              const QString &valueColumn, AggregationType aggregation,
+                                              int limit, const QString &splitColumn)
+{
+    QString group = DuckDBManager::quoteIdentifier(groupColumn);
+    QString order = group + " NULLS FIRST";
+    if (!splitColumn.isEmpty()) {
+        const QString split = DuckDBManager::quoteIdentifier(splitColumn);
+        group += ", " + split;
+        order += ", " + split + " NULLS FIRST";
+    }
+    return QString("SELECT %1, %2 FROM %3 GROUP BY %1 ORDER BY %4 LIMIT %5")
+        .arg(group, aggregateExpression(valueColumn, aggregation), DuckDBManager::asSubquery(query), order,
+             QString::number(limit));
+}
+
+QString ChartManager::aggregateExpression(const QString &valueColumn, AggregationType aggregation)
+{
+    // Values are read the way variantToDouble reads cells: numbers as they are, numeric text
+    // parsed, anything else skipped. Standard deviation is the population one calculateStatistic uses.
+    const QString value = QString("TRY_CAST(%1 AS DOUBLE)").arg(DuckDBManager::quoteIdentifier(valueColumn));
+    QString aggregate;
+    switch (aggregation) {
+    case Count:
+        aggregate = "count(*)";
+        break;
+    case Sum:
+        aggregate = QString("sum(%1)").arg(value);
+        break;
+    case Average:
+        aggregate = QString("avg(%1)").arg(value);
+        break;
+    case Minimum:
+        aggregate = QString("min(%1)").arg(value);
+        break;
+    case Maximum:
+        aggregate = QString("max(%1)").arg(value);
+        break;
+    case StandardDeviation:
+        aggregate = QString("stddev_pop(%1)").arg(value);
+        break;
+    case NoAggregation:
+        // Callers keep NoAggregation off DuckDB or resolve it first; first() would pick an
+        // arbitrary row of each group under a parallel GROUP BY
+        aggregate = QString("avg(%1)").arg(value);
+        break;
+    }
+    return aggregate;
+}
+
+ChartManager::ChartData ChartManager::queryGroupedData(DuckDBManager *dbManager, const QString &query,
+                                                       const QString &groupColumn, const QString &valueColumn,
+                                                       AggregationType aggregation, const QString &splitColumn,
+                                                       const DuckDBManager::ProgressCallback &progress)
+{
+    ChartData data;
+    if (!dbManager || query.trimmed().isEmpty()) {
+        data.error = "No query to chart";
+        return data;
+    }
+    if (aggregation == NoAggregation) {
+        data.error = "No aggregation to compute";
+        return data;
+    }
+    if (aggregation != Count && valueColumn.isEmpty()) {
+        data.error = "No value column";
+        return data;
+    }
+
+    // One row past the limit tells whether groups were left out
+    DuckDBManager::QueryResult grouped = dbManager->executeBackgroundQuery(
+        groupedAggregationQuery(query, groupColumn, valueColumn, aggregation, MAX_CHART_GROUPS + 1, splitColumn),
+        progress);
+    if (!grouped.success) {
+        data.error = grouped.error;
+        return data;
+    }
+
+    for (const QVariantList &row : std::as_const(grouped.rows)) {
+        if (data.xLabels.size() == MAX_CHART_GROUPS) {
+            data.truncated = true;
+            break;
+        }
+        const int valueIndex = splitColumn.isEmpty() ? 1 : 2;
+        if (row.size() <= valueIndex) {
+            continue;
+        }
+        QString label = row[0].isNull() ? QString() : row[0].toString();
+        if (!splitColumn.isEmpty()) {
+            label = QString("%1 / %2").arg(label, row[1].isNull() ? QString() : row[1].toString());
+        }
+        data.xLabels.append(label);
+        bool ok = false;
+        double value = variantToDouble(row[valueIndex], &ok);
+        data.yValues.append(ok ? value : 0.0);
+    }
+    return data;
+}
+
 double ChartManager::calculateStatistic(const QList<double> &values, AggregationType type)
 {
     if (values.isEmpty()) {
@@ -428,7 +1137,7 @@ double ChartManager::variantToDouble(const QVariant &value, bool *ok)
         if (ok) *ok = false;
         return 0.0;
     }
-    
+
     switch (value.typeId()) {
     case QMetaType::Double:
     case QMetaType::Float:
@@ -458,7 +1167,7 @@ QDateTime ChartManager::variantToDateTime(const QVariant &value, bool *ok)
         if (ok) *ok = false;
         return QDateTime();
     }
-    
+
     if (value.typeId() == QMetaType::QDateTime) {
         return value.toDateTime();
     }
@@ -535,12 +1244,13 @@ QVariantList ChartManager::getColumnData(const DuckDBManager::QueryResult &resul
 
 QMap<QString, QList<double>> ChartManager::groupNumericData(const DuckDBManager::QueryResult &results,
                                                             const QString &groupColumn, const QString &valueColumn,
-                                                            AggregationType aggregation)
+                                                            AggregationType aggregation, const QString &splitColumn)
 {
     QMap<QString, QList<double>> groupedData;
     
     int groupIndex = findColumnIndex(results.columnNames, groupColumn);
     int valueIndex = findColumnIndex(results.columnNames, valueColumn);
+    int splitIndex = splitColumn.isEmpty() ? -1 : findColumnIndex(results.columnNames, splitColumn);
     
     if (groupIndex == -1) {
         return groupedData;
@@ -549,6 +1259,9 @@ QMap<QString, QList<double>> ChartManager::groupNumericData(const DuckDBManager:
     for (const QVariantList &row : results.rows) {
         if (groupIndex < row.size()) {
             QString groupKey = row[groupIndex].toString();
+            if (splitIndex != -1 && splitIndex < row.size()) {
+                groupKey = QString("%1 / %2").arg(groupKey, row[splitIndex].toString());
+            }
             
             if (aggregation == Count) {
                 groupedData[groupKey].append(1.0);
@@ -616,9 +1329,29 @@ void ChartManager::setupConnections()
     connect(m_tabWidget, &QTabWidget::currentChanged, this, &ChartManager::onTabChanged);
 }
 
-void ChartManager::setData(const DuckDBManager::QueryResult &results, const QString &fileName)
+void ChartManager::setQuerySource(std::shared_ptr<DuckDBManager> dbManager, const QString &query)
+{
+    m_dbManager = std::move(dbManager);
+    m_sourceQuery = query;
+}
+
+void ChartManager::applyData(ChartWidget *chartWidget)
+{
+    chartWidget->setQuerySource(m_dbManager, m_sourceQuery);
+    chartWidget->setDataCache(m_dataCache);
+    chartWidget->setData(m_currentData, m_compressedData, m_resultId);
+}
+
+void ChartManager::setData(const DuckDBManager::QueryResult &results, const QString &fileName, quint64 resultId,
+                           const std::shared_ptr<CompressedResult> &compressed)
 {
     m_currentData = results;
+    m_compressedData = compressed;
+    if (resultId != m_resultId) {
+        // Entries of an earlier result can never be hit again
+        m_dataCache->removeResult(m_resultId);
+    }
+    m_resultId = resultId;
     
     // If switching to a different file, save current charts and restore charts for new file
     if (!fileName.isEmpty() && fileName != m_currentFileName) {
@@ -631,7 +1364,7 @@ void ChartManager::setData(const DuckDBManager::QueryResult &results, const QStr
         for (int i = 0; i < m_tabWidget->count(); ++i) {
             ChartWidget *chartWidget = qobject_cast<ChartWidget*>(m_tabWidget->widget(i));
             if (chartWidget) {
-                chartWidget->setData(results);
+                applyData(chartWidget);
             }
         }
     }
@@ -644,6 +1377,29 @@ void ChartManager::setData(const DuckDBManager::QueryResult &results, const QStr
     }
 }
 
+void ChartManager::compactData(const QList<QVariantList> &rows, const std::shared_ptr<CompressedResult> &compressed)
+{
+    if (!m_currentData.rows.isEmpty() && m_currentData.rows.constData() == rows.constData()) {
+        m_currentData.rows.clear();
+        m_compressedData = compressed;
+    }
+    for (int i = 0; i < m_tabWidget->count(); ++i) {
+        if (ChartWidget *chartWidget = qobject_cast<ChartWidget*>(m_tabWidget->widget(i))) {
+            chartWidget->compactData(rows, compressed);
+        }
+    }
+    for (const QList<ChartWidget*> &charts : std::as_const(m_fileCharts)) {
+        for (ChartWidget *chartWidget : charts) {
+            chartWidget->compactData(rows, compressed);
+        }
+    }
+}
+
+void ChartManager::releaseCachedData()
+{
+    m_dataCache->removeResult(m_resultId);
+}
+
 void ChartManager::clearCharts()
 {
     // Clear all charts but keep at least one tab
@@ -660,6 +1416,11 @@ void ChartManager::clearCharts()
     }
     
     m_currentData = DuckDBManager::QueryResult();
+    m_compressedData.reset();
+    m_dbManager.reset();
+    m_sourceQuery.clear();
+    m_dataCache->removeResult(m_resultId);
+    m_resultId = 0;
     m_currentFileName.clear();
     m_titleLabel->setText("Charts");
 }
@@ -725,7 +1486,7 @@ void ChartManager::createNewChart(const QString &title)
     
     // Set data if we have it
     if (!m_currentData.columnNames.isEmpty()) {
-        chartWidget->setData(m_currentData);
+        applyData(chartWidget);
     }
     
     int index = m_tabWidget->addTab(chartWidget, title);
@@ -761,7 +1522,7 @@ void ChartManager::saveCurrentFileCharts()
         if (chartWidget) {
             // Create a copy of the chart widget to store
             ChartWidget *chartCopy = new ChartWidget();
-            chartCopy->setData(m_currentData);
+            applyData(chartCopy);
             // Note: In a full implementation, we'd save/restore chart configurations
             // For now, we just store the widget itself
             charts.append(chartCopy);
@@ -787,7 +1548,7 @@ void ChartManager::restoreFileCharts(const QString &fileName)
         const QList<ChartWidget*> &charts = m_fileCharts[fileName];
         for (int i = 0; i < charts.size(); ++i) {
             ChartWidget *chartWidget = new ChartWidget();
-            chartWidget->setData(m_currentData);
+            applyData(chartWidget);
             
             QString title = QString("Chart %1").arg(i + 1);
             m_tabWidget->addTab(chartWidget, title);
@@ -1,5 +1,6 @@
 #include "chartwidget.h"
 #include "chartmanager.h"
+#include "compressedresult.h"
 #include <QChart>
 #include <QChartView>
 #include <QBarSeries>
@@ -18,6 +19,7 @@
 #include <QGroupBox>
 #include <QSpinBox>
 #include <QCheckBox>
+#include <QProgressBar>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QPixmap>
@@ -26,6 +28,12 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QDebug>
+#include <QTimer>
+#include <QGraphicsPixmapItem>
+#include <QLocale>
+#include <QTimeZone>
+#include <cmath>
+#include <algorithm>
 
 ChartWidget::ChartWidget(QWidget *parent)
     : QWidget(parent)
@@ -44,9 +52,19 @@ ChartWidget::ChartWidget(QWidget *parent)
     , m_showGridCheck(nullptr)
     , m_showLegendCheck(nullptr)
     , m_binsSpin(nullptr)
+    , m_binningCombo(nullptr)
+    , m_scatterModeCombo(nullptr)
+    , m_busyIndicator(nullptr)
     , m_statsLabel(nullptr)
     , m_chartView(nullptr)
     , m_chart(nullptr)
+    , m_resultId(0)
+    , m_lineFromQuery(false)
+    , m_prepareTask(nullptr)
+    , m_resampleTask(nullptr)
+    , m_resampleTimer(nullptr)
+    , m_densityFromQuery(false)
+    , m_densityItem(nullptr)
     , m_currentType(BarChart)
     , m_barSeries(nullptr)
     , m_lineSeries(nullptr)
@@ -85,7 +103,7 @@ void ChartWidget::setupUI()
     // Chart type selector
     m_controlsLayout->addWidget(new QLabel("Type:"));
     m_chartTypeCombo = new QComboBox();
-    m_chartTypeCombo->addItems({"Bar Chart", "Line Chart", "Scatter Plot", "Pie Chart", "Histogram"});
+    m_chartTypeCombo->addItems({"Bar Chart", "Line Chart", "Scatter Plot", "Pie Chart", "Histogram", "Time Series"});
     m_chartTypeCombo->setToolTip("Select the type of chart to display");
     m_controlsLayout->addWidget(m_chartTypeCombo);
 
@@ -134,6 +152,19 @@ void ChartWidget::setupUI()
     m_binsSpin->setVisible(false);
     binsLabel->setVisible(false);
     row1->addWidget(m_binsSpin);
+    m_binningCombo = new QComboBox();
+    m_binningCombo->addItems({"Equal width", "Log scale", "Quantiles"});
+    m_binningCombo->setToolTip("Equal-width bins, equal width on a log10 scale (positive values only), "
+                               "or bins split at approximate quantiles");
+    m_binningCombo->setVisible(false);
+    row1->addWidget(m_binningCombo);
+    m_scatterModeCombo = new QComboBox();
+    m_scatterModeCombo->addItems({"Auto", "Points", "Density"});
+    m_scatterModeCombo->setToolTip(QString("Draw every point, or a heat map of point counts per cell; "
+                                           "Auto switches to density above %1 points")
+                                       .arg(DENSITY_POINT_THRESHOLD));
+    m_scatterModeCombo->setVisible(false);
+    row1->addWidget(m_scatterModeCombo);
 
     row1->addStretch();
     groupLayout->addLayout(row1);
@@ -161,6 +192,16 @@ void ChartWidget::setupUI()
 
     row2->addStretch();
 
+    // Busy indicator while the chart is prepared in the background
+    m_busyIndicator = new QProgressBar();
+    m_busyIndicator->setRange(0, 0);
+    m_busyIndicator->setMaximumWidth(80);
+    m_busyIndicator->setMaximumHeight(12);
+    m_busyIndicator->setTextVisible(false);
+    m_busyIndicator->setToolTip("Preparing chart...");
+    m_busyIndicator->setVisible(false);
+    row2->addWidget(m_busyIndicator);
+
     // Stats label
     m_statsLabel = new QLabel("No data");
     row2->addWidget(m_statsLabel);
@@ -178,6 +219,21 @@ void ChartWidget::setupUI()
     m_chartView = new QChartView(m_chart);
     m_chartView->setRenderHint(QPainter::Antialiasing);
     m_chartView->setStyleSheet("background-color: #2b2b2b; border: 1px solid #555;");
+    // Drag to zoom into an x range (right-click zooms out); line charts are re-sampled for it
+    m_chartView->setRubberBand(QChartView::HorizontalRubberBand);
+
+    m_prepareTask = new BackgroundTask(this);
+    m_resampleTask = new BackgroundTask(this);
+    m_resampleTimer = new QTimer(this);
+    m_resampleTimer->setSingleShot(true);
+    m_resampleTimer->setInterval(RESAMPLE_DELAY_MS);
+    connect(m_resampleTimer, &QTimer::timeout, this, &ChartWidget::resampleZoomed);
+
+    // Behind the grid lines (z 2) and above the plot area background (z 0)
+    m_densityItem = new QGraphicsPixmapItem(m_chart);
+    m_densityItem->setZValue(0.5);
+    m_densityItem->setVisible(false);
+    connect(m_chart, &QChart::plotAreaChanged, this, &ChartWidget::updateDensityImage);
     
     m_mainLayout->addWidget(m_chartView);
 }
@@ -196,19 +252,54 @@ void ChartWidget::setupConnections()
             this, &ChartWidget::onAggregationChanged);
     connect(m_binsSpin, QOverload<int>::of(&QSpinBox::valueChanged),
             this, &ChartWidget::onColumnSelectionChanged);
-    connect(m_refreshButton, &QPushButton::clicked, this, &ChartWidget::onRefreshChart);
+    connect(m_binningCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &ChartWidget::onColumnSelectionChanged);
+    connect(m_scatterModeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &ChartWidget::onColumnSelectionChanged);
+    connect(m_refreshButton, &QPushButton::clicked, this, [this]() {
+        // An explicit refresh reads the result again instead of reusing the cached chart
+        if (m_dataCache) {
+            m_dataCache->remove(cacheKey(chartRequest()));
+        }
+        onRefreshChart();
+    });
     connect(m_exportButton, &QPushButton::clicked, this, &ChartWidget::onExportChart);
-    connect(m_showGridCheck, &QCheckBox::toggled, this, &ChartWidget::onColumnSelectionChanged);
-    connect(m_showLegendCheck, &QCheckBox::toggled, this, &ChartWidget::onColumnSelectionChanged);
+    connect(m_showGridCheck, &QCheckBox::toggled, this, &ChartWidget::onDisplayOptionsChanged);
+    connect(m_showLegendCheck, &QCheckBox::toggled, this, &ChartWidget::onDisplayOptionsChanged);
 }
 
-void ChartWidget::setData(const DuckDBManager::QueryResult &results)
+void ChartWidget::setData(const DuckDBManager::QueryResult &results,
+                          const std::shared_ptr<CompressedResult> &compressed, quint64 resultId)
 {
     m_data = results;
+    m_compressedData = compressed;
+    m_resultId = resultId;
+    if (compressed) {
+        m_data.rows.clear();
+    }
     populateColumnSelectors();
     onRefreshChart();
 }
 
+void ChartWidget::compactData(const QList<QVariantList> &rows, const std::shared_ptr<CompressedResult> &compressed)
+{
+    if (!m_data.rows.isEmpty() && m_data.rows.constData() == rows.constData()) {
+        m_data.rows.clear();
+        m_compressedData = compressed;
+    }
+}
+
+void ChartWidget::setQuerySource(std::shared_ptr<DuckDBManager> dbManager, const QString &query)
+{
+    m_dbManager = std::move(dbManager);
+    m_sourceQuery = query;
+}
+
+void ChartWidget::setDataCache(const std::shared_ptr<ChartDataCache> &cache)
+{
+    m_dataCache = cache;
+}
+
 void ChartWidget::populateColumnSelectors()
 {
     // Block signals during population to prevent premature chart updates
@@ -232,6 +323,9 @@ void ChartWidget::populateColumnSelectors()
         m_xAxisCombo->setCurrentIndex(0);
         m_yAxisCombo->setCurrentIndex(1);
     }
+    if (m_currentType == TimeSeriesChart) {
+        selectTimeColumn();
+    }
     
     m_statsLabel->setText(QString("%1 rows, %2 columns")
                          .arg(m_data.totalRows)
@@ -261,6 +355,12 @@ void ChartWidget::onChartTypeChanged()
         if (m_binsSpin) {
             m_binsSpin->setVisible(isHistogram);
         }
+        if (m_binningCombo) {
+            m_binningCombo->setVisible(isHistogram);
+        }
+        if (m_scatterModeCombo) {
+            m_scatterModeCombo->setVisible(m_currentType == ScatterChart);
+        }
 
         // Find and toggle bins label visibility
         if (m_controlsLayout) {
@@ -319,6 +419,16 @@ void ChartWidget::onChartTypeChanged()
                     m_yAxisLabel->setToolTip("Frequency is calculated automatically");
                     if (m_xAxisCombo) m_xAxisCombo->setToolTip("Select numeric column for histogram");
                     break;
+
+                case TimeSeriesChart:
+                    m_xAxisLabel->setText("Time:");
+                    m_xAxisLabel->setToolTip("DATE or TIMESTAMP column, bucketed to fit the chart width");
+                    m_yAxisLabel->setText("Values:");
+                    m_yAxisLabel->setToolTip("Column aggregated per time bucket");
+                    if (m_xAxisCombo) m_xAxisCombo->setToolTip("Select a date/time column");
+                    if (m_yAxisCombo) m_yAxisCombo->setToolTip("Select numeric column to aggregate (None averages)");
+                    selectTimeColumn();
+                    break;
             }
         }
 
@@ -353,6 +463,7 @@ void ChartWidget::onAggregationChanged()
 void ChartWidget::onRefreshChart()
 {
     try {
+        cancelPreparation();
         if (m_data.columnNames.isEmpty()) {
             clearChart();
             return;
@@ -360,77 +471,292 @@ void ChartWidget::onRefreshChart()
 
         // Clear existing series
         m_chart->removeAllSeries();
+        m_categoryLabels.clear();
+        m_linePoints.clear();
+        m_density = ChartManager::DensityGrid();
+        m_densityImage = QImage();
+        m_densityItem->setVisible(false);
         m_barSeries = nullptr;
         m_lineSeries = nullptr;
         m_scatterSeries = nullptr;
         m_pieSeries = nullptr;
+        m_chart->setTitle("Preparing chart...");
+
+        // The worker gets a copy of the settings and data and never touches the widgets.
+        // Starting again drops a refresh still running for an older configuration and
+        // interrupts its DuckDB query.
+        const ChartRequest request = chartRequest();
+        const ChartDataCache::Key key = cacheKey(request);
+        PreparedChart cached;
+        if (m_dataCache && request.resultId != 0 && m_dataCache->find(key, &cached)) {
+            showChart(request, cached);
+            return;
+        }
+
+        auto prepared = std::make_shared<PreparedChart>();
+        connect(m_prepareTask, &BackgroundTask::finished, this, [this, request, key, prepared](bool cancelled) {
+            m_busyIndicator->setVisible(false);
+            if (cancelled) {
+                return;
+            }
+            if (m_dataCache && request.resultId != 0 && prepared->message.isEmpty()) {
+                m_dataCache->insert(key, *prepared);
+            }
+            showChart(request, *prepared);
+        });
+        m_busyIndicator->setVisible(true);
+        m_prepareTask->start([request, prepared](BackgroundTask::Control &control) {
+            *prepared = prepareChart(request, control);
+        });
+    } catch (const std::exception &e) {
+        qCritical() << "ChartWidget::onRefreshChart exception:" << e.what();
+        m_chart->setTitle(QString("Chart Error: %1").arg(e.what()));
+    } catch (...) {
+        qCritical() << "ChartWidget::onRefreshChart unknown exception";
+        m_chart->setTitle("Chart Error: Unknown error");
+    }
+}
+
+void ChartWidget::cancelPreparation()
+{
+    // Disconnected first: a run that already finished may have its notification queued
+    disconnect(m_prepareTask, &BackgroundTask::finished, nullptr, nullptr);
+    disconnect(m_resampleTask, &BackgroundTask::finished, nullptr, nullptr);
+    m_prepareTask->cancel();
+    m_resampleTask->cancel();
+    m_resampleTimer->stop();
+    m_busyIndicator->setVisible(false);
+}
+
+void ChartWidget::selectTimeColumn()
+{
+    // Keep the x column if it is already a timestamp; otherwise start from the first one
+    const int current = m_xAxisCombo->currentIndex();
+    if (ChartManager::isTimestampType(m_data.columnTypes.value(current))) {
+        return;
+    }
+    for (int column = 0; column < m_data.columnTypes.size() && column < m_xAxisCombo->count(); ++column) {
+        if (ChartManager::isTimestampType(m_data.columnTypes[column])) {
+            m_xAxisCombo->blockSignals(true);
+            m_xAxisCombo->setCurrentIndex(column);
+            m_xAxisCombo->blockSignals(false);
+            return;
+        }
+    }
+}
+
+ChartWidget::ChartRequest ChartWidget::chartRequest() const
+{
+    ChartRequest request;
+    request.type = m_currentType;
+    request.xColumn = m_xAxisCombo ? m_xAxisCombo->currentText() : QString();
+    request.yColumn = m_yAxisCombo ? m_yAxisCombo->currentText() : QString();
+    request.groupBy = (m_groupByCombo && m_groupByCombo->currentText() != "(None)")
+                      ? m_groupByCombo->currentText() : QString();
+    request.aggregation = m_aggregationCombo
+        ? static_cast<ChartManager::AggregationType>(m_aggregationCombo->currentIndex())
+        : ChartManager::NoAggregation;
+    request.bins = m_binsSpin ? m_binsSpin->value() : DEFAULT_HISTOGRAM_BINS;
+    request.binning = m_binningCombo
+        ? static_cast<ChartManager::BinningType>(m_binningCombo->currentIndex())
+        : ChartManager::EqualWidthBins;
+
+    // Density mode bins the points into a grid drawn as one image; Auto picks it for results
+    // with more rows than a scatter series can draw
+    const int mode = m_scatterModeCombo ? m_scatterModeCombo->currentIndex() : 0;
+    request.density = mode == 2 || (mode == 0 && m_data.totalRows > DENSITY_POINT_THRESHOLD);
+    request.lineBuckets = lineSampleBuckets();
+    request.densityCells = densityGridSize();
+
+    request.data = m_data;
+    if (m_compressedData && m_compressedData->hasRows()) {
+        request.data.rows = m_compressedData->rows();
+    } else {
+        request.compressed = m_compressedData;
+    }
+    request.dbManager = m_dbManager;
+    request.sourceQuery = m_sourceQuery;
+    request.resultId = m_resultId;
+    return request;
+}
+
+ChartDataCache::Key ChartWidget::cacheKey(const ChartRequest &request)
+{
+    ChartDataCache::Key key;
+    key.resultId = request.resultId;
+    key.sourceQuery = request.sourceQuery;
+    key.chartType = request.type;
+    key.xColumn = request.xColumn;
+    key.yColumn = request.yColumn;
+    key.groupBy = request.groupBy;
+    key.aggregation = request.aggregation;
+    // Settings a chart type does not use stay out of its key, so changing them still hits
+    if (request.type == Histogram) {
+        key.bins = request.bins;
+        key.binning = request.binning;
+    } else if (request.type == LineChart || request.type == TimeSeriesChart) {
+        key.size = QSize(request.lineBuckets, 0);
+    } else if (request.type == ScatterChart) {
+        key.density = request.density;
+        key.size = request.density ? request.densityCells : QSize();
+    }
+    key.zoomed = !std::isnan(request.minX) && !std::isnan(request.maxX);
+    if (key.zoomed) {
+        key.minX = request.minX;
+        key.maxX = request.maxX;
+    }
+    return key;
+}
+
+DuckDBManager::QueryResult ChartWidget::loadedData(const ChartRequest &request)
+{
+    if (request.data.isSpilled() && request.dbManager) {
+        // Charts work on in-memory rows, so they get a bounded slice of a spilled result
+        DuckDBManager::QueryResult sample = request.dbManager->readSpillRows(*request.data.spill, 0, SPILL_SAMPLE_ROWS);
+        if (!sample.success) {
+            qWarning() << "Failed to read chart rows from spill file:" << sample.error;
+            return request.data;
+        }
+        return sample;
+    }
+    if (!request.compressed) {
+        return request.data;
+    }
+
+    // Page by page, leaving the result's shared row cache to the GUI thread
+    DuckDBManager::QueryResult data = request.data;
+    data.rows.reserve(request.compressed->rowCount());
+    for (int index = 0; index < request.compressed->pageCount(); ++index) {
+        data.rows.append(request.compressed->page(index));
+    }
+    return data;
+}
+
+ChartWidget::PreparedChart ChartWidget::prepareChart(const ChartRequest &request, BackgroundTask::Control &control)
+{
+    PreparedChart prepared;
+    try {
+        switch (request.type) {
+        case BarChart:
+            prepareBarChart(request, prepared, control);
+            break;
+        case LineChart:
+            prepareLineChart(request, prepared, control);
+            break;
+        case ScatterChart:
+            prepareScatterChart(request, prepared, control);
+            break;
+        case PieChart:
+            preparePieChart(request, prepared, control);
+            break;
+        case Histogram:
+            prepareHistogram(request, prepared, control);
+            break;
+        case TimeSeriesChart:
+            prepareTimeSeries(request, prepared, control);
+            break;
+        }
+    } catch (const std::exception &e) {
+        qCritical() << "ChartWidget::prepareChart exception:" << e.what();
+        prepared.message = QString("Chart Error: %1").arg(e.what());
+    } catch (...) {
+        qCritical() << "ChartWidget::prepareChart unknown exception";
+        prepared.message = "Chart Error: Unknown error";
+    }
+    return prepared;
+}
 
-        switch (m_currentType) {
+void ChartWidget::showChart(const ChartRequest &request, const PreparedChart &prepared)
+{
+    try {
+        if (!prepared.message.isEmpty()) {
+            m_chart->setTitle(prepared.message);
+            return;
+        }
+
+        switch (request.type) {
         case BarChart:
-            createBarChart();
+            createBarChart(request, prepared);
             break;
         case LineChart:
-            createLineChart();
+            createLineChart(request, prepared);
             break;
         case ScatterChart:
-            createScatterChart();
+            createScatterChart(request, prepared);
             break;
         case PieChart:
-            createPieChart();
+            createPieChart(request, prepared);
             break;
         case Histogram:
-            createHistogram();
+            createHistogram(request, prepared);
+            break;
+        case TimeSeriesChart:
+            createTimeSeriesChart(request, prepared);
             break;
         }
 
         updateChartTheme();
         configureAxes();
     } catch (const std::exception &e) {
-        qCritical() << "ChartWidget::onRefreshChart exception:" << e.what();
+        qCritical() << "ChartWidget::showChart exception:" << e.what();
         m_chart->setTitle(QString("Chart Error: %1").arg(e.what()));
     } catch (...) {
-        qCritical() << "ChartWidget::onRefreshChart unknown exception";
+        qCritical() << "ChartWidget::showChart unknown exception";
         m_chart->setTitle("Chart Error: Unknown error");
     }
 }
 
-void ChartWidget::createBarChart()
+DuckDBManager::ProgressCallback ChartWidget::interruptWhenCancelled(BackgroundTask::Control &control)
 {
-    try {
-        qDebug() << "createBarChart: Starting";
-
-        if (!m_chart) {
-            qWarning() << "createBarChart: m_chart is null";
-            return;
-        }
+    return [&control](double) {
+        return !control.isCancelled();
+    };
+}
 
-        ChartManager manager;
-        QString xColumn = m_xAxisCombo ? m_xAxisCombo->currentText() : QString();
-        QString yColumn = m_yAxisCombo ? m_yAxisCombo->currentText() : QString();
+void ChartWidget::prepareBarChart(const ChartRequest &request, PreparedChart &prepared,
+                                  BackgroundTask::Control &control)
+{
+    if (request.xColumn.isEmpty() || request.yColumn.isEmpty()) {
+        qWarning() << "createBarChart: Empty column selection";
+        prepared.message = "Select X and Y columns";
+        return;
+    }
 
-        if (xColumn.isEmpty() || yColumn.isEmpty()) {
-            qWarning() << "createBarChart: Empty column selection";
-            m_chart->setTitle("Select X and Y columns");
-            return;
+    ChartManager::ChartData &chartData = prepared.chartData;
+    if (request.dbManager && !request.sourceQuery.isEmpty() && request.aggregation != ChartManager::NoAggregation) {
+        // Aggregation runs in DuckDB over the whole result rather than the rows loaded here
+        chartData = ChartManager::prepareBarChartData(request.dbManager.get(), request.sourceQuery, request.xColumn,
+                                                      request.yColumn, request.groupBy, request.aggregation,
+                                                      interruptWhenCancelled(control));
+        if (!chartData.error.isEmpty() && !control.isCancelled()) {
+            qWarning() << "createBarChart: Aggregating loaded rows instead:" << chartData.error;
+            chartData = ChartManager::prepareBarChartData(loadedData(request), request.xColumn, request.yColumn,
+                                                          request.groupBy, request.aggregation);
         }
+    } else {
+        chartData = ChartManager::prepareBarChartData(loadedData(request), request.xColumn, request.yColumn,
+                                                      request.groupBy, request.aggregation);
+    }
 
-        QString groupBy = (m_groupByCombo && m_groupByCombo->currentText() != "(None)")
-                          ? m_groupByCombo->currentText() : QString();
-
-        ChartManager::AggregationType agg = m_aggregationCombo
-            ? static_cast<ChartManager::AggregationType>(m_aggregationCombo->currentIndex())
-            : ChartManager::NoAggregation;
+    if (chartData.yValues.isEmpty()) {
+        qWarning() << "createBarChart: No data to display";
+        prepared.message = "No data to display";
+    }
+}
 
-        auto chartData = manager.prepareBarChartData(m_data, xColumn, yColumn, groupBy, agg);
+void ChartWidget::createBarChart(const ChartRequest &request, const PreparedChart &prepared)
+{
+    try {
+        qDebug() << "createBarChart: Starting";
 
-        if (chartData.yValues.isEmpty()) {
-            qWarning() << "createBarChart: No data to display";
-            m_chart->setTitle("No data to display");
+        if (!m_chart) {
+            qWarning() << "createBarChart: m_chart is null";
             return;
         }
 
+        const ChartManager::ChartData &chartData = prepared.chartData;
         m_barSeries = new QBarSeries();
-        QBarSet *set = new QBarSet(yColumn);
+        QBarSet *set = new QBarSet(request.yColumn);
 
         for (double value : chartData.yValues) {
             *set << value;
@@ -439,14 +765,18 @@ void ChartWidget::createBarChart()
         set->setColor(QColor(42, 130, 218));
         m_barSeries->append(set);
         m_chart->addSeries(m_barSeries);
+        m_categoryLabels = chartData.xLabels;
 
         // Set descriptive title with aggregation info
-        QString title = QString("%1 by %2").arg(yColumn).arg(xColumn);
+        QString title = QString("%1 by %2").arg(request.yColumn).arg(request.xColumn);
         if (m_aggregationCombo && m_aggregationCombo->currentIndex() > 0) {
             title = QString("%1: %2 by %3")
                 .arg(m_aggregationCombo->currentText())
-                .arg(yColumn)
-                .arg(xColumn);
+                .arg(request.yColumn)
+                .arg(request.xColumn);
+        }
+        if (chartData.truncated) {
+            title += QString(" (first %1 groups)").arg(ChartManager::MAX_CHART_GROUPS);
         }
         m_chart->setTitle(title);
         m_chart->setTitleFont(QFont("Arial", 14, QFont::Bold));
@@ -461,44 +791,67 @@ void ChartWidget::createBarChart()
     }
 }
 
-void ChartWidget::createLineChart()
+void ChartWidget::prepareLineChart(const ChartRequest &request, PreparedChart &prepared,
+                                   BackgroundTask::Control &control)
 {
-    try {
-        qDebug() << "createLineChart: Starting";
+    if (request.xColumn.isEmpty() || request.yColumn.isEmpty()) {
+        qWarning() << "createLineChart: Empty column selection";
+        prepared.message = "Select X and Y columns";
+        return;
+    }
 
-        if (!m_chart) {
-            qWarning() << "createLineChart: m_chart is null";
+    // A line never needs more than about two points per pixel column of the plot
+    if (request.dbManager && !request.sourceQuery.isEmpty()) {
+        auto chartData = ChartManager::prepareLineChartData(request.dbManager.get(), request.sourceQuery, request.xColumn,
+                                                            request.yColumn, request.lineBuckets, qQNaN(), qQNaN(),
+                                                            interruptWhenCancelled(control));
+        if (chartData.error.isEmpty()) {
+            prepared.fromQuery = true;
+            for (int i = 0; i < chartData.xValues.size(); ++i) {
+                prepared.points.append(QPointF(chartData.xValues[i], chartData.yValues[i]));
+            }
+        } else if (control.isCancelled()) {
             return;
+        } else {
+            qWarning() << "createLineChart: Sampling loaded rows instead:" << chartData.error;
         }
-
-        ChartManager manager;
-        QString xColumn = m_xAxisCombo ? m_xAxisCombo->currentText() : QString();
-        QString yColumn = m_yAxisCombo ? m_yAxisCombo->currentText() : QString();
-
-        if (xColumn.isEmpty() || yColumn.isEmpty()) {
-            qWarning() << "createLineChart: Empty column selection";
-            m_chart->setTitle("Select X and Y columns");
-            return;
+    }
+    if (!prepared.fromQuery) {
+        auto chartData = ChartManager::prepareLineChartData(loadedData(request), request.xColumn, request.yColumn);
+        prepared.linePoints.reserve(chartData.xValues.size());
+        for (int i = 0; i < chartData.xValues.size(); ++i) {
+            prepared.linePoints.append(QPointF(chartData.xValues[i], chartData.yValues[i]));
         }
+        prepared.points = ChartManager::downsampleLttb(prepared.linePoints, 2 * request.lineBuckets);
+    }
 
-        auto chartData = manager.prepareLineChartData(m_data, xColumn, yColumn);
+    if (prepared.points.isEmpty()) {
+        qWarning() << "createLineChart: No data to display";
+        prepared.message = "No data to display";
+    }
+}
 
-        if (chartData.xValues.isEmpty() || chartData.yValues.isEmpty()) {
-            qWarning() << "createLineChart: No data to display";
-            m_chart->setTitle("No data to display");
+void ChartWidget::createLineChart(const ChartRequest &request, const PreparedChart &prepared)
+{
+    try {
+        qDebug() << "createLineChart: Starting";
+
+        if (!m_chart) {
+            qWarning() << "createLineChart: m_chart is null";
             return;
         }
 
-        m_lineSeries = new QLineSeries();
-        m_lineSeries->setName(yColumn);
+        m_linePoints = prepared.linePoints;
+        m_lineFromQuery = prepared.fromQuery;
 
-        for (int i = 0; i < chartData.xValues.size(); ++i) {
-            m_lineSeries->append(chartData.xValues[i], chartData.yValues[i]);
-        }
+        m_lineSeries = new QLineSeries();
+        m_lineSeries->setName(request.yColumn);
+        // One bulk replace instead of a repaint-triggering append per point
+        m_lineSeries->replace(prepared.points);
 
         m_lineSeries->setColor(QColor(42, 130, 218));
         m_chart->addSeries(m_lineSeries);
-        QString title = QString("%1 vs %2").arg(yColumn).arg(xColumn);
+        QString title = QString("%1 vs %2").arg(request.yColumn).arg(request.xColumn);
         m_chart->setTitle(title);
         m_chart->setTitleFont(QFont("Arial", 14, QFont::Bold));
 
@@ -512,45 +865,396 @@ void ChartWidget::createLineChart()
     }
 }
 
-void ChartWidget::createScatterChart()
+void ChartWidget::prepareTimeSeries(const ChartRequest &request, PreparedChart &prepared,
+                                    BackgroundTask::Control &control)
 {
-    try {
-        qDebug() << "createScatterChart: Starting";
+    if (request.xColumn.isEmpty() || request.yColumn.isEmpty()) {
+        prepared.message = "Select time and value columns";
+        return;
+    }
 
-        if (!m_chart) {
-            qWarning() << "createScatterChart: m_chart is null";
+    // Text columns may hold timestamps; any other typed column cannot be bucketed by time
+    const QString xType = request.data.columnTypes.value(request.data.columnNames.indexOf(request.xColumn));
+    bool known = false;
+    ChartManager::dataTypeForDuckDBType(xType, &known);
+    if (known && !ChartManager::isTimestampType(xType)) {
+        prepared.message = QString("'%1' is %2; a time series needs a DATE or TIMESTAMP column")
+                               .arg(request.xColumn, xType);
+        return;
+    }
+
+    const int maxBuckets = qMax(1, request.lineBuckets / TIME_BUCKET_PIXELS);
+    ChartManager::ChartData &chartData = prepared.chartData;
+    if (request.dbManager && !request.sourceQuery.isEmpty()) {
+        // Bucketed and aggregated by DuckDB over every row; one row per bucket comes back
+        chartData = ChartManager::prepareTimeSeriesData(request.dbManager.get(), request.sourceQuery, request.xColumn,
+                                                        request.yColumn, request.aggregation, maxBuckets,
+                                                        request.minX, request.maxX,
+                                                        interruptWhenCancelled(control));
+        prepared.fromQuery = chartData.error.isEmpty();
+        if (!prepared.fromQuery) {
+            if (control.isCancelled()) {
+                return;
+            }
+            qWarning() << "prepareTimeSeries: Bucketing loaded rows instead:" << chartData.error;
+        }
+    }
+    if (!prepared.fromQuery) {
+        chartData = ChartManager::prepareTimeSeriesData(loadedData(request), request.xColumn, request.yColumn,
+                                                        request.aggregation, maxBuckets, request.minX, request.maxX);
+    }
+
+    prepared.points.reserve(chartData.xValues.size());
+    for (int i = 0; i < chartData.xValues.size(); ++i) {
+        prepared.points.append(QPointF(wallClockToAxis(chartData.xValues[i]), chartData.yValues[i]));
+    }
+    if (prepared.points.isEmpty() && std::isnan(request.minX)) {
+        prepared.message = QString("No timestamps in column '%1'").arg(request.xColumn);
+    }
+}
+
+void ChartWidget::createTimeSeriesChart(const ChartRequest &request, const PreparedChart &prepared)
+{
+    m_lineFromQuery = prepared.fromQuery;
+    m_timeBucket = prepared.chartData.timeBucket;
+    m_timeUnit = prepared.chartData.timeUnit;
+
+    const ChartManager::AggregationType aggregation = request.aggregation == ChartManager::NoAggregation
+        ? ChartManager::Average : request.aggregation;
+    m_lineSeries = new QLineSeries();
+    m_lineSeries->setName(QString("%1 of %2").arg(ChartManager::aggregationTypeToString(aggregation),
+                                                  request.yColumn));
+    m_lineSeries->replace(prepared.points);
+    // A single bucket has no line to draw
+    m_lineSeries->setPointsVisible(prepared.points.size() < 2);
+    m_lineSeries->setColor(QColor(42, 130, 218));
+    m_chart->addSeries(m_lineSeries);
+
+    m_chart->setTitle(QString("%1 per %2").arg(m_lineSeries->name(), m_timeBucket));
+    m_chart->setTitleFont(QFont("Arial", 14, QFont::Bold));
+}
+
+double ChartWidget::wallClockToAxis(double utcMs)
+{
+    const QDateTime utc = QDateTime::fromMSecsSinceEpoch(qint64(utcMs), QTimeZone::utc());
+    return QDateTime(utc.date(), utc.time()).toMSecsSinceEpoch();
+}
+
+double ChartWidget::axisToWallClock(double axisMs)
+{
+    const QDateTime local = QDateTime::fromMSecsSinceEpoch(qint64(axisMs));
+    return QDateTime(local.date(), local.time(), QTimeZone::utc()).toMSecsSinceEpoch();
+}
+
+QString ChartWidget::timeAxisFormat(const QString &unit)
+{
+    if (unit == "second") return "HH:mm:ss";
+    if (unit == "minute" || unit == "hour") return "MM-dd HH:mm";
+    if (unit == "month") return "yyyy-MM";
+    if (unit == "year") return "yyyy";
+    return "yyyy-MM-dd";
+}
+
+int ChartWidget::lineSampleBuckets() const
+{
+    // The plot area is only known once the chart has been laid out
+    int width = qRound(m_chart->plotArea().width());
+    if (width <= 0) {
+        width = m_chartView->viewport()->width();
+    }
+    return qMax(100, width);
+}
+
+void ChartWidget::resampleLine(const ChartRequest &request, PreparedChart &prepared,
+                               BackgroundTask::Control &control)
+{
+    if (request.dbManager) {
+        auto chartData = ChartManager::prepareLineChartData(request.dbManager.get(), request.sourceQuery, request.xColumn,
+                                                            request.yColumn, request.lineBuckets, request.minX,
+                                                            request.maxX, interruptWhenCancelled(control));
+        if (!chartData.error.isEmpty()) {
+            prepared.message = chartData.error;
             return;
         }
+        for (int i = 0; i < chartData.xValues.size(); ++i) {
+            prepared.points.append(QPointF(chartData.xValues[i], chartData.yValues[i]));
+        }
+    } else {
+        // The visible range plus one point either side, so the line runs to the plot's edges
+        const QList<QPointF> &linePoints = request.linePoints;
+        auto byX = [](const QPointF &point, double x) {
+            return point.x() < x;
+        };
+        auto first = std::lower_bound(linePoints.cbegin(), linePoints.cend(), request.minX, byX);
+        auto last = std::lower_bound(first, linePoints.cend(), request.maxX, byX);
+        if (first != linePoints.cbegin()) {
+            --first;
+        }
+        if (last != linePoints.cend()) {
+            ++last;
+        }
+        prepared.points = ChartManager::downsampleLttb(QList<QPointF>(first, last), 2 * request.lineBuckets);
+    }
+}
 
-        ChartManager manager;
-        QString xColumn = m_xAxisCombo ? m_xAxisCombo->currentText() : QString();
-        QString yColumn = m_yAxisCombo ? m_yAxisCombo->currentText() : QString();
+void ChartWidget::resampleZoomed()
+{
+    const bool timeSeries = m_currentType == TimeSeriesChart && m_lineSeries && m_xDateTimeAxis;
+    const bool line = (m_currentType == LineChart && m_lineSeries && m_xValueAxis) || timeSeries;
+    const bool density = m_currentType == ScatterChart && m_density.points > 0 && m_xValueAxis;
+    if (!line && !density) {
+        return;
+    }
 
-        if (xColumn.isEmpty() || yColumn.isEmpty()) {
-            qWarning() << "createScatterChart: Empty column selection";
-            m_chart->setTitle("Select X and Y columns");
+    // Re-sampled off the GUI thread like a refresh; a newer zoom replaces a pending one
+    ChartRequest request = chartRequest();
+    if (timeSeries) {
+        request.minX = axisToWallClock(m_xDateTimeAxis->min().toMSecsSinceEpoch());
+        request.maxX = axisToWallClock(m_xDateTimeAxis->max().toMSecsSinceEpoch());
+    } else {
+        request.minX = m_xValueAxis->min();
+        request.maxX = m_xValueAxis->max();
+    }
+    if (!(line ? m_lineFromQuery : m_densityFromQuery)) {
+        request.dbManager = nullptr;
+    }
+    if (line && !timeSeries && !m_lineFromQuery) {
+        request.linePoints = m_linePoints;
+    }
+
+    // Applies a re-sampled line or density to the chart on screen
+    auto apply = [this, line, timeSeries](const PreparedChart &prepared) {
+        if (!prepared.message.isEmpty()) {
+            qWarning() << (line ? "resampleLine:" : "rebinDensity:") << prepared.message;
             return;
         }
+        if (timeSeries) {
+            // Finer buckets for the zoomed range, labelled to match
+            if (m_lineSeries) {
+                m_lineSeries->replace(prepared.points);
+                m_lineSeries->setPointsVisible(prepared.points.size() < 2);
+                m_timeBucket = prepared.chartData.timeBucket;
+                m_timeUnit = prepared.chartData.timeUnit;
+                m_chart->setTitle(QString("%1 per %2").arg(m_lineSeries->name(), m_timeBucket));
+            }
+            if (m_xDateTimeAxis) {
+                m_xDateTimeAxis->setFormat(timeAxisFormat(m_timeUnit));
+                m_xDateTimeAxis->setTitleText(QString("%1 (%2)").arg(m_xAxisCombo->currentText(), m_timeBucket));
+            }
+        } else if (line) {
+            if (m_lineSeries) {
+                m_lineSeries->replace(prepared.points);
+            }
+        } else {
+            // The grid carries its own y bounds; updateDensityImage() maps them onto the unchanged y axis
+            m_density = prepared.density;
+            m_densityImage = prepared.densityImage;
+            updateDensityImage();
+        }
+    };
+
+    disconnect(m_resampleTask, &BackgroundTask::finished, nullptr, nullptr);
+    const ChartDataCache::Key key = cacheKey(request);
+    PreparedChart cached;
+    if (m_dataCache && request.resultId != 0 && m_dataCache->find(key, &cached)) {
+        m_resampleTask->cancel();
+        apply(cached);
+        return;
+    }
 
-        auto chartData = manager.prepareScatterData(m_data, xColumn, yColumn);
+    auto prepared = std::make_shared<PreparedChart>();
+    connect(m_resampleTask, &BackgroundTask::finished, this, [this, request, key, prepared, apply](bool cancelled) {
+        if (cancelled) {
+            return;
+        }
+        if (m_dataCache && request.resultId != 0 && prepared->message.isEmpty()) {
+            m_dataCache->insert(key, *prepared);
+        }
+        apply(*prepared);
+    });
+    m_resampleTask->start([request, line, timeSeries, prepared](BackgroundTask::Control &control) {
+        if (timeSeries) {
+            prepareTimeSeries(request, *prepared, control);
+        } else if (line) {
+            resampleLine(request, *prepared, control);
+        } else {
+            rebinDensity(request, *prepared, control);
+        }
+    });
+}
+
+QSize ChartWidget::densityGridSize() const
+{
+    QSizeF area = m_chart->plotArea().size();
+    if (area.isEmpty()) {
+        area = m_chartView->viewport()->size();
+    }
+    return QSize(qMax(50, int(area.width()) / DENSITY_CELL_PIXELS),
+                 qMax(50, int(area.height()) / DENSITY_CELL_PIXELS));
+}
 
-        if (chartData.xValues.isEmpty() || chartData.yValues.isEmpty()) {
+void ChartWidget::rebinDensity(const ChartRequest &request, PreparedChart &prepared,
+                               BackgroundTask::Control &control)
+{
+    // Zooming bins the visible x range again, so cells stay a few pixels wide
+    const QSize cells = request.densityCells;
+    if (request.dbManager) {
+        prepared.density = ChartManager::prepareDensityGrid(request.dbManager.get(), request.sourceQuery, request.xColumn,
+                                                            request.yColumn, cells.width(), cells.height(),
+                                                            request.minX, request.maxX,
+                                                            interruptWhenCancelled(control));
+        if (!prepared.density.error.isEmpty()) {
+            prepared.message = prepared.density.error;
+            return;
+        }
+    } else {
+        auto chartData = ChartManager::prepareScatterData(loadedData(request), request.xColumn, request.yColumn);
+        prepared.density = ChartManager::binDensity(chartData.xValues, chartData.yValues, cells.width(),
+                                                    cells.height(), request.minX, request.maxX);
+    }
+    prepared.densityImage = renderDensity(prepared.density);
+}
+
+QImage ChartWidget::renderDensity(const ChartManager::DensityGrid &grid)
+{
+    QImage image(grid.columns, grid.rows, QImage::Format_ARGB32);
+    image.fill(Qt::transparent);
+    double maxCount = 0.0;
+    for (double count : grid.counts) {
+        maxCount = qMax(maxCount, count);
+    }
+    if (maxCount <= 0.0) {
+        return image;
+    }
+
+    // Log scale, so sparse cells stay visible next to dense ones; dark blue through yellow
+    const double scale = 1.0 / std::log1p(maxCount);
+    for (int row = 0; row < grid.rows; ++row) {
+        // Image rows run top-down, grid rows bottom-up
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(grid.rows - 1 - row));
+        const double *counts = grid.counts.constData() + row * grid.columns;
+        for (int column = 0; column < grid.columns; ++column) {
+            if (counts[column] <= 0.0) {
+                continue;
+            }
+            const double t = std::log1p(counts[column]) * scale;
+            line[column] = qRgb(int(68 + t * (253 - 68)), int(1 + t * (231 - 1)), int(84 + t * (37 - 84)));
+        }
+    }
+    return image;
+}
+
+void ChartWidget::updateDensityImage()
+{
+    if (m_densityImage.isNull() || !m_scatterSeries || !m_xValueAxis || !m_yValueAxis) {
+        m_densityItem->setVisible(false);
+        return;
+    }
+
+    // Place the grid's bounds in scene coordinates, clipped to the plot area
+    const QPointF topLeft = m_chart->mapToPosition(QPointF(m_density.minX, m_density.maxY), m_scatterSeries);
+    const QPointF bottomRight = m_chart->mapToPosition(QPointF(m_density.maxX, m_density.minY), m_scatterSeries);
+    const QRectF target = QRectF(topLeft, bottomRight).normalized();
+    const QRectF visible = target.intersected(m_chart->plotArea());
+    if (visible.isEmpty()) {
+        m_densityItem->setVisible(false);
+        return;
+    }
+
+    // Nearest-neighbour scaling keeps cell edges sharp
+    QPixmap pixmap = QPixmap::fromImage(m_densityImage.scaled(target.size().toSize(), Qt::IgnoreAspectRatio,
+                                                              Qt::FastTransformation));
+    const QRect source = visible.translated(-target.topLeft()).toRect();
+    m_densityItem->setPixmap(pixmap.copy(source));
+    m_densityItem->setPos(visible.topLeft());
+    m_densityItem->setVisible(true);
+}
+
+void ChartWidget::prepareScatterChart(const ChartRequest &request, PreparedChart &prepared,
+                                      BackgroundTask::Control &control)
+{
+    if (request.xColumn.isEmpty() || request.yColumn.isEmpty()) {
+        qWarning() << "createScatterChart: Empty column selection";
+        prepared.message = "Select X and Y columns";
+        return;
+    }
+
+    if (request.density) {
+        const QSize cells = request.densityCells;
+        if (request.dbManager && !request.sourceQuery.isEmpty()) {
+            // Binned by DuckDB over every row of the result
+            prepared.density = ChartManager::prepareDensityGrid(request.dbManager.get(), request.sourceQuery,
+                                                                request.xColumn, request.yColumn, cells.width(),
+                                                                cells.height(), qQNaN(), qQNaN(),
+                                                                interruptWhenCancelled(control));
+            prepared.fromQuery = prepared.density.error.isEmpty();
+            if (control.isCancelled()) {
+                return;
+            }
+            if (!prepared.fromQuery) {
+                qWarning() << "createScatterChart: Binning loaded rows instead:" << prepared.density.error;
+            }
+        }
+        if (!prepared.fromQuery) {
+            auto chartData = ChartManager::prepareScatterData(loadedData(request), request.xColumn, request.yColumn);
+            prepared.density = ChartManager::binDensity(chartData.xValues, chartData.yValues,
+                                                        cells.width(), cells.height());
+        }
+        if (prepared.density.points == 0) {
             qWarning() << "createScatterChart: No data to display";
-            m_chart->setTitle("No data to display");
+            prepared.message = "No data to display";
             return;
         }
+        prepared.densityImage = renderDensity(prepared.density);
+        return;
+    }
 
-        m_scatterSeries = new QScatterSeries();
-        m_scatterSeries->setName(QString("%1 vs %2").arg(yColumn).arg(xColumn));
+    auto chartData = ChartManager::prepareScatterData(loadedData(request), request.xColumn, request.yColumn);
+    if (chartData.xValues.isEmpty() || chartData.yValues.isEmpty()) {
+        qWarning() << "createScatterChart: No data to display";
+        prepared.message = "No data to display";
+        return;
+    }
 
-        for (int i = 0; i < chartData.xValues.size(); ++i) {
-            m_scatterSeries->append(chartData.xValues[i], chartData.yValues[i]);
+    prepared.points.reserve(chartData.xValues.size());
+    for (int i = 0; i < chartData.xValues.size(); ++i) {
+        prepared.points.append(QPointF(chartData.xValues[i], chartData.yValues[i]));
+    }
+}
+
+void ChartWidget::createScatterChart(const ChartRequest &request, const PreparedChart &prepared)
+{
+    try {
+        qDebug() << "createScatterChart: Starting";
+
+        if (!m_chart) {
+            qWarning() << "createScatterChart: m_chart is null";
+            return;
         }
 
+        if (request.density) {
+            m_density = prepared.density;
+            m_densityFromQuery = prepared.fromQuery;
+            m_densityImage = prepared.densityImage;
+
+            // An empty series carries the axes; the points are in the raster behind them
+            m_scatterSeries = new QScatterSeries();
+            m_scatterSeries->setName(QString("%1 points (density)").arg(QLocale().toString(m_density.points)));
+            m_scatterSeries->setColor(QColor(253, 231, 37));
+            m_chart->addSeries(m_scatterSeries);
+            m_chart->setTitle(QString("Density Plot: %1 vs %2").arg(request.yColumn).arg(request.xColumn));
+            m_chart->setTitleFont(QFont("Arial", 14, QFont::Bold));
+            return;
+        }
+
+        m_scatterSeries = new QScatterSeries();
+        m_scatterSeries->setName(QString("%1 vs %2").arg(request.yColumn).arg(request.xColumn));
+        m_scatterSeries->replace(prepared.points);
+
         m_scatterSeries->setColor(QColor(42, 130, 218));
         m_scatterSeries->setMarkerSize(8);
         m_chart->addSeries(m_scatterSeries);
-        QString title = QString("Scatter Plot: %1 vs %2").arg(yColumn).arg(xColumn);
+        QString title = QString("Scatter Plot: %1 vs %2").arg(request.yColumn).arg(request.xColumn);
         m_chart->setTitle(title);
         m_chart->setTitleFont(QFont("Arial", 14, QFont::Bold));
 
@@ -564,41 +1268,49 @@ void ChartWidget::createScatterChart()
     }
 }
 
-void ChartWidget::createPieChart()
+void ChartWidget::preparePieChart(const ChartRequest &request, PreparedChart &prepared,
+                                  BackgroundTask::Control &control)
 {
-    try {
-        qDebug() << "createPieChart: Starting";
-
-        if (!m_chart) {
-            qWarning() << "createPieChart: m_chart is null";
-            return;
-        }
+    if (request.xColumn.isEmpty()) {
+        qWarning() << "createPieChart: Empty label column";
+        prepared.message = "Select label column";
+        return;
+    }
 
-        ChartManager manager;
-        QString labelColumn = m_xAxisCombo ? m_xAxisCombo->currentText() : QString();
-        QString valueColumn = m_yAxisCombo ? m_yAxisCombo->currentText() : QString();
+    ChartManager::AggregationType agg = request.aggregation;
+    if (agg == ChartManager::NoAggregation) {
+        agg = ChartManager::Count;
+    }
 
-        if (labelColumn.isEmpty()) {
-            qWarning() << "createPieChart: Empty label column";
-            m_chart->setTitle("Select label column");
-            return;
+    ChartManager::ChartData &chartData = prepared.chartData;
+    if (request.dbManager && !request.sourceQuery.isEmpty()) {
+        chartData = ChartManager::preparePieChartData(request.dbManager.get(), request.sourceQuery, request.xColumn,
+                                                      request.yColumn, agg, interruptWhenCancelled(control));
+        if (!chartData.error.isEmpty() && !control.isCancelled()) {
+            qWarning() << "createPieChart: Aggregating loaded rows instead:" << chartData.error;
+            chartData = ChartManager::preparePieChartData(loadedData(request), request.xColumn, request.yColumn, agg);
         }
+    } else {
+        chartData = ChartManager::preparePieChartData(loadedData(request), request.xColumn, request.yColumn, agg);
+    }
 
-        ChartManager::AggregationType agg = m_aggregationCombo
-            ? static_cast<ChartManager::AggregationType>(m_aggregationCombo->currentIndex())
-            : ChartManager::Count;
-        if (agg == ChartManager::NoAggregation) {
-            agg = ChartManager::Count;
-        }
+    if (chartData.xLabels.isEmpty() || chartData.yValues.isEmpty()) {
+        qWarning() << "createPieChart: No data to display";
+        prepared.message = "No data to display";
+    }
+}
 
-        auto chartData = manager.preparePieChartData(m_data, labelColumn, valueColumn, agg);
+void ChartWidget::createPieChart(const ChartRequest &request, const PreparedChart &prepared)
+{
+    try {
+        qDebug() << "createPieChart: Starting";
 
-        if (chartData.xLabels.isEmpty() || chartData.yValues.isEmpty()) {
-            qWarning() << "createPieChart: No data to display";
-            m_chart->setTitle("No data to display");
+        if (!m_chart) {
+            qWarning() << "createPieChart: m_chart is null";
             return;
         }
 
+        const ChartManager::ChartData &chartData = prepared.chartData;
         m_pieSeries = new QPieSeries();
 
         for (int i = 0; i < chartData.xLabels.size(); ++i) {
@@ -606,12 +1318,15 @@ void ChartWidget::createPieChart()
         }
 
         m_chart->addSeries(m_pieSeries);
-        QString title = QString("%1 Distribution").arg(labelColumn);
+        QString title = QString("%1 Distribution").arg(request.xColumn);
         if (m_aggregationCombo && m_aggregationCombo->currentIndex() > 0) {
             title = QString("%1 Distribution by %2")
-                .arg(labelColumn)
+                .arg(request.xColumn)
                 .arg(m_aggregationCombo->currentText());
         }
+        if (chartData.truncated) {
+            title += QString(" (first %1 groups)").arg(ChartManager::MAX_CHART_GROUPS);
+        }
         m_chart->setTitle(title);
         m_chart->setTitleFont(QFont("Arial", 14, QFont::Bold));
 
@@ -638,35 +1353,48 @@ void ChartWidget::createPieChart()
     }
 }
 
-void ChartWidget::createHistogram()
+void ChartWidget::prepareHistogram(const ChartRequest &request, PreparedChart &prepared,
+                                   BackgroundTask::Control &control)
 {
-    try {
-        qDebug() << "createHistogram: Starting";
+    if (request.xColumn.isEmpty()) {
+        qWarning() << "createHistogram: Empty column selection";
+        prepared.message = "Select a column for histogram";
+        return;
+    }
 
-        if (!m_chart) {
-            qWarning() << "createHistogram: m_chart is null";
-            return;
+    qDebug() << "createHistogram: Preparing data for column" << request.xColumn << "with" << request.bins << "bins";
+    ChartManager::ChartData &chartData = prepared.chartData;
+    if (request.dbManager && !request.sourceQuery.isEmpty()) {
+        // Binned in DuckDB over the whole result
+        chartData = ChartManager::prepareHistogramData(request.dbManager.get(), request.sourceQuery, request.xColumn,
+                                                       request.bins, request.binning,
+                                                       interruptWhenCancelled(control));
+        prepared.fromQuery = chartData.error.isEmpty();
+        if (!prepared.fromQuery && !control.isCancelled()) {
+            qWarning() << "createHistogram: Binning loaded rows instead:" << chartData.error;
+            chartData = ChartManager::prepareHistogramData(loadedData(request), request.xColumn, request.bins);
         }
+    } else {
+        chartData = ChartManager::prepareHistogramData(loadedData(request), request.xColumn, request.bins);
+    }
 
-        ChartManager manager;
-        QString column = m_xAxisCombo ? m_xAxisCombo->currentText() : QString();
-        int bins = m_binsSpin ? m_binsSpin->value() : DEFAULT_HISTOGRAM_BINS;
-
-        if (column.isEmpty()) {
-            qWarning() << "createHistogram: Empty column selection";
-            m_chart->setTitle("Select a column for histogram");
-            return;
-        }
+    if (chartData.xLabels.isEmpty() || chartData.yValues.isEmpty()) {
+        qWarning() << "createHistogram: No data to display";
+        prepared.message = QString("No numeric data in column '%1'").arg(request.xColumn);
+    }
+}
 
-        qDebug() << "createHistogram: Preparing data for column" << column << "with" << bins << "bins";
-        auto chartData = manager.prepareHistogramData(m_data, column, bins);
+void ChartWidget::createHistogram(const ChartRequest &request, const PreparedChart &prepared)
+{
+    try {
+        qDebug() << "createHistogram: Starting";
 
-        if (chartData.xLabels.isEmpty() || chartData.yValues.isEmpty()) {
-            qWarning() << "createHistogram: No data to display";
-            m_chart->setTitle(QString("No numeric data in column '%1'").arg(column));
+        if (!m_chart) {
+            qWarning() << "createHistogram: m_chart is null";
             return;
         }
 
+        const ChartManager::ChartData &chartData = prepared.chartData;
         qDebug() << "createHistogram: Creating bar series with" << chartData.yValues.size() << "values";
         m_barSeries = new QBarSeries();
         QBarSet *set = new QBarSet("Frequency");
@@ -678,8 +1406,13 @@ void ChartWidget::createHistogram()
         set->setColor(QColor(42, 130, 218));
         m_barSeries->append(set);
         m_chart->addSeries(m_barSeries);
+        m_categoryLabels = chartData.xLabels;
 
-        QString title = QString("Histogram of %1 (%2 bins)").arg(column).arg(bins);
+        QString title = QString("Histogram of %1 (%2 bins)").arg(request.xColumn).arg(request.bins);
+        if (prepared.fromQuery && request.binning != ChartManager::EqualWidthBins) {
+            title = QString("Histogram of %1 (%2 %3 bins)").arg(request.xColumn).arg(request.bins)
+                        .arg(request.binning == ChartManager::LogScaleBins ? "log-scale" : "quantile");
+        }
         m_chart->setTitle(title);
         m_chart->setTitleFont(QFont("Arial", 14, QFont::Bold));
 
@@ -695,6 +1428,7 @@ void ChartWidget::createHistogram()
 
 void ChartWidget::clearChart()
 {
+    cancelPreparation();
     m_chart->removeAllSeries();
     m_chart->setTitle("No Data");
     m_statsLabel->setText("No data");
@@ -704,6 +1438,18 @@ void ChartWidget::clearChart()
     m_lineSeries = nullptr;
     m_scatterSeries = nullptr;
     m_pieSeries = nullptr;
+    m_density = ChartManager::DensityGrid();
+    m_densityImage = QImage();
+    m_densityItem->setVisible(false);
+}
+
+void ChartWidget::onDisplayOptionsChanged()
+{
+    // Only the styling changes; the series and the data behind them stay as they are
+    m_chart->legend()->setVisible(m_showLegendCheck->isChecked());
+    for (QAbstractAxis *axis : m_chart->axes()) {
+        axis->setGridLineVisible(m_showGridCheck->isChecked());
+    }
 }
 
 void ChartWidget::updateChartTheme()
@@ -766,24 +1512,47 @@ void ChartWidget::configureAxes()
         }
 
         // Create appropriate axes
-        if (m_currentType == BarChart || m_currentType == Histogram) {
+        if (m_currentType == TimeSeriesChart) {
+            m_xDateTimeAxis = new QDateTimeAxis();
+            m_yValueAxis = new QValueAxis();
+            m_chart->addAxis(m_xDateTimeAxis, Qt::AlignBottom);
+            m_chart->addAxis(m_yValueAxis, Qt::AlignLeft);
+            series->attachAxis(m_xDateTimeAxis);
+            series->attachAxis(m_yValueAxis);
+
+            const QList<QPointF> points = m_lineSeries ? m_lineSeries->points() : QList<QPointF>();
+            if (!points.isEmpty()) {
+                // Points are in bucket order; a lone bucket gets a day either side
+                qreal minX = points.first().x();
+                qreal maxX = points.last().x();
+                if (maxX <= minX) {
+                    minX -= 86400000.0;
+                    maxX += 86400000.0;
+                }
+                auto [minY, maxY] = std::minmax_element(points.cbegin(), points.cend(),
+                                                        [](const QPointF &a, const QPointF &b) {
+                                                            return a.y() < b.y();
+                                                        });
+                const qreal yPadding = (maxY->y() - minY->y()) * 0.1;
+                m_xDateTimeAxis->setRange(QDateTime::fromMSecsSinceEpoch(qint64(minX)),
+                                          QDateTime::fromMSecsSinceEpoch(qint64(maxX)));
+                m_yValueAxis->setRange(minY->y() - yPadding, maxY->y() + yPadding);
+            }
+            m_xDateTimeAxis->setFormat(timeAxisFormat(m_timeUnit));
+            m_xDateTimeAxis->setTickCount(qBound(2, lineSampleBuckets() / 120, 10));
+
+            // Connected once the initial range is set, so only zooming re-buckets
+            connect(m_xDateTimeAxis, &QDateTimeAxis::rangeChanged, m_resampleTimer, [this]() {
+                m_resampleTimer->start();
+            });
+        } else if (m_currentType == BarChart || m_currentType == Histogram) {
             qDebug() << "configureAxes: Creating category axes";
             m_xCategoryAxis = new QBarCategoryAxis();
             m_yValueAxis = new QValueAxis();
 
-            // Set category labels for bar chart
-            if (m_currentType == BarChart && m_xAxisCombo && m_yAxisCombo) {
-                try {
-                    ChartManager manager;
-                    QString xColumn = m_xAxisCombo->currentText();
-                    QString yColumn = m_yAxisCombo->currentText();
-                    auto chartData = manager.prepareBarChartData(m_data, xColumn, yColumn);
-                    if (!chartData.xLabels.isEmpty()) {
-                        m_xCategoryAxis->setCategories(chartData.xLabels);
-                    }
-                } catch (...) {
-                    qWarning() << "configureAxes: Failed to set category labels";
-                }
+            // Category labels of the bars just drawn: groups or histogram bins
+            if (!m_categoryLabels.isEmpty()) {
+                m_xCategoryAxis->setCategories(m_categoryLabels);
             }
 
             m_chart->addAxis(m_xCategoryAxis, Qt::AlignBottom);
@@ -827,7 +1596,11 @@ void ChartWidget::configureAxes()
             series->attachAxis(m_yValueAxis);
 
             // Auto-scale axes to include negative values
-            if (m_lineSeries || m_scatterSeries) {
+            if (m_density.points > 0) {
+                // A density chart spans the grid's bounds; its series holds no points
+                m_xValueAxis->setRange(m_density.minX, m_density.maxX);
+                m_yValueAxis->setRange(m_density.minY, m_density.maxY);
+            } else if (m_lineSeries || m_scatterSeries) {
                 qreal minX = 0, maxX = 0, minY = 0, maxY = 0;
                 bool hasData = false;
 
@@ -860,6 +1633,19 @@ void ChartWidget::configureAxes()
                     qDebug() << "Y axis range:" << minY - yPadding << "to" << maxY + yPadding;
                 }
             }
+
+            // Connected once the initial range is set, so only zooming re-samples the line
+            if (m_lineSeries || m_density.points > 0) {
+                connect(m_xValueAxis, &QValueAxis::rangeChanged, m_resampleTimer, [this]() {
+                    m_resampleTimer->start();
+                });
+            }
+            if (m_density.points > 0) {
+                // Move the current raster with the axes until the re-binned one replaces it
+                connect(m_xValueAxis, &QValueAxis::rangeChanged, this, &ChartWidget::updateDensityImage);
+                connect(m_yValueAxis, &QValueAxis::rangeChanged, this, &ChartWidget::updateDensityImage);
+                updateDensityImage();
+            }
         }
 
         // Style axes for dark theme with better labels
@@ -871,6 +1657,15 @@ void ChartWidget::configureAxes()
             m_xValueAxis->setLabelsFont(QFont("Arial", 10));
             m_xValueAxis->setTitleFont(QFont("Arial", 11, QFont::Bold));
         }
+        if (m_xDateTimeAxis) {
+            m_xDateTimeAxis->setLabelsColor(Qt::white);
+            m_xDateTimeAxis->setTitleText(QString("%1 (%2)").arg(m_xAxisCombo ? m_xAxisCombo->currentText() : "Time",
+                                                                  m_timeBucket));
+            m_xDateTimeAxis->setTitleBrush(QBrush(Qt::white));
+            m_xDateTimeAxis->setGridLineVisible(m_showGridCheck ? m_showGridCheck->isChecked() : true);
+            m_xDateTimeAxis->setLabelsFont(QFont("Arial", 10));
+            m_xDateTimeAxis->setTitleFont(QFont("Arial", 11, QFont::Bold));
+        }
         if (m_xCategoryAxis) {
             m_xCategoryAxis->setLabelsColor(Qt::white);
             m_xCategoryAxis->setTitleText(m_xAxisCombo ? m_xAxisCombo->currentText() : "X Axis");
@@ -0,0 +1,263 @@
+#include "clipboardcopier.h"
+#include "backgroundtask.h"
+#include "compressedresult.h"
+#include "duckdbmanager.h"
+#include "queryexporter.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QUuid>
+#include <QDebug>
+
+ClipboardCopier::ClipboardCopier(std::shared_ptr<DuckDBManager> dbManager, QObject *parent)
+    : QObject(parent)
+    , m_dbManager(std::move(dbManager))
+    , m_task(new BackgroundTask(this))
+{
+    connect(m_task, &BackgroundTask::progress, this, &ClipboardCopier::progress);
+    connect(m_task, &BackgroundTask::finished, this, [this](bool cancelled) {
+        Result result = m_result ? std::move(*m_result) : Result();
+        m_result.reset();
+        if (cancelled) {
+            result = Result();
+            result.cancelled = true;
+        }
+        emit finished(result);
+    });
+}
+
+ClipboardCopier::~ClipboardCopier()
+{
+    delete m_task;
+    m_task = nullptr;
+}
+
+qint64 ClipboardCopier::RowSelection::rowCount() const
+{
+    return compressed ? compressed->rowCount() : rows.size();
+}
+
+qint64 ClipboardCopier::RowSelection::selectedRowCount() const
+{
+    qint64 count = 0;
+    for (const auto &range : ranges) {
+        count += range.second - range.first + 1;
+    }
+    return count;
+}
+
+void ClipboardCopier::copyRows(const QStringList &columns, const RowSelection &selection)
+{
+    startRows(columns, selection, QString());
+}
+
+void ClipboardCopier::saveRows(const QStringList &columns, const RowSelection &selection, const QString &filePath)
+{
+    startRows(columns, selection, filePath);
+}
+
+void ClipboardCopier::startRows(const QStringList &columns, const RowSelection &selection, const QString &filePath)
+{
+    auto result = std::make_shared<Result>();
+    m_result = result;
+
+    m_task->start([columns, selection, filePath, result](BackgroundTask::Control &control) {
+        QElapsedTimer timer;
+        timer.start();
+        QElapsedTimer sinceReport;
+        sinceReport.start();
+
+        // Saving streams the text out in pieces; copying keeps it whole for the clipboard
+        QFile file(filePath);
+        if (!filePath.isEmpty() && !file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            result->error = QString("Failed to open %1: %2").arg(filePath, file.errorString());
+            return;
+        }
+        auto flush = [&file, result]() {
+            const QByteArray bytes = result->text.toUtf8();
+            result->bytes += bytes.size();
+            result->text.clear();
+            return file.write(bytes) == bytes.size();
+        };
+
+        QString &text = result->text;
+        for (int i = 0; i < columns.size(); ++i) {
+            if (i > 0) text += '\t';
+            appendField(text, columns[i]);
+        }
+        text += '\n';
+
+        const qint64 total = selection.selectedRowCount();
+        const qint64 rowCount = selection.rowCount();
+        // Consecutive rows usually share a page, so each page is decompressed once per run
+        int currentPage = -1;
+        QList<QVariantList> pageRows;
+
+        for (const auto &range : selection.ranges) {
+            for (qint64 viewRow = range.first; viewRow <= range.second; ++viewRow) {
+                if (control.isCancelled()) {
+                    return;
+                }
+
+                const qint64 resultRow = selection.reversed ? rowCount - 1 - viewRow : viewRow;
+                if (resultRow < 0 || resultRow >= rowCount) {
+                    continue;
+                }
+                QVariantList row;
+                if (selection.compressed) {
+                    int page = static_cast<int>(resultRow / CompressedResult::PAGE_ROWS);
+                    if (page != currentPage) {
+                        pageRows = selection.compressed->page(page);
+                        currentPage = page;
+                    }
+                    row = pageRows.value(static_cast<int>(resultRow % CompressedResult::PAGE_ROWS));
+                } else {
+                    row = selection.rows.at(resultRow);
+                }
+
+                const int cellCount = selection.columnIndexes.isEmpty() ? row.size() : selection.columnIndexes.size();
+                for (int i = 0; i < cellCount; ++i) {
+                    if (i > 0) text += '\t';
+                    const QVariant value = selection.columnIndexes.isEmpty() ? row.at(i)
+                                                                             : row.value(selection.columnIndexes.at(i));
+                    // Raw values, not the grid's display formatting, so nothing is truncated or rounded
+                    if (!value.isNull()) {
+                        appendField(text, value.toString());
+                    }
+                }
+                text += '\n';
+                ++result->rowsCopied;
+
+                if (file.isOpen()) {
+                    if (text.size() >= SAVE_FLUSH_CHARS && !flush()) {
+                        result->error = QString("Failed to write %1: %2").arg(filePath, file.errorString());
+                        return;
+                    }
+                } else if (qint64(text.size()) * 2 > MAX_CLIPBOARD_BYTES) {
+                    // QString holds UTF-16; the UTF-8 payload is usually smaller, so this is a safe upper bound
+                    result->exceededLimit = true;
+                    result->text.clear();
+                    result->elapsedMs = timer.elapsed();
+                    return;
+                }
+
+                if (sinceReport.elapsed() >= PROGRESS_INTERVAL_MS) {
+                    sinceReport.restart();
+                    control.reportProgress(100.0 * result->rowsCopied / total,
+                                           tr("Copied %1 of %2 rows").arg(result->rowsCopied).arg(total));
+                }
+            }
+        }
+
+        if (file.isOpen()) {
+            if (!flush()) {
+                result->error = QString("Failed to write %1: %2").arg(filePath, file.errorString());
+                return;
+            }
+            result->filePath = filePath;
+        } else {
+            result->bytes = text.toUtf8().size();
+        }
+        result->elapsedMs = timer.elapsed();
+        result->success = true;
+    });
+}
+
+void ClipboardCopier::copyQuery(const QString &query)
+{
+    auto result = std::make_shared<Result>();
+    m_result = result;
+
+    QueryExporter::Options options;
+    options.format = QueryExporter::TSV;
+    options.filePath = QDir::temp().filePath(QString("parquetsql_clipboard_%1.tsv")
+                                                 .arg(QUuid::createUuid().toString(QUuid::WithoutBraces)));
+    QString copyStatement = QueryExporter::buildCopyStatement(query, options);
+    QString tempPath = options.filePath;
+    std::shared_ptr<DuckDBManager> dbManager = m_dbManager;
+
+    m_task->start([dbManager, copyStatement, tempPath, result](BackgroundTask::Control &control) {
+        QElapsedTimer timer;
+        timer.start();
+        QElapsedTimer sinceReport;
+        sinceReport.start();
+
+        // Checked between every execution task rather than on the reporting interval, so a fast
+        // COPY stops within one task's output of the limit
+        DuckDBManager::QueryResult copyResult = dbManager->executeBackgroundQuery(copyStatement, [&](double percent) {
+            if (control.isCancelled()) {
+                return false;
+            }
+            qint64 written = QFileInfo(tempPath).size();
+            if (written > MAX_CLIPBOARD_BYTES) {
+                result->exceededLimit = true;
+                return false;
+            }
+            if (sinceReport.elapsed() >= PROGRESS_INTERVAL_MS) {
+                sinceReport.restart();
+                control.reportProgress(percent, tr("%1 buffered").arg(QueryExporter::formatBytes(written)));
+            }
+            return true;
+        });
+
+        QFile file(tempPath);
+        result->elapsedMs = timer.elapsed();
+
+        if (!copyResult.success) {
+            if (!result->exceededLimit) {
+                result->error = copyResult.error;
+            }
+            file.remove();
+            return;
+        }
+
+        if (file.size() > MAX_CLIPBOARD_BYTES) {
+            result->exceededLimit = true;
+            file.remove();
+            return;
+        }
+
+        if (!file.open(QIODevice::ReadOnly)) {
+            result->error = QString("Failed to read %1").arg(tempPath);
+            file.remove();
+            return;
+        }
+
+        QByteArray bytes = file.readAll();
+        file.close();
+        file.remove();
+
+        result->bytes = bytes.size();
+        result->text = QString::fromUtf8(bytes);
+        if (!copyResult.rows.isEmpty() && !copyResult.rows.first().isEmpty()) {
+            result->rowsCopied = copyResult.rows.first().first().toLongLong();
+        }
+        result->elapsedMs = timer.elapsed();
+        result->success = true;
+    });
+}
+
+void ClipboardCopier::cancel()
+{
+    m_task->cancel();
+}
+
+bool ClipboardCopier::isRunning() const
+{
+    return m_task->isRunning();
+}
+
+void ClipboardCopier::appendField(QString &out, const QString &value)
+{
+    // Quote like spreadsheets expect when a field would otherwise break the row/column structure
+    if (value.contains('\t') || value.contains('\n') || value.contains('\r') || value.contains('"')) {
+        QString quoted = value;
+        quoted.replace("\"", "\"\"");
+        out += '"';
+        out += quoted;
+        out += '"';
+    } else {
+        out += value;
+    }
+}
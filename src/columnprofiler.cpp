@@ -0,0 +1,342 @@
+#include "columnprofiler.h"
+#include "backgroundtask.h"
+#include "duckdbmanager.h"
+#include "resultfilter.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocale>
+#include <QStandardPaths>
+#include <QDebug>
+#include <cmath>
+
+QJsonObject ColumnProfiler::Profile::toJson() const
+{
+    QJsonArray columnArray;
+    for (const ColumnStats &stats : columns) {
+        QJsonObject column;
+        column["name"] = stats.name;
+        column["type"] = stats.type;
+        column["min"] = stats.min;
+        column["max"] = stats.max;
+        column["nullCount"] = stats.nullCount;
+        column["approxDistinct"] = stats.approxDistinct;
+        column["mean"] = stats.mean;
+        column["q25"] = stats.q25;
+        column["q50"] = stats.q50;
+        column["q75"] = stats.q75;
+        columnArray.append(column);
+    }
+
+    QJsonObject json;
+    json["filePath"] = filePath;
+    json["fingerprint"] = fingerprint;
+    json["rowCount"] = rowCount;
+    json["complete"] = complete;
+    json["columns"] = columnArray;
+    return json;
+}
+
+ColumnProfiler::Profile ColumnProfiler::Profile::fromJson(const QJsonObject &json)
+{
+    Profile profile;
+    profile.filePath = json["filePath"].toString();
+    profile.fingerprint = json["fingerprint"].toString();
+    profile.rowCount = json["rowCount"].toInteger(-1);
+    profile.complete = json["complete"].toBool();
+    for (const QJsonValue &value : json["columns"].toArray()) {
+        QJsonObject column = value.toObject();
+        ColumnStats stats;
+        stats.name = column["name"].toString();
+        stats.type = column["type"].toString();
+        stats.min = column["min"].toString();
+        stats.max = column["max"].toString();
+        stats.nullCount = column["nullCount"].toInteger(-1);
+        stats.approxDistinct = column["approxDistinct"].toInteger(-1);
+        stats.mean = column["mean"].toString();
+        stats.q25 = column["q25"].toString();
+        stats.q50 = column["q50"].toString();
+        stats.q75 = column["q75"].toString();
+        profile.columns.append(stats);
+    }
+    return profile;
+}
+
+ColumnProfiler::ColumnProfiler(std::shared_ptr<DuckDBManager> dbManager, QObject *parent)
+    : QObject(parent)
+    , m_dbManager(std::move(dbManager))
+    , m_task(new BackgroundTask(this))
+    , m_generation(0)
+{
+    connect(m_task, &BackgroundTask::progress, this, &ColumnProfiler::progress);
+    connect(m_task, &BackgroundTask::finished, this, [this](bool cancelled) {
+        Profile profile = m_result ? *m_result : Profile();
+        m_result.reset();
+        if (cancelled) {
+            profile.error = tr("Profiling cancelled");
+        }
+        m_profile = profile;
+        emit finished(profile);
+    });
+}
+
+ColumnProfiler::~ColumnProfiler()
+{
+    // Detach the run so a SUMMARIZE still going stops at its next progress check; it keeps its own
+    // reference to the database until then
+    delete m_task;
+    m_task = nullptr;
+}
+
+void ColumnProfiler::profileTable(const QString &filePath, const QString &tableName)
+{
+    ++m_generation;
+
+    Profile cached;
+    QString fingerprint = DuckDBManager::sourceFingerprint(filePath);
+    if (loadCached(fingerprint, cached)) {
+        m_profile = cached;
+        emit profileUpdated(cached);
+        emit finished(cached);
+        return;
+    }
+
+    auto result = std::make_shared<Profile>();
+    result->filePath = filePath;
+    result->fingerprint = fingerprint;
+    m_result = result;
+
+    std::shared_ptr<DuckDBManager> dbManager = m_dbManager;
+    const int generation = m_generation;
+    const bool isParquet = QFileInfo(filePath).suffix().compare("parquet", Qt::CaseInsensitive) == 0;
+
+    m_task->start([this, dbManager, tableName, isParquet, generation, result](BackgroundTask::Control &control) {
+        QElapsedTimer timer;
+        timer.start();
+
+        // Posted through the task, which is dropped with this profiler, so a late run never reaches it
+        auto publish = [this, &control, generation](const Profile &partial) {
+            control.post([this, generation, partial]() {
+                if (generation == m_generation) {
+                    m_profile = partial;
+                    emit profileUpdated(partial);
+                }
+            });
+        };
+
+        // Binding the table gives every column name and type without reading data
+        QStringList types;
+        QStringList names = dbManager->describeQuery(
+            QString("SELECT * FROM %1").arg(DuckDBManager::quoteIdentifier(tableName)), &types);
+        if (names.isEmpty()) {
+            result->error = tr("Could not read the columns of %1").arg(tableName);
+            return;
+        }
+        for (int i = 0; i < names.size(); ++i) {
+            ColumnStats stats;
+            stats.name = names[i];
+            stats.type = types.value(i);
+            result->columns.append(stats);
+        }
+
+        if (isParquet) {
+            control.reportProgress(0.0, tr("Reading Parquet statistics..."));
+            readFooterStatistics(dbManager.get(), *result);
+        }
+        result->elapsedMs = timer.elapsed();
+        publish(*result);
+
+        if (control.isCancelled()) {
+            return;
+        }
+
+        QElapsedTimer sinceReport;
+        sinceReport.start();
+        control.reportProgress(0.0, tr("Profiling columns..."));
+        bool ok = summarize(dbManager.get(), tableName, *result, [&](double percent) {
+            if (control.isCancelled()) {
+                return false;
+            }
+            if (sinceReport.elapsed() >= PROGRESS_INTERVAL_MS) {
+                sinceReport.restart();
+                control.reportProgress(percent, tr("Profiling columns... %1%").arg(qRound(percent)));
+            }
+            return true;
+        });
+        result->elapsedMs = timer.elapsed();
+        if (ok && !control.isCancelled()) {
+            result->complete = true;
+            saveCached(*result);
+        }
+    });
+}
+
+void ColumnProfiler::cancel()
+{
+    m_task->cancel();
+}
+
+bool ColumnProfiler::isRunning() const
+{
+    return m_task->isRunning();
+}
+
+void ColumnProfiler::readFooterStatistics(DuckDBManager *dbManager, Profile &profile)
+{
+    QString path = DuckDBManager::quoteLiteral(profile.filePath);
+
+    DuckDBManager::QueryResult rows = dbManager->executeBackgroundQuery(
+        QString("SELECT sum(num_rows) FROM parquet_file_metadata(%1)").arg(path));
+    if (rows.success && !rows.rows.isEmpty() && !rows.rows.first().isEmpty()) {
+        profile.rowCount = rows.rows.first().first().toLongLong();
+    }
+
+    // One row per leaf column, aggregated over row groups. Min/max come back as text, so
+    // numeric columns use the DOUBLE aggregates; ISO dates and times already order as text.
+    // A bound is only known when every row group recorded it.
+    DuckDBManager::QueryResult stats = dbManager->executeBackgroundQuery(QString(
+        "SELECT path_in_schema, min(stats_min_value), max(stats_max_value), "
+        "min(TRY_CAST(stats_min_value AS DOUBLE)), max(TRY_CAST(stats_max_value AS DOUBLE)), "
+        "count(stats_min_value) = count(*) AND count(stats_max_value) = count(*), "
+        "sum(stats_null_count), count(stats_null_count) = count(*) "
+        "FROM parquet_metadata(%1) GROUP BY path_in_schema").arg(path));
+    if (!stats.success) {
+        qWarning() << "Failed to read Parquet statistics:" << stats.error;
+        return;
+    }
+
+    for (const QVariantList &row : stats.rows) {
+        if (row.size() < 8) {
+            continue;
+        }
+        for (ColumnStats &column : profile.columns) {
+            if (column.name != row[0].toString()) {
+                continue;
+            }
+            if (row[5].toBool()) {
+                bool numeric = ResultFilter::isNumericType(column.type) && !row[3].isNull() && !row[4].isNull();
+                column.min = numeric ? QString::number(row[3].toDouble(), 'g', 15) : row[1].toString();
+                column.max = numeric ? QString::number(row[4].toDouble(), 'g', 15) : row[2].toString();
+            }
+            if (row[7].toBool() && !row[6].isNull()) {
+                column.nullCount = row[6].toLongLong();
+            }
+            break;
+        }
+    }
+}
+
+bool ColumnProfiler::summarize(DuckDBManager *dbManager, const QString &tableName, Profile &profile,
+                               const std::function<bool(double)> &progress)
+{
+    DuckDBManager::QueryResult result = dbManager->executeBackgroundQuery(
+        QString("SUMMARIZE SELECT * FROM %1").arg(DuckDBManager::quoteIdentifier(tableName)), progress);
+    if (!result.success) {
+        profile.error = result.error;
+        return false;
+    }
+
+    // column_name, column_type, min, max, approx_unique, avg, std, q25, q50, q75, count, null_percentage
+    for (const QVariantList &row : result.rows) {
+        if (row.size() < 12) {
+            continue;
+        }
+        for (ColumnStats &column : profile.columns) {
+            if (column.name != row[0].toString()) {
+                continue;
+            }
+            column.min = row[2].toString();
+            column.max = row[3].toString();
+            column.approxDistinct = row[4].isNull() ? -1 : row[4].toLongLong();
+            column.mean = row[5].toString();
+            column.q25 = row[7].toString();
+            column.q50 = row[8].toString();
+            column.q75 = row[9].toString();
+            qint64 count = row[10].toLongLong();
+            if (!row[11].isNull()) {
+                column.nullCount = std::llround(count * row[11].toDouble() / 100.0);
+            }
+            profile.rowCount = count;
+            break;
+        }
+    }
+    return true;
+}
+
+QString ColumnProfiler::tooltip(const ColumnStats &stats, qint64 rowCount)
+{
+    QLocale locale;
+    QStringList lines;
+    lines << QString("<b>%1</b> %2").arg(stats.name.toHtmlEscaped(), stats.type.toHtmlEscaped());
+    if (!stats.min.isEmpty() || !stats.max.isEmpty()) {
+        lines << tr("Min: %1").arg(stats.min.toHtmlEscaped());
+        lines << tr("Max: %1").arg(stats.max.toHtmlEscaped());
+    }
+    if (stats.nullCount >= 0) {
+        QString nulls = locale.toString(stats.nullCount);
+        if (rowCount > 0) {
+            nulls += QString(" (%1%)").arg(QString::number(100.0 * stats.nullCount / rowCount, 'f', 1));
+        }
+        lines << tr("Nulls: %1").arg(nulls);
+    }
+    if (stats.approxDistinct >= 0) {
+        lines << tr("Distinct: ~%1").arg(locale.toString(stats.approxDistinct));
+    }
+    if (!stats.mean.isEmpty()) {
+        lines << tr("Mean: %1").arg(stats.mean.toHtmlEscaped());
+    }
+    if (!stats.q50.isEmpty()) {
+        lines << tr("Quartiles: %1 / %2 / %3").arg(stats.q25.toHtmlEscaped(), stats.q50.toHtmlEscaped(),
+                                                    stats.q75.toHtmlEscaped());
+    }
+    return lines.join("<br>");
+}
+
+QString ColumnProfiler::cachePath(const QString &fingerprint)
+{
+    QString hash = QString::fromLatin1(QCryptographicHash::hash(fingerprint.toUtf8(), QCryptographicHash::Sha1).toHex());
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    return dir.filePath(QString("column_profiles/%1.json").arg(hash));
+}
+
+bool ColumnProfiler::loadCached(const QString &fingerprint, Profile &profile)
+{
+    QFile file(cachePath(fingerprint));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll());
+    if (!document.isObject()) {
+        return false;
+    }
+
+    Profile cached = Profile::fromJson(document.object());
+    // The hash names the file; the stored fingerprint guards against collisions
+    if (cached.fingerprint != fingerprint || !cached.complete) {
+        return false;
+    }
+    cached.fromCache = true;
+    profile = cached;
+    return true;
+}
+
+void ColumnProfiler::saveCached(const Profile &profile)
+{
+    QString path = cachePath(profile.fingerprint);
+    if (!QDir().mkpath(QFileInfo(path).absolutePath())) {
+        qWarning() << "Failed to create column profile cache directory for" << path;
+        return;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Failed to write column profile cache:" << path;
+        return;
+    }
+    file.write(QJsonDocument(profile.toJson()).toJson(QJsonDocument::Compact));
+}
@@ -0,0 +1,219 @@
+#include "compressedresult.h"
+#include "duckdbmanager.h"
+#include "backgroundtask.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QHash>
+#include <vector>
+
+std::shared_ptr<CompressedResult> CompressedResult::compress(const QList<QVariantList> &rows, int columnCount,
+                                                             const std::function<bool()> &isCancelled)
+{
+    std::shared_ptr<CompressedResult> compressed(new CompressedResult());
+    compressed->m_rowCount = rows.size();
+    compressed->m_columnCount = columnCount;
+    compressed->m_dictionaries.resize(columnCount);
+
+    // Short text values are dictionary-encoded per column: the dictionary stays uncompressed
+    // and the pages store codes, so decompressed cells share the dictionary's strings again
+    std::vector<QHash<QString, qint32>> codes(columnCount);
+
+    for (qint64 first = 0; first < rows.size(); first += PAGE_ROWS) {
+        if (isCancelled && isCancelled()) {
+            return nullptr;
+        }
+
+        const qint64 last = qMin<qint64>(first + PAGE_ROWS, rows.size());
+        QByteArray buffer;
+        QDataStream out(&buffer, QIODevice::WriteOnly);
+        for (int column = 0; column < columnCount; ++column) {
+            QStringList &dictionary = compressed->m_dictionaries[column];
+            QHash<QString, qint32> &columnCodes = codes[column];
+            for (qint64 row = first; row < last; ++row) {
+                const QVariantList &values = rows[row];
+                if (column >= values.size() || values[column].isNull()) {
+                    out << static_cast<quint8>(NullTag);
+                    continue;
+                }
+
+                const QVariant &value = values[column];
+                if (value.typeId() == QMetaType::QString) {
+                    const QString text = value.toString();
+                    QHash<QString, qint32>::const_iterator it = columnCodes.constFind(text);
+                    if (it == columnCodes.constEnd() && text.size() <= DuckDBManager::MAX_DICTIONARY_TEXT_BYTES &&
+                        columnCodes.size() < DuckDBManager::MAX_DICTIONARY_ENTRIES) {
+                        it = columnCodes.insert(text, static_cast<qint32>(dictionary.size()));
+                        dictionary.append(text);
+                        // Results share repeated text, so each distinct value is counted once
+                        compressed->m_rawBytes += estimateBytes(value);
+                    }
+                    if (it != columnCodes.constEnd()) {
+                        out << static_cast<quint8>(DictionaryTag) << it.value();
+                    } else {
+                        compressed->m_rawBytes += estimateBytes(value);
+                        out << static_cast<quint8>(StringTag) << text;
+                    }
+                    continue;
+                }
+                compressed->m_rawBytes += estimateBytes(value);
+                if (value.metaType() == QMetaType::fromType<DuckDBManager::TruncatedText>()) {
+                    const auto text = value.value<DuckDBManager::TruncatedText>();
+                    out << static_cast<quint8>(TruncatedTag) << text.prefix << text.fullBytes;
+                    continue;
+                }
+
+                switch (value.typeId()) {
+                case QMetaType::Bool:
+                    out << static_cast<quint8>(BoolTag) << value.toBool();
+                    break;
+                case QMetaType::Int:
+                    out << static_cast<quint8>(IntTag) << static_cast<qint32>(value.toInt());
+                    break;
+                case QMetaType::LongLong:
+                    out << static_cast<quint8>(LongLongTag) << value.toLongLong();
+                    break;
+                case QMetaType::Float:
+                    out << static_cast<quint8>(FloatTag) << value.toFloat();
+                    break;
+                case QMetaType::Double:
+                    out << static_cast<quint8>(DoubleTag) << value.toDouble();
+                    break;
+                default:
+                    out << static_cast<quint8>(VariantTag) << value;
+                    break;
+                }
+            }
+        }
+
+        QByteArray page = qCompress(buffer, COMPRESSION_LEVEL);
+        compressed->m_compressedBytes += page.size();
+        compressed->m_pages.append(page);
+    }
+
+    // Each row is a QVariantList of its own, holding one QVariant per cell
+    compressed->m_rawBytes += rows.size() * static_cast<qint64>(sizeof(QVariantList) + 16 + columnCount * sizeof(QVariant));
+    return compressed;
+}
+
+QList<QVariantList> CompressedResult::page(int index) const
+{
+    QList<QVariantList> rows;
+    if (index < 0 || index >= m_pages.size()) {
+        return rows;
+    }
+
+    const qint64 first = static_cast<qint64>(index) * PAGE_ROWS;
+    const int count = static_cast<int>(qMin<qint64>(PAGE_ROWS, m_rowCount - first));
+    rows.resize(count);
+    for (QVariantList &row : rows) {
+        row.resize(m_columnCount);
+    }
+
+    QByteArray buffer = qUncompress(m_pages[index]);
+    if (buffer.isEmpty() && count > 0) {
+        qWarning() << "Failed to decompress result page" << index;
+        return rows;
+    }
+
+    QDataStream in(buffer);
+    for (int column = 0; column < m_columnCount; ++column) {
+        const QStringList &dictionary = m_dictionaries[column];
+        for (int row = 0; row < count; ++row) {
+            quint8 tag = NullTag;
+            in >> tag;
+            QVariant &value = rows[row][column];
+            switch (tag) {
+            case BoolTag: {
+                bool b = false;
+                in >> b;
+                value = b;
+                break;
+            }
+            case IntTag: {
+                qint32 i = 0;
+                in >> i;
+                value = static_cast<int>(i);
+                break;
+            }
+            case LongLongTag: {
+                qint64 i = 0;
+                in >> i;
+                value = i;
+                break;
+            }
+            case FloatTag: {
+                float f = 0;
+                in >> f;
+                value = f;
+                break;
+            }
+            case DoubleTag: {
+                double d = 0;
+                in >> d;
+                value = d;
+                break;
+            }
+            case StringTag: {
+                QString s;
+                in >> s;
+                value = s;
+                break;
+            }
+            case DictionaryTag: {
+                qint32 code = 0;
+                in >> code;
+                value = dictionary.value(code);
+                break;
+            }
+            case TruncatedTag: {
+                DuckDBManager::TruncatedText text;
+                in >> text.prefix >> text.fullBytes;
+                value = QVariant::fromValue(text);
+                break;
+            }
+            case VariantTag:
+                in >> value;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << "Corrupt result page" << index;
+    }
+    return rows;
+}
+
+QList<QVariantList> CompressedResult::rows() const
+{
+    if (m_rows.isEmpty() && m_rowCount > 0) {
+        m_rows.reserve(m_rowCount);
+        for (int index = 0; index < m_pages.size(); ++index) {
+            m_rows.append(page(index));
+        }
+    }
+    return m_rows;
+}
+
+void CompressedResult::releaseRows()
+{
+    if (!m_rows.isEmpty()) {
+        BackgroundTask::release(std::make_shared<QList<QVariantList>>(std::move(m_rows)));
+    }
+    m_rows.clear();
+}
+
+qint64 CompressedResult::estimateBytes(const QVariant &value)
+{
+    // Heap memory beyond the cell's own QVariant: numbers are stored inline, strings add
+    // their UTF-16 block
+    if (value.typeId() == QMetaType::QString) {
+        return 24 + value.toString().size() * 2;
+    }
+    if (value.metaType() == QMetaType::fromType<DuckDBManager::TruncatedText>()) {
+        return 48 + value.value<DuckDBManager::TruncatedText>().prefix.size() * 2;
+    }
+    return 0;
+}
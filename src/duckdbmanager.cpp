@@ -4,6 +4,123 @@
 #include <QElapsedTimer>
 #include <QDir>
 #include <QRegularExpression>
+#include <QDateTime>
+#include <QThread>
+#include <QSettings>
+#include <QUuid>
+#include <QFile>
+#include <QHash>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// Repeated values of a text column share one implicitly shared QString, so each distinct
+// value is decoded and stored once per result and a cell costs no more than its QVariant.
+// Lookups go by the raw UTF-8 bytes; a column stops being pooled once it proves not to be
+// low-cardinality.
+struct ColumnDictionary {
+    bool active = false;
+    QHash<QByteArray, QString> values;
+};
+
+// One text cell: pooled while its column's dictionary is active, and held as a TruncatedText
+// preview when longer than maxTextChars (0 keeps it whole)
+QVariant textValue(const char *str, qint64 bytes, ColumnDictionary &dictionary, int maxTextChars,
+                   qint64 &truncatedValues)
+{
+    if (dictionary.active) {
+        if (bytes <= DuckDBManager::MAX_DICTIONARY_TEXT_BYTES) {
+            QHash<QByteArray, QString>::const_iterator it = dictionary.values.constFind(
+                QByteArray::fromRawData(str, static_cast<int>(bytes)));
+            if (it == dictionary.values.constEnd() &&
+                dictionary.values.size() < DuckDBManager::MAX_DICTIONARY_ENTRIES) {
+                it = dictionary.values.insert(QByteArray(str, static_cast<int>(bytes)), QString::fromUtf8(str, bytes));
+            }
+            if (it != dictionary.values.constEnd()) {
+                return it.value();
+            }
+        }
+        // Too many distinct values, or not a short label: the column is plain text.
+        // Cells already pooled stay valid; they are ordinary QStrings.
+        dictionary = ColumnDictionary();
+    }
+    if (maxTextChars > 0 && bytes > maxTextChars) {
+        // Decode just enough bytes for the preview (UTF-8 is at most 4 per character)
+        DuckDBManager::TruncatedText text;
+        text.prefix = QString::fromUtf8(str, qMin<qint64>(bytes, 4LL * maxTextChars));
+        text.fullBytes = bytes;
+        if (text.prefix.size() > maxTextChars) {
+            text.prefix.truncate(maxTextChars);
+            ++truncatedValues;
+            return QVariant::fromValue(text);
+        }
+    }
+    return QString::fromUtf8(str, bytes);
+}
+
+// Appends the rows of one streamed chunk. Result column i is read from chunk column
+// sourceColumns[i], of type types[i]; every one is a type the grid holds natively.
+void extractChunk(duckdb_data_chunk chunk, const std::vector<idx_t> &sourceColumns,
+                  const std::vector<duckdb_type> &types, std::vector<ColumnDictionary> &dictionaries,
+                  DuckDBManager::QueryResult &result)
+{
+    const size_t columnCount = sourceColumns.size();
+    std::vector<void*> data(columnCount);
+    std::vector<uint64_t*> validity(columnCount);
+    for (size_t col = 0; col < columnCount; col++) {
+        duckdb_vector vector = duckdb_data_chunk_get_vector(chunk, sourceColumns[col]);
+        data[col] = duckdb_vector_get_data(vector);
+        validity[col] = duckdb_vector_get_validity(vector);
+    }
+
+    const idx_t rowCount = duckdb_data_chunk_get_size(chunk);
+    for (idx_t row = 0; row < rowCount; row++) {
+        QVariantList rowData;
+        rowData.reserve(static_cast<qsizetype>(columnCount));
+        for (size_t col = 0; col < columnCount; col++) {
+            if (!duckdb_validity_row_is_valid(validity[col], row)) {
+                rowData.append(QVariant());
+                continue;
+            }
+            switch (types[col]) {
+                case DUCKDB_TYPE_BOOLEAN:
+                    rowData.append(static_cast<const bool*>(data[col])[row]);
+                    break;
+                case DUCKDB_TYPE_TINYINT:
+                    rowData.append(static_cast<int>(static_cast<const int8_t*>(data[col])[row]));
+                    break;
+                case DUCKDB_TYPE_SMALLINT:
+                    rowData.append(static_cast<int>(static_cast<const int16_t*>(data[col])[row]));
+                    break;
+                case DUCKDB_TYPE_INTEGER:
+                    rowData.append(static_cast<int>(static_cast<const int32_t*>(data[col])[row]));
+                    break;
+                case DUCKDB_TYPE_BIGINT:
+                    rowData.append(static_cast<qint64>(static_cast<const int64_t*>(data[col])[row]));
+                    break;
+                case DUCKDB_TYPE_FLOAT:
+                    rowData.append(static_cast<const float*>(data[col])[row]);
+                    break;
+                case DUCKDB_TYPE_DOUBLE:
+                    rowData.append(static_cast<const double*>(data[col])[row]);
+                    break;
+                case DUCKDB_TYPE_VARCHAR:
+                default: {
+                    duckdb_string_t value = static_cast<const duckdb_string_t*>(data[col])[row];
+                    const char* str = duckdb_string_is_inlined(value) ? value.value.inlined.inlined
+                                                                      : value.value.pointer.ptr;
+                    rowData.append(textValue(str, static_cast<qint64>(value.value.inlined.length),
+                                             dictionaries[col], 0, result.truncatedValues));
+                    break;
+                }
+            }
+        }
+        result.rows.append(rowData);
+    }
+}
+
+} // namespace
 
 DuckDBManager::DuckDBManager(QObject *parent)
     : QObject(parent)
@@ -12,6 +129,11 @@ DuckDBManager::DuckDBManager(QObject *parent)
     , m_connected(false)
     , m_isDiskBased(false)
 {
+    // Lets toString() and copy/export code treat a truncated cell as its preview text
+    static const bool truncatedTextConverter = QMetaType::registerConverter<TruncatedText, QString>(
+        [](const TruncatedText &text) { return text.prefix; });
+    Q_UNUSED(truncatedTextConverter);
+
     initialize();
 }
 
@@ -75,6 +197,10 @@ bool DuckDBManager::setupDatabase()
         duckdb_destroy_result(&result);
     }
     
+    {
+        std::lock_guard<std::mutex> interruptLock(m_interruptMutex);
+        m_interruptConnection = *m_connection;
+    }
     m_connected = true;
     m_lastError.clear();
     return true;
@@ -82,6 +208,11 @@ bool DuckDBManager::setupDatabase()
 
 void DuckDBManager::cleanup()
 {
+    {
+        std::lock_guard<std::mutex> interruptLock(m_interruptMutex);
+        m_interruptConnection = nullptr;
+    }
+
     if (m_connection) {
         duckdb_disconnect(m_connection);
         delete m_connection;
@@ -195,6 +326,15 @@ bool DuckDBManager::loadCSVFile(const QString &filePath)
     return true;
 }
 
+QString DuckDBManager::sourceFingerprint(const QString &filePath)
+{
+    QFileInfo info(filePath);
+    return QString("%1|%2|%3")
+        .arg(info.absoluteFilePath())
+        .arg(info.size())
+        .arg(info.lastModified().toMSecsSinceEpoch());
+}
+
 QString DuckDBManager::generateTableName(const QString &filePath)
 {
     QString baseName = QFileInfo(filePath).baseName();
@@ -226,6 +366,27 @@ DuckDBManager::QueryResult DuckDBManager::executeQuery(const QString &query)
         QElapsedTimer timer;
         timer.start();
 
+        duckdb_prepared_statement statement;
+        const duckdb_statement_type statementType =
+            duckdb_prepare(*m_connection, query.toUtf8().constData(), &statement) != DuckDBError
+                ? duckdb_prepared_statement_type(statement) : DUCKDB_STATEMENT_TYPE_INVALID;
+        // Anything that is not plainly a query (several statements included) may have changed the session
+        if (statementType != DUCKDB_STATEMENT_TYPE_SELECT && statementType != DUCKDB_STATEMENT_TYPE_EXPLAIN) {
+            m_sessionChanged.store(true);
+        }
+        duckdb_destroy_prepare(&statement);
+
+        SpillSettings settings = spillSettings();
+        QStringList columnNames;
+        QStringList columnTypes;
+        if (settings.enabled && statementType == DUCKDB_STATEMENT_TYPE_SELECT &&
+            describeColumns(query, columnNames, columnTypes)) {
+            result.success = streamQuery(query, columnNames, columnTypes, settings, result);
+            result.executionTimeMs = timer.elapsed();
+            return result;
+        }
+
+        // Not a plain SELECT (DDL, PRAGMA, several statements, ...), or spilling is off; run it as written
         duckdb_result duckResult;
         if (duckdb_query(*m_connection, query.toUtf8().constData(), &duckResult) == DuckDBError) {
             const char* errorMsg = duckdb_result_error(&duckResult);
@@ -237,108 +398,628 @@ DuckDBManager::QueryResult DuckDBManager::executeQuery(const QString &query)
 
         result.executionTimeMs = timer.elapsed();
 
-        idx_t columnCount = duckdb_column_count(&duckResult);
-        idx_t rowCount = duckdb_row_count(&duckResult);
+        bool extracted = extractResult(duckResult, result);
+        duckdb_destroy_result(&duckResult);
+        result.success = extracted;
+        return result;
+    } catch (const std::exception &e) {
+        result.error = QString("Exception in executeQuery: %1").arg(e.what());
+        qCritical() << "DuckDBManager::executeQuery exception:" << result.error;
+        return result;
+    } catch (...) {
+        result.error = "Unknown exception in executeQuery";
+        qCritical() << "DuckDBManager::executeQuery unknown exception";
+        return result;
+    }
+}
+
+bool DuckDBManager::describeColumns(const QString &query, QStringList &names, QStringList &types)
+{
+    // Bound on m_connection, so the session's temp tables, USE and open transaction all apply
+    const QString describe = QString("DESCRIBE SELECT * FROM %1;").arg(asSubquery(query));
+    duckdb_result described;
+    if (duckdb_query(*m_connection, describe.toUtf8().constData(), &described) == DuckDBError) {
+        duckdb_destroy_result(&described);
+        return false;
+    }
+
+    // One row per output column: column_name, column_type (in full, e.g. DECIMAL(18,3)), ...
+    idx_t rowCount = duckdb_row_count(&described);
+    for (idx_t row = 0; row < rowCount; row++) {
+        char* name = duckdb_value_varchar(&described, 0, row);
+        char* type = duckdb_value_varchar(&described, 1, row);
+        names.append(QString::fromUtf8(name ? name : ""));
+        types.append(QString::fromUtf8(type ? type : ""));
+        if (name) duckdb_free(name);
+        if (type) duckdb_free(type);
+    }
+    duckdb_destroy_result(&described);
+    return !names.isEmpty();
+}
 
-        result.totalRows = static_cast<int>(rowCount);
+bool DuckDBManager::inTransaction()
+{
+    // The C API has no call for a connection's transaction state; BEGIN fails only inside one
+    if (!runStatement("BEGIN TRANSACTION;")) {
+        return true;
+    }
+    runStatement("ROLLBACK;");
+    return false;
+}
 
-        // Extract column names
-        try {
-            for (idx_t col = 0; col < columnCount; col++) {
-                const char* colName = duckdb_column_name(&duckResult, col);
-                result.columnNames.append(QString::fromUtf8(colName ? colName : ""));
+bool DuckDBManager::streamQuery(const QString &query, const QStringList &columnNames, const QStringList &columnTypes,
+                                const SpillSettings &settings, QueryResult &result)
+{
+    const int columnCount = static_cast<int>(columnNames.size());
+    if (settings.columnThreshold > 0 && columnCount > settings.columnThreshold) {
+        // Wide results always go to disk with no preview; the grid then reads
+        // only the columns on screen instead of every column of every row
+        return spillQuery(*m_connection, query, settings, result, 0);
+    }
+
+    // The query runs exactly once. Columns the grid holds natively are read straight out of the
+    // chunks; every other column is streamed a second time cast to text, which is what the grid
+    // shows, while the original stays in the chunk so a spill keeps the exact type.
+    static const QStringList nativeTypes = {"BOOLEAN", "TINYINT", "SMALLINT", "INTEGER", "BIGINT",
+                                            "FLOAT", "DOUBLE", "VARCHAR"};
+    QStringList aliases;
+    QStringList definitions;  // Of the scratch table, should the result spill
+    for (int i = 0; i < columnCount; ++i) {
+        aliases.append(QString("c%1").arg(i));
+        definitions.append(QString("c%1 %2").arg(QString::number(i), columnTypes[i]));
+    }
+    QStringList selectList = aliases;
+    std::vector<idx_t> sourceColumns(columnCount);  // Chunk column each result column is read from
+    for (int i = 0; i < columnCount; ++i) {
+        sourceColumns[i] = static_cast<idx_t>(i);
+        if (!nativeTypes.contains(columnTypes[i])) {
+            sourceColumns[i] = static_cast<idx_t>(selectList.size());
+            selectList.append(QString("CAST(c%1 AS VARCHAR)").arg(i));
+            definitions.append(QString("t%1 VARCHAR").arg(i));
+        }
+    }
+    const QString streamed = QString("SELECT %1 FROM %2 AS __result(%3);")
+                                 .arg(selectList.join(", "), asSubquery(query), aliases.join(", "));
+
+    // Asked before the stream opens: no other statement may run on m_connection until it is closed
+    const bool canAppend = !inTransaction();
+
+    duckdb_prepared_statement statement;
+    if (duckdb_prepare(*m_connection, streamed.toUtf8().constData(), &statement) == DuckDBError) {
+        const char* errorMsg = duckdb_prepare_error(statement);
+        result.error = QString("Query error: %1").arg(errorMsg ? errorMsg : "Unknown error");
+        duckdb_destroy_prepare(&statement);
+        qWarning() << "DuckDB query failed:" << result.error;
+        return false;
+    }
+
+    duckdb_result stream;
+    bool ok = duckdb_execute_prepared_streaming(statement, &stream) != DuckDBError;
+    std::vector<duckdb_data_chunk> held;  // Fetched and not yet converted or stored
+    qint64 rowCount = 0;
+    bool overThreshold = false;
+    if (ok) {
+        while (duckdb_data_chunk chunk = duckdb_fetch_chunk(stream)) {
+            held.push_back(chunk);
+            rowCount += static_cast<qint64>(duckdb_data_chunk_get_size(chunk));
+            if (settings.rowThreshold > 0 && rowCount > settings.rowThreshold) {
+                overThreshold = true;
+                break;
             }
-        } catch (const std::exception &e) {
-            result.error = QString("Error extracting column names: %1").arg(e.what());
-            duckdb_destroy_result(&duckResult);
+        }
+    }
+
+    if (overThreshold && canAppend) {
+        ok = spillStream(stream, held, definitions, columnNames, settings, result);
+    } else if (!overThreshold && (!ok || duckdb_result_error(&stream))) {
+        // Failed to start, or stopped part way through (an error or an interrupt)
+        ok = false;
+        const char* errorMsg = duckdb_result_error(&stream);
+        result.error = QString("Query error: %1").arg(errorMsg ? errorMsg : "Unknown error");
+    } else if (!overThreshold) {
+        // Small enough to keep: the chunks already fetched are the whole result
+        std::vector<duckdb_type> types(columnCount);
+        std::vector<ColumnDictionary> dictionaries(columnCount);
+        for (int i = 0; i < columnCount; ++i) {
+            const duckdb_type type = duckdb_column_type(&stream, static_cast<idx_t>(i));
+            result.columnNames.append(columnNames[i]);
+            result.columnTypes.append(typeName(type));
+            types[i] = sourceColumns[i] == static_cast<idx_t>(i) ? type : DUCKDB_TYPE_VARCHAR;
+            dictionaries[i].active = type == DUCKDB_TYPE_VARCHAR || type == DUCKDB_TYPE_ENUM;
+        }
+        result.rows.reserve(rowCount);
+        for (duckdb_data_chunk &chunk : held) {
+            extractChunk(chunk, sourceColumns, types, dictionaries, result);
+            duckdb_destroy_data_chunk(&chunk);
+        }
+        held.clear();
+        result.totalRows = rowCount;
+        for (const ColumnDictionary &dictionary : dictionaries) {
+            if (dictionary.active) {
+                ++result.dictionaryColumns;
+            }
+        }
+    }
+
+    for (duckdb_data_chunk &chunk : held) {
+        duckdb_destroy_data_chunk(&chunk);
+    }
+    duckdb_destroy_result(&stream);
+    duckdb_destroy_prepare(&statement);
+
+    if (overThreshold && !canAppend) {
+        // Inside the user's transaction every statement stays on m_connection, so the rows
+        // fetched so far are dropped and COPY runs the query again straight into the spill file
+        return spillQuery(*m_connection, query, settings, result, SPILL_PREVIEW_ROWS);
+    }
+    if (!ok) {
+        qWarning() << "DuckDB query failed:" << result.error;
+    }
+    return ok;
+}
+
+bool DuckDBManager::spillStream(duckdb_result &stream, std::vector<duckdb_data_chunk> &held,
+                                const QStringList &definitions, const QStringList &columnNames,
+                                const SpillSettings &settings, QueryResult &result)
+{
+    // m_connection stays busy with the stream, so the rows go through a connection of their own into
+    // a TEMP table: private to that connection, and never in a database the user attached or USEd
+    duckdb_connection connection;
+    if (duckdb_connect(*m_database, &connection) == DuckDBError) {
+        result.error = "Failed to open a connection for the result";
+        return false;
+    }
+
+    const QString scratchTable = QString("__result_%1").arg(QUuid::createUuid().toString(QUuid::Id128));
+    const QString create = QString("CREATE TEMP TABLE %1 (%2);").arg(quoteIdentifier(scratchTable), definitions.join(", "));
+    duckdb_result created;
+    bool ok = duckdb_query(connection, create.toUtf8().constData(), &created) != DuckDBError;
+    if (!ok) {
+        const char* errorMsg = duckdb_result_error(&created);
+        result.error = QString("Failed to store result: %1").arg(errorMsg ? errorMsg : "Unknown error");
+    }
+    duckdb_destroy_result(&created);
+
+    duckdb_appender appender = nullptr;
+    if (ok && duckdb_appender_create(connection, nullptr, scratchTable.toUtf8().constData(), &appender) == DuckDBError) {
+        ok = false;
+    }
+
+    // The chunks fetched before the threshold was crossed go first, then the rest of the stream
+    auto append = [&](duckdb_data_chunk chunk) {
+        if (ok && duckdb_append_data_chunk(appender, chunk) == DuckDBError) {
+            ok = false;
+        }
+        duckdb_destroy_data_chunk(&chunk);
+    };
+    for (duckdb_data_chunk chunk : held) {
+        append(chunk);
+    }
+    held.clear();
+    while (ok) {
+        duckdb_data_chunk chunk = duckdb_fetch_chunk(stream);
+        if (!chunk) {
+            break;
+        }
+        append(chunk);
+    }
+
+    if (appender) {
+        if (!ok && result.error.isEmpty()) {
+            const char* errorMsg = duckdb_appender_error(appender);
+            result.error = QString("Failed to store result: %1").arg(errorMsg ? errorMsg : "Unknown error");
+        }
+        // Destroying the appender flushes what is still buffered
+        if (duckdb_appender_destroy(&appender) == DuckDBError && ok) {
+            ok = false;
+            result.error = "Failed to store result";
+        }
+    } else if (ok || result.error.isEmpty()) {
+        ok = false;
+        result.error = "Failed to store result";
+    }
+    if (ok && duckdb_result_error(&stream)) {
+        // Stopped part way through (an error or an interrupt)
+        ok = false;
+        result.error = QString("Query error: %1").arg(duckdb_result_error(&stream));
+    }
+
+    if (ok) {
+        QStringList columns;
+        for (int i = 0; i < columnNames.size(); ++i) {
+            columns.append(QString("c%1 AS %2").arg(QString::number(i), quoteIdentifier(columnNames[i])));
+        }
+        // rowid follows append order, which is the order the query produced the rows in
+        const QString stored = QString("SELECT %1 FROM %2 ORDER BY rowid")
+                                   .arg(columns.join(", "), quoteIdentifier(scratchTable));
+        {
+            std::lock_guard<std::mutex> interruptLock(m_interruptMutex);
+            m_interruptConnection = connection;
+        }
+        ok = spillQuery(connection, stored, settings, result, SPILL_PREVIEW_ROWS);
+        {
+            std::lock_guard<std::mutex> interruptLock(m_interruptMutex);
+            m_interruptConnection = *m_connection;
+        }
+    }
+
+    // The TEMP table goes with its connection
+    duckdb_disconnect(&connection);
+    return ok;
+}
+
+bool DuckDBManager::spillQuery(duckdb_connection connection, const QString &query, const SpillSettings &settings,
+                               QueryResult &result, qint64 previewRows)
+{
+    if (!QDir().mkpath(settings.scratchDirectory)) {
+        result.error = QString("Cannot create scratch directory %1").arg(settings.scratchDirectory);
+        return false;
+    }
+
+    auto spill = std::make_shared<SpillFile>();
+    spill->path = QDir(settings.scratchDirectory).filePath(
+        QString("spill_%1.parquet").arg(QUuid::createUuid().toString(QUuid::WithoutBraces)));
+
+    // Small row groups let page reads skip straight to the rows they need
+    QString copy = QString("COPY %1 TO %2 (FORMAT parquet, ROW_GROUP_SIZE %3);")
+                       .arg(asSubquery(query), quoteLiteral(spill->path), QString::number(SPILL_ROW_GROUP_SIZE));
+    duckdb_result duckResult;
+    if (duckdb_query(connection, copy.toUtf8().constData(), &duckResult) == DuckDBError) {
+        const char* errorMsg = duckdb_result_error(&duckResult);
+        result.error = QString("Failed to spill result: %1").arg(errorMsg ? errorMsg : "Unknown error");
+        duckdb_destroy_result(&duckResult);
+        return false;
+    }
+    spill->rowCount = duckdb_value_int64(&duckResult, 0, 0);
+    spill->sizeBytes = QFileInfo(spill->path).size();
+    duckdb_destroy_result(&duckResult);
+
+    // Keep the first page in memory so the grid and charts have something to show immediately;
+    // with no preview rows this still returns the column names
+    QString preview = spillReadQuery(*spill, 0, previewRows);
+    if (duckdb_query(connection, preview.toUtf8().constData(), &duckResult) == DuckDBError) {
+        const char* errorMsg = duckdb_result_error(&duckResult);
+        result.error = QString("Failed to read spilled result: %1").arg(errorMsg ? errorMsg : "Unknown error");
+        duckdb_destroy_result(&duckResult);
+        return false;
+    }
+    bool extracted = extractResult(duckResult, result, MAX_CELL_PREVIEW_CHARS);
+    duckdb_destroy_result(&duckResult);
+    if (!extracted) {
+        return false;
+    }
+
+    result.totalRows = spill->rowCount;
+    result.spill = spill;
+    return true;
+}
+
+DuckDBManager::QueryResult DuckDBManager::readSpillRows(const SpillFile &spill, qint64 offset, qint64 count,
+                                                        const QStringList &columns, int maxTextChars)
+{
+    QueryResult result = executeBackgroundQuery(spillReadQuery(spill, offset, count, columns),
+                                                ProgressCallback(), maxTextChars);
+    result.totalRows = spill.rowCount;
+    return result;
+}
+
+DuckDBManager::QueryResult DuckDBManager::snapshotQuery(const QString &query)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    QueryResult result;
+    try {
+        if (!m_connected) {
+            result.error = "Database not connected";
             return result;
-        } catch (...) {
-            result.error = "Unknown error extracting column names";
-            duckdb_destroy_result(&duckResult);
+        }
+        // Running the query again only reproduces the result while the session is as it was loaded
+        if (m_sessionChanged.load()) {
+            result.error = "The session has changed since the file was loaded";
             return result;
         }
 
-        // Extract row data
-        try {
-            for (idx_t row = 0; row < rowCount; row++) {
-                QVariantList rowData;
-                for (idx_t col = 0; col < columnCount; col++) {
-                    try {
-                        if (duckdb_value_is_null(&duckResult, col, row)) {
-                            rowData.append(QVariant());
-                        } else {
-                            switch (duckdb_column_type(&duckResult, col)) {
-                                case DUCKDB_TYPE_BOOLEAN:
-                                    rowData.append(duckdb_value_boolean(&duckResult, col, row));
-                                    break;
-                                case DUCKDB_TYPE_TINYINT:
-                                    rowData.append(duckdb_value_int8(&duckResult, col, row));
-                                    break;
-                                case DUCKDB_TYPE_SMALLINT:
-                                    rowData.append(duckdb_value_int16(&duckResult, col, row));
-                                    break;
-                                case DUCKDB_TYPE_INTEGER:
-                                    rowData.append(duckdb_value_int32(&duckResult, col, row));
-                                    break;
-                                case DUCKDB_TYPE_BIGINT:
-                                    rowData.append(static_cast<qint64>(duckdb_value_int64(&duckResult, col, row)));
-                                    break;
-                                case DUCKDB_TYPE_FLOAT:
-                                    rowData.append(duckdb_value_float(&duckResult, col, row));
-                                    break;
-                                case DUCKDB_TYPE_DOUBLE:
-                                    rowData.append(duckdb_value_double(&duckResult, col, row));
-                                    break;
-                                case DUCKDB_TYPE_VARCHAR:
-                                default: {
-                                    char* str = duckdb_value_varchar(&duckResult, col, row);
-                                    rowData.append(QString::fromUtf8(str ? str : ""));
-                                    if (str) duckdb_free(str);
-                                    break;
-                                }
-                            }
-                        }
-                    } catch (const std::exception &e) {
-                        qWarning() << "Error extracting cell value at row" << row << "col" << col << ":" << e.what();
-                        rowData.append(QVariant(QString("[Error: %1]").arg(e.what())));
-                    } catch (...) {
-                        qWarning() << "Unknown error extracting cell value at row" << row << "col" << col;
-                        rowData.append(QVariant("[Error: Unknown]"));
-                    }
-                }
-                result.rows.append(rowData);
-            }
-        } catch (const std::exception &e) {
-            result.error = QString("Error extracting row data: %1").arg(e.what());
-            duckdb_destroy_result(&duckResult);
+        QElapsedTimer timer;
+        timer.start();
+
+        // COPY writes every column with its own type, so the snapshot reads back exactly as the query returned it
+        result.success = spillQuery(*m_connection, query, spillSettings(), result, 0);
+        result.executionTimeMs = timer.elapsed();
+    } catch (const std::exception &e) {
+        result.success = false;
+        result.error = QString("Exception in snapshotQuery: %1").arg(e.what());
+        qCritical() << "DuckDBManager::snapshotQuery exception:" << result.error;
+    }
+    return result;
+}
+
+QString DuckDBManager::spillReadQuery(const SpillFile &spill, qint64 offset, qint64 count,
+                                      const QStringList &columns)
+{
+    // file_row_number is the row's position in the file; filtering on it prunes whole row groups,
+    // and Parquet only reads the column chunks the select list names
+    return QString("SELECT %1 FROM read_parquet(%2, file_row_number = true) "
+                   "WHERE file_row_number >= %3 AND file_row_number < %4 ORDER BY file_row_number;")
+        .arg(columns.isEmpty() ? QString("* EXCLUDE (file_row_number)") : columns.join(", "),
+             quoteLiteral(spill.path), QString::number(offset), QString::number(offset + count));
+}
+
+QString DuckDBManager::spillScanQuery(const SpillFile &spill, bool descending)
+{
+    return QString("SELECT * EXCLUDE (file_row_number) FROM read_parquet(%1, file_row_number = true) "
+                   "ORDER BY file_row_number%2")
+        .arg(quoteLiteral(spill.path), descending ? QString(" DESC") : QString());
+}
+
+QString DuckDBManager::spillRangesQuery(const SpillFile &spill, const QList<QPair<qint64, qint64>> &ranges,
+                                        bool descending, const QStringList &columns)
+{
+    QString projection = "* EXCLUDE (file_row_number)";
+    if (!columns.isEmpty()) {
+        QStringList quoted;
+        for (const QString &column : columns) {
+            quoted.append(quoteIdentifier(column));
+        }
+        projection = quoted.join(", ");
+    }
+
+    QStringList conditions;
+    for (const auto &range : ranges) {
+        conditions.append(QString("file_row_number BETWEEN %1 AND %2")
+                              .arg(QString::number(range.first), QString::number(range.second)));
+    }
+
+    return QString("SELECT %1 FROM read_parquet(%2, file_row_number = true) "
+                   "WHERE %3 ORDER BY file_row_number%4")
+        .arg(projection, quoteLiteral(spill.path),
+             conditions.isEmpty() ? QString("false") : conditions.join(" OR "),
+             descending ? QString(" DESC") : QString());
+}
+
+DuckDBManager::SpillFile::~SpillFile()
+{
+    if (!path.isEmpty() && QFile::exists(path) && !QFile::remove(path)) {
+        qWarning() << "Failed to remove spill file" << path;
+    }
+}
+
+DuckDBManager::SpillSettings DuckDBManager::spillSettings()
+{
+    QSettings settings;
+    SpillSettings spill;
+    spill.enabled = settings.value("spill/enabled", spill.enabled).toBool();
+    spill.rowThreshold = settings.value("spill/rowThreshold", spill.rowThreshold).toLongLong();
+    spill.columnThreshold = settings.value("spill/columnThreshold", spill.columnThreshold).toInt();
+    spill.scratchDirectory = settings.value("spill/scratchDirectory",
+                                            QDir::temp().filePath("parquetsql_spill")).toString();
+    return spill;
+}
+
+void DuckDBManager::setSpillSettings(const SpillSettings &spill)
+{
+    QSettings settings;
+    settings.setValue("spill/enabled", spill.enabled);
+    settings.setValue("spill/rowThreshold", spill.rowThreshold);
+    settings.setValue("spill/columnThreshold", spill.columnThreshold);
+    settings.setValue("spill/scratchDirectory", spill.scratchDirectory);
+}
+
+DuckDBManager::QueryResult DuckDBManager::executeBackgroundQuery(const QString &query, const ProgressCallback &progress,
+                                                                 int maxTextChars)
+{
+    QueryResult result;
+    result.success = false;
+
+    try {
+        if (!m_connected || !m_database) {
+            result.error = "Database not connected";
             return result;
-        } catch (...) {
-            result.error = "Unknown error extracting row data";
-            duckdb_destroy_result(&duckResult);
+        }
+
+        if (query.trimmed().isEmpty()) {
+            result.error = "Query is empty";
             return result;
         }
 
-        duckdb_destroy_result(&duckResult);
-        result.success = true;
+        duckdb_connection connection;
+        if (duckdb_connect(*m_database, &connection) == DuckDBError) {
+            result.error = "Failed to open background connection";
+            return result;
+        }
+
+        // Progress tracking is off by default; keep it quiet so nothing is printed to stdout
+        const char* settings[] = {
+            "SET enable_progress_bar = true;",
+            "SET enable_progress_bar_print = false;"
+        };
+        for (const char* sql : settings) {
+            duckdb_result settingResult;
+            duckdb_query(connection, sql, &settingResult);
+            duckdb_destroy_result(&settingResult);
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+
+        duckdb_result duckResult;
+        if (executePending(connection, query, progress, &duckResult, &result.error)) {
+            result.executionTimeMs = timer.elapsed();
+            result.success = extractResult(duckResult, result, maxTextChars);
+            duckdb_destroy_result(&duckResult);
+        }
+
+        duckdb_disconnect(&connection);
         return result;
     } catch (const std::exception &e) {
-        result.error = QString("Exception in executeQuery: %1").arg(e.what());
-        qCritical() << "DuckDBManager::executeQuery exception:" << result.error;
+        result.error = QString("Exception in executeBackgroundQuery: %1").arg(e.what());
+        qCritical() << "DuckDBManager::executeBackgroundQuery exception:" << result.error;
         return result;
     } catch (...) {
-        result.error = "Unknown exception in executeQuery";
-        qCritical() << "DuckDBManager::executeQuery unknown exception";
+        result.error = "Unknown exception in executeBackgroundQuery";
+        qCritical() << "DuckDBManager::executeBackgroundQuery unknown exception";
         return result;
     }
 }
 
+bool DuckDBManager::executePending(duckdb_connection connection, const QString &query,
+                                   const ProgressCallback &progress, duckdb_result *out, QString *error)
+{
+    duckdb_prepared_statement statement;
+    if (duckdb_prepare(connection, query.toUtf8().constData(), &statement) == DuckDBError) {
+        const char* errorMsg = duckdb_prepare_error(statement);
+        *error = QString("Query error: %1").arg(errorMsg ? errorMsg : "Unknown error");
+        duckdb_destroy_prepare(&statement);
+        return false;
+    }
+
+    duckdb_pending_result pending;
+    if (duckdb_pending_prepared(statement, &pending) == DuckDBError) {
+        const char* errorMsg = duckdb_pending_error(pending);
+        *error = QString("Query error: %1").arg(errorMsg ? errorMsg : "Unknown error");
+        duckdb_destroy_pending(&pending);
+        duckdb_destroy_prepare(&statement);
+        return false;
+    }
+
+    // Drive execution from this thread so cancellation is checked between tasks
+    bool cancelled = false;
+    for (;;) {
+        duckdb_pending_state state = duckdb_pending_execute_task(pending);
+        if (state == DUCKDB_PENDING_RESULT_READY || state == DUCKDB_PENDING_ERROR) {
+            break;
+        }
+        if (progress && !progress(duckdb_query_progress(connection).percentage)) {
+            cancelled = true;
+            break;
+        }
+        if (state == DUCKDB_PENDING_NO_TASKS_AVAILABLE) {
+            QThread::msleep(1);
+        }
+    }
+
+    if (cancelled) {
+        *error = "Query cancelled";
+        duckdb_destroy_pending(&pending);
+        duckdb_destroy_prepare(&statement);
+        return false;
+    }
+
+    bool ok = duckdb_execute_pending(pending, out) != DuckDBError;
+    if (!ok) {
+        const char* errorMsg = duckdb_result_error(out);
+        *error = QString("Query error: %1").arg(errorMsg ? errorMsg : "Unknown error");
+        duckdb_destroy_result(out);
+    }
+
+    duckdb_destroy_pending(&pending);
+    duckdb_destroy_prepare(&statement);
+    return ok;
+}
+
+bool DuckDBManager::extractResult(duckdb_result &duckResult, QueryResult &result, int maxTextChars)
+{
+    idx_t columnCount = duckdb_column_count(&duckResult);
+    idx_t rowCount = duckdb_row_count(&duckResult);
+
+    result.totalRows = static_cast<qint64>(rowCount);
+
+    // Extract column names
+    try {
+        for (idx_t col = 0; col < columnCount; col++) {
+            const char* colName = duckdb_column_name(&duckResult, col);
+            result.columnNames.append(QString::fromUtf8(colName ? colName : ""));
+            result.columnTypes.append(typeName(duckdb_column_type(&duckResult, col)));
+        }
+    } catch (const std::exception &e) {
+        result.error = QString("Error extracting column names: %1").arg(e.what());
+        return false;
+    } catch (...) {
+        result.error = "Unknown error extracting column names";
+        return false;
+    }
+
+    std::vector<ColumnDictionary> dictionaries(columnCount);
+    for (idx_t col = 0; col < columnCount; col++) {
+        duckdb_type type = duckdb_column_type(&duckResult, col);
+        dictionaries[col].active = type == DUCKDB_TYPE_VARCHAR || type == DUCKDB_TYPE_ENUM;
+    }
+
+    // Extract row data
+    try {
+        for (idx_t row = 0; row < rowCount; row++) {
+            QVariantList rowData;
+            for (idx_t col = 0; col < columnCount; col++) {
+                try {
+                    if (duckdb_value_is_null(&duckResult, col, row)) {
+                        rowData.append(QVariant());
+                    } else {
+                        switch (duckdb_column_type(&duckResult, col)) {
+                            case DUCKDB_TYPE_BOOLEAN:
+                                rowData.append(duckdb_value_boolean(&duckResult, col, row));
+                                break;
+                            case DUCKDB_TYPE_TINYINT:
+                                rowData.append(duckdb_value_int8(&duckResult, col, row));
+                                break;
+                            case DUCKDB_TYPE_SMALLINT:
+                                rowData.append(duckdb_value_int16(&duckResult, col, row));
+                                break;
+                            case DUCKDB_TYPE_INTEGER:
+                                rowData.append(duckdb_value_int32(&duckResult, col, row));
+                                break;
+                            case DUCKDB_TYPE_BIGINT:
+                                rowData.append(static_cast<qint64>(duckdb_value_int64(&duckResult, col, row)));
+                                break;
+                            case DUCKDB_TYPE_FLOAT:
+                                rowData.append(duckdb_value_float(&duckResult, col, row));
+                                break;
+                            case DUCKDB_TYPE_DOUBLE:
+                                rowData.append(duckdb_value_double(&duckResult, col, row));
+                                break;
+                            case DUCKDB_TYPE_VARCHAR:
+                            default: {
+                                char* str = duckdb_value_varchar(&duckResult, col, row);
+                                qint64 bytes = str ? static_cast<qint64>(std::strlen(str)) : 0;
+                                rowData.append(textValue(str ? str : "", bytes, dictionaries[col], maxTextChars,
+                                                         result.truncatedValues));
+                                if (str) duckdb_free(str);
+                                break;
+                            }
+                        }
+                    }
+                } catch (const std::exception &e) {
+                    qWarning() << "Error extracting cell value at row" << row << "col" << col << ":" << e.what();
+                    rowData.append(QVariant(QString("[Error: %1]").arg(e.what())));
+                } catch (...) {
+                    qWarning() << "Unknown error extracting cell value at row" << row << "col" << col;
+                    rowData.append(QVariant("[Error: Unknown]"));
+                }
+            }
+            result.rows.append(rowData);
+        }
+    } catch (const std::exception &e) {
+        result.error = QString("Error extracting row data: %1").arg(e.what());
+        return false;
+    } catch (...) {
+        result.error = "Unknown error extracting row data";
+        return false;
+    }
+
+    for (const ColumnDictionary &dictionary : dictionaries) {
+        if (dictionary.active) {
+            ++result.dictionaryColumns;
+        }
+    }
+    return true;
+}
+
 bool DuckDBManager::interruptQuery()
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    if (!m_connected || !m_connection) {
+    // m_mutex is held for the whole of a running query, so interrupting must not wait for it
+    std::lock_guard<std::mutex> lock(m_interruptMutex);
+    if (!m_interruptConnection) {
         return false;
     }
-    duckdb_interrupt(*m_connection);
+    duckdb_interrupt(m_interruptConnection);
     return true;
 }
 
@@ -380,3 +1061,302 @@ QStringList DuckDBManager::getAllTables() const
     duckdb_destroy_result(&result);
     return tables;
 }
+
+QStringList DuckDBManager::getTableColumns(const QString &tableName) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    QStringList columns;
+
+    if (!m_connected) {
+        return columns;
+    }
+
+    QString query = QString("SELECT column_name FROM information_schema.columns "
+                            "WHERE table_schema = 'main' AND table_name = %1 ORDER BY ordinal_position;")
+                        .arg(quoteLiteral(tableName));
+
+    duckdb_result result;
+    if (duckdb_query(*m_connection, query.toUtf8().constData(), &result) == DuckDBError) {
+        qWarning() << "Failed to query columns:" << duckdb_result_error(&result);
+        duckdb_destroy_result(&result);
+        return columns;
+    }
+
+    idx_t rowCount = duckdb_row_count(&result);
+    for (idx_t row = 0; row < rowCount; row++) {
+        char* columnName = duckdb_value_varchar(&result, 0, row);
+        columns.append(QString::fromUtf8(columnName ? columnName : ""));
+        if (columnName) duckdb_free(columnName);
+    }
+
+    duckdb_destroy_result(&result);
+    return columns;
+}
+
+QString DuckDBManager::typeName(duckdb_type type)
+{
+    // Spelled the way DESCRIBE reports them; parameterised types (DECIMAL, ENUM, nested) by their base name
+    switch (type) {
+    case DUCKDB_TYPE_BOOLEAN: return "BOOLEAN";
+    case DUCKDB_TYPE_TINYINT: return "TINYINT";
+    case DUCKDB_TYPE_SMALLINT: return "SMALLINT";
+    case DUCKDB_TYPE_INTEGER: return "INTEGER";
+    case DUCKDB_TYPE_BIGINT: return "BIGINT";
+    case DUCKDB_TYPE_UTINYINT: return "UTINYINT";
+    case DUCKDB_TYPE_USMALLINT: return "USMALLINT";
+    case DUCKDB_TYPE_UINTEGER: return "UINTEGER";
+    case DUCKDB_TYPE_UBIGINT: return "UBIGINT";
+    case DUCKDB_TYPE_HUGEINT: return "HUGEINT";
+    case DUCKDB_TYPE_FLOAT: return "FLOAT";
+    case DUCKDB_TYPE_DOUBLE: return "DOUBLE";
+    case DUCKDB_TYPE_DECIMAL: return "DECIMAL";
+    case DUCKDB_TYPE_DATE: return "DATE";
+    case DUCKDB_TYPE_TIME: return "TIME";
+    case DUCKDB_TYPE_TIME_TZ: return "TIME WITH TIME ZONE";
+    case DUCKDB_TYPE_TIMESTAMP: return "TIMESTAMP";
+    case DUCKDB_TYPE_TIMESTAMP_S: return "TIMESTAMP_S";
+    case DUCKDB_TYPE_TIMESTAMP_MS: return "TIMESTAMP_MS";
+    case DUCKDB_TYPE_TIMESTAMP_NS: return "TIMESTAMP_NS";
+    case DUCKDB_TYPE_TIMESTAMP_TZ: return "TIMESTAMP WITH TIME ZONE";
+    case DUCKDB_TYPE_INTERVAL: return "INTERVAL";
+    case DUCKDB_TYPE_VARCHAR: return "VARCHAR";
+    case DUCKDB_TYPE_BLOB: return "BLOB";
+    case DUCKDB_TYPE_BIT: return "BIT";
+    case DUCKDB_TYPE_UUID: return "UUID";
+    case DUCKDB_TYPE_ENUM: return "ENUM";
+    case DUCKDB_TYPE_LIST: return "LIST";
+    case DUCKDB_TYPE_STRUCT: return "STRUCT";
+    case DUCKDB_TYPE_MAP: return "MAP";
+    case DUCKDB_TYPE_UNION: return "UNION";
+    default: return QString();
+    }
+}
+
+QStringList DuckDBManager::describeQuery(const QString &query, QStringList *columnTypes)
+{
+    QStringList columns;
+    if (columnTypes) {
+        columnTypes->clear();
+    }
+
+    QueryResult result = executeBackgroundQuery(QString("DESCRIBE SELECT * FROM %1;").arg(asSubquery(query)));
+    if (!result.success) {
+        qWarning() << "Failed to describe query:" << result.error;
+        return columns;
+    }
+
+    // DESCRIBE returns one row per output column: column_name, column_type, ...
+    for (const QVariantList &row : result.rows) {
+        if (row.size() < 2) {
+            continue;
+        }
+        columns.append(row[0].toString());
+        if (columnTypes) {
+            columnTypes->append(row[1].toString());
+        }
+    }
+    return columns;
+}
+
+DuckDBManager::IndexBuildResult DuckDBManager::buildLookupIndex(const QString &tableName, const QStringList &keyColumns)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    IndexBuildResult result;
+    result.tableName = tableName;
+    result.keyColumns = keyColumns;
+
+    if (!m_connected) {
+        result.error = "Database not connected";
+        return result;
+    }
+
+    if (keyColumns.isEmpty()) {
+        result.error = "No key columns selected";
+        return result;
+    }
+
+    QStringList objectType = queryFirstRow(QString(
+        "SELECT table_type FROM information_schema.tables WHERE table_schema = 'main' AND table_name = %1;")
+        .arg(quoteLiteral(tableName)));
+    if (objectType.isEmpty()) {
+        result.error = "Table not found: " + tableName;
+        return result;
+    }
+
+    QStringList quotedKeys;
+    for (const QString &column : keyColumns) {
+        quotedKeys.append(quoteIdentifier(column));
+    }
+    QString keyList = quotedKeys.join(", ");
+
+    // Time a representative point lookup against the unsorted source first
+    QString predicate = buildSampleLookupPredicate(tableName, keyColumns);
+    if (!predicate.isEmpty()) {
+        result.scanLookupUs = timeLookup(tableName, predicate);
+    }
+
+    QString quotedTable = quoteIdentifier(tableName);
+    QString sortedTable = quoteIdentifier(tableName + "__sorted");
+    QString dropStatement = objectType.first() == "VIEW" ? "DROP VIEW %1;" : "DROP TABLE %1;";
+
+    // Sorting first keeps zone maps tight for range predicates; the ART index serves equality lookups
+    QStringList statements = {
+        "BEGIN TRANSACTION;",
+        QString("CREATE OR REPLACE TABLE %1 AS SELECT * FROM %2 ORDER BY %3;").arg(sortedTable, quotedTable, keyList),
+        dropStatement.arg(quotedTable),
+        QString("ALTER TABLE %1 RENAME TO %2;").arg(sortedTable, quotedTable),
+        QString("CREATE INDEX %1 ON %2 (%3);").arg(quoteIdentifier(tableName + "_lookup_idx"), quotedTable, keyList),
+        "COMMIT;"
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // The rewritten table and its index exist only in this session
+    m_sessionChanged.store(true);
+    for (const QString &sql : statements) {
+        QString error;
+        if (!runStatement(sql, &error)) {
+            runStatement("ROLLBACK;");
+            result.error = QString("Failed to build lookup index: %1").arg(error);
+            qWarning() << "DuckDB index build failed:" << result.error;
+            return result;
+        }
+    }
+
+    result.buildTimeMs = timer.elapsed();
+
+    if (!predicate.isEmpty()) {
+        result.indexedLookupUs = timeLookup(tableName, predicate);
+    }
+
+    if (!m_loadedTables.contains(tableName)) {
+        m_loadedTables.append(tableName);
+    }
+
+    result.success = true;
+    return result;
+}
+
+bool DuckDBManager::runStatement(const QString &sql, QString *error)
+{
+    duckdb_result result;
+    bool ok = duckdb_query(*m_connection, sql.toUtf8().constData(), &result) != DuckDBError;
+    if (!ok && error) {
+        const char* errorMsg = duckdb_result_error(&result);
+        *error = QString::fromUtf8(errorMsg ? errorMsg : "Unknown error");
+    }
+    duckdb_destroy_result(&result);
+    return ok;
+}
+
+QStringList DuckDBManager::queryFirstRow(const QString &sql) const
+{
+    QStringList values;
+
+    duckdb_result result;
+    if (duckdb_query(*m_connection, sql.toUtf8().constData(), &result) == DuckDBError) {
+        duckdb_destroy_result(&result);
+        return values;
+    }
+
+    if (duckdb_row_count(&result) > 0) {
+        idx_t columnCount = duckdb_column_count(&result);
+        for (idx_t col = 0; col < columnCount; col++) {
+            char* value = duckdb_value_varchar(&result, col, 0);
+            values.append(QString::fromUtf8(value ? value : ""));
+            if (value) duckdb_free(value);
+        }
+    }
+
+    duckdb_destroy_result(&result);
+    return values;
+}
+
+QString DuckDBManager::buildSampleLookupPredicate(const QString &tableName, const QStringList &keyColumns)
+{
+    QStringList selectList;
+    QStringList notNull;
+    for (const QString &column : keyColumns) {
+        QString quoted = quoteIdentifier(column);
+        selectList << QString("CAST(%1 AS VARCHAR)").arg(quoted) << QString("typeof(%1)").arg(quoted);
+        notNull << QString("%1 IS NOT NULL").arg(quoted);
+    }
+
+    QStringList sample = queryFirstRow(QString("SELECT %1 FROM %2 WHERE %3 LIMIT 1;")
+                                           .arg(selectList.join(", "), quoteIdentifier(tableName), notNull.join(" AND ")));
+    if (sample.size() != keyColumns.size() * 2) {
+        return QString();
+    }
+
+    // Cast the literal to the column type so the comparison stays index-eligible
+    QStringList terms;
+    for (int i = 0; i < keyColumns.size(); ++i) {
+        terms << QString("%1 = CAST(%2 AS %3)")
+                     .arg(quoteIdentifier(keyColumns[i]), quoteLiteral(sample[i * 2]), sample[i * 2 + 1]);
+    }
+    return terms.join(" AND ");
+}
+
+qint64 DuckDBManager::timeLookup(const QString &tableName, const QString &predicate)
+{
+    QString sql = QString("SELECT * FROM %1 WHERE %2;").arg(quoteIdentifier(tableName), predicate);
+
+    // Best of three, so the first run's cold buffers don't dominate the comparison
+    qint64 best = -1;
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        QElapsedTimer timer;
+        timer.start();
+        if (!runStatement(sql)) {
+            return -1;
+        }
+        qint64 elapsedUs = timer.nsecsElapsed() / 1000;
+        if (best < 0 || elapsedUs < best) {
+            best = elapsedUs;
+        }
+    }
+    return best;
+}
+
+QString DuckDBManager::quoteIdentifier(const QString &identifier)
+{
+    QString escaped = identifier;
+    escaped.replace("\"", "\"\"");
+    return QString("\"%1\"").arg(escaped);
+}
+
+QString DuckDBManager::quoteLiteral(const QString &value)
+{
+    QString escaped = value;
+    escaped.replace("'", "''");
+    return QString("'%1'").arg(escaped);
+}
+
+QString DuckDBManager::asSubquery(const QString &query)
+{
+    QString trimmed = query.trimmed();
+    while (trimmed.endsWith(';')) {
+        trimmed.chop(1);
+        trimmed = trimmed.trimmed();
+    }
+    // Newlines keep a trailing "-- comment" from swallowing the closing parenthesis
+    return QString("(\n%1\n)").arg(trimmed);
+}
+
+QString DuckDBManager::orderedQuery(const QString &query, const QList<QPair<int, Qt::SortOrder>> &sortColumns)
+{
+    if (sortColumns.isEmpty()) {
+        return query;
+    }
+
+    // Positions rather than names, so duplicate or unusual column names need no quoting
+    QStringList keys;
+    for (const auto &column : sortColumns) {
+        keys.append(QString("%1 %2").arg(QString::number(column.first + 1),
+                                         column.second == Qt::AscendingOrder ? QString("ASC NULLS LAST")
+                                                                             : QString("DESC NULLS FIRST")));
+    }
+    return QString("SELECT * FROM %1 ORDER BY %2").arg(asSubquery(query), keys.join(", "));
+}
@@ -0,0 +1,228 @@
+#include "exportdialog.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFormLayout>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QGroupBox>
+#include <QListWidget>
+#include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QLabel>
+#include <QSignalBlocker>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+ExportDialog::ExportDialog(const QString &sourcePath, QWidget *parent)
+    : QDialog(parent)
+    , m_pathEdit(nullptr)
+    , m_browseButton(nullptr)
+    , m_formatCombo(nullptr)
+    , m_parquetGroup(nullptr)
+    , m_compressionCombo(nullptr)
+    , m_compressionLevelSpin(nullptr)
+    , m_rowGroupSizeSpin(nullptr)
+    , m_partitionList(nullptr)
+    , m_perThreadCheck(nullptr)
+    , m_overwriteCheck(nullptr)
+    , m_buttonBox(nullptr)
+{
+    setWindowTitle(tr("Export Query Results"));
+
+    QFileInfo source(sourcePath);
+    QFileInfo sourceDirectory(source.absolutePath());
+    if (!sourcePath.isEmpty() && sourceDirectory.isDir() && sourceDirectory.isWritable()) {
+        m_defaultDirectory = sourceDirectory.absoluteFilePath();
+    } else {
+        m_defaultDirectory = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
+        if (m_defaultDirectory.isEmpty()) {
+            m_defaultDirectory = QDir::homePath();
+        }
+    }
+
+    setupUI();
+    QString baseName = source.completeBaseName();
+    m_pathEdit->setText(QDir(m_defaultDirectory).filePath(
+        (baseName.isEmpty() ? QString("results") : baseName + "_results") + ".parquet"));
+    setupConnections();
+    updateControls();
+}
+
+void ExportDialog::setupUI()
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    QFormLayout *outputLayout = new QFormLayout();
+    QHBoxLayout *pathLayout = new QHBoxLayout();
+    m_pathEdit = new QLineEdit();
+    m_browseButton = new QPushButton(tr("Browse..."));
+    pathLayout->addWidget(m_pathEdit);
+    pathLayout->addWidget(m_browseButton);
+    outputLayout->addRow(tr("Output:"), pathLayout);
+
+    m_formatCombo = new QComboBox();
+    m_formatCombo->addItem("Parquet", int(QueryExporter::Parquet));
+    m_formatCombo->addItem("CSV", int(QueryExporter::CSV));
+    m_formatCombo->addItem("TSV", int(QueryExporter::TSV));
+    m_formatCombo->addItem("JSON", int(QueryExporter::JSON));
+    outputLayout->addRow(tr("Format:"), m_formatCombo);
+    mainLayout->addLayout(outputLayout);
+
+    m_parquetGroup = new QGroupBox(tr("Parquet"));
+    QFormLayout *parquetLayout = new QFormLayout(m_parquetGroup);
+
+    m_compressionCombo = new QComboBox();
+    m_compressionCombo->addItem("zstd", "zstd");
+    m_compressionCombo->addItem("snappy", "snappy");
+    m_compressionCombo->addItem("lz4", "lz4");
+    m_compressionCombo->addItem(tr("uncompressed"), "uncompressed");
+    parquetLayout->addRow(tr("Compression:"), m_compressionCombo);
+
+    m_compressionLevelSpin = new QSpinBox();
+    m_compressionLevelSpin->setRange(0, 22);
+    m_compressionLevelSpin->setSpecialValueText(tr("Default"));
+    parquetLayout->addRow(tr("Compression level:"), m_compressionLevelSpin);
+
+    m_rowGroupSizeSpin = new QSpinBox();
+    m_rowGroupSizeSpin->setRange(0, 100000000);
+    m_rowGroupSizeSpin->setSingleStep(100000);
+    m_rowGroupSizeSpin->setSpecialValueText(tr("Default"));
+    m_rowGroupSizeSpin->setGroupSeparatorShown(true);
+    parquetLayout->addRow(tr("Row group size:"), m_rowGroupSizeSpin);
+    mainLayout->addWidget(m_parquetGroup);
+
+    QGroupBox *layoutGroup = new QGroupBox(tr("File Layout"));
+    QVBoxLayout *layoutLayout = new QVBoxLayout(layoutGroup);
+    layoutLayout->addWidget(new QLabel(tr("Partition by (writes a col=value directory tree):")));
+    m_partitionList = new QListWidget();
+    m_partitionList->setMaximumHeight(120);
+    QListWidgetItem *placeholder = new QListWidgetItem(tr("Reading columns..."), m_partitionList);
+    placeholder->setFlags(Qt::NoItemFlags);
+    layoutLayout->addWidget(m_partitionList);
+
+    m_perThreadCheck = new QCheckBox(tr("One file per writer thread (parallel output)"));
+    m_overwriteCheck = new QCheckBox(tr("Write into an existing directory"));
+    layoutLayout->addWidget(m_perThreadCheck);
+    layoutLayout->addWidget(m_overwriteCheck);
+    mainLayout->addWidget(layoutGroup);
+
+    m_buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    m_buttonBox->button(QDialogButtonBox::Ok)->setText(tr("Export"));
+    mainLayout->addWidget(m_buttonBox);
+}
+
+void ExportDialog::setColumns(const QStringList &columns)
+{
+    QSignalBlocker blocker(m_partitionList);
+    m_partitionList->clear();
+    for (const QString &column : columns) {
+        QListWidgetItem *item = new QListWidgetItem(column, m_partitionList);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(Qt::Unchecked);
+    }
+    if (columns.isEmpty()) {
+        QListWidgetItem *placeholder = new QListWidgetItem(tr("No columns to partition by"), m_partitionList);
+        placeholder->setFlags(Qt::NoItemFlags);
+    }
+}
+
+void ExportDialog::setupConnections()
+{
+    connect(m_browseButton, &QPushButton::clicked, this, &ExportDialog::onBrowse);
+    connect(m_formatCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &ExportDialog::updateControls);
+    connect(m_compressionCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &ExportDialog::updateControls);
+    connect(m_partitionList, &QListWidget::itemChanged, this, &ExportDialog::updateControls);
+    connect(m_perThreadCheck, &QCheckBox::toggled, this, &ExportDialog::updateControls);
+    connect(m_buttonBox, &QDialogButtonBox::accepted, this, &ExportDialog::accept);
+    connect(m_buttonBox, &QDialogButtonBox::rejected, this, &ExportDialog::reject);
+}
+
+void ExportDialog::onBrowse()
+{
+    QueryExporter::Options current = options();
+    QString path;
+    if (current.writesDirectory()) {
+        path = QFileDialog::getExistingDirectory(this, tr("Output Directory"), absolutePath(m_pathEdit->text()));
+    } else {
+        path = QFileDialog::getSaveFileName(this, tr("Export Query Results"), absolutePath(m_pathEdit->text()),
+            tr("Parquet Files (*.parquet);;CSV Files (*.csv);;TSV Files (*.tsv);;JSON Files (*.json)"));
+    }
+    if (path.isEmpty()) {
+        return;
+    }
+
+    m_pathEdit->setText(path);
+    if (!current.writesDirectory()) {
+        int index = m_formatCombo->findData(int(QueryExporter::formatForPath(path, current.format)));
+        if (index >= 0) {
+            m_formatCombo->setCurrentIndex(index);
+        }
+    }
+}
+
+void ExportDialog::updateControls()
+{
+    bool parquet = m_formatCombo->currentData().toInt() == QueryExporter::Parquet;
+    m_parquetGroup->setEnabled(parquet);
+    m_compressionLevelSpin->setEnabled(parquet && m_compressionCombo->currentData().toString() == "zstd");
+
+    // DuckDB cannot combine PER_THREAD_OUTPUT with PARTITION_BY
+    bool partitioned = !checkedPartitionColumns().isEmpty();
+    if (partitioned) {
+        m_perThreadCheck->setChecked(false);
+    }
+    m_perThreadCheck->setEnabled(!partitioned);
+    m_overwriteCheck->setEnabled(partitioned || m_perThreadCheck->isChecked());
+}
+
+QStringList ExportDialog::checkedPartitionColumns() const
+{
+    QStringList columns;
+    for (int i = 0; i < m_partitionList->count(); ++i) {
+        QListWidgetItem *item = m_partitionList->item(i);
+        if (item->checkState() == Qt::Checked) {
+            columns.append(item->text());
+        }
+    }
+    return columns;
+}
+
+QString ExportDialog::absolutePath(const QString &path) const
+{
+    // COPY resolves relative paths against the process working directory, which is rarely
+    // where the user expects the file to land
+    if (path.isEmpty()) {
+        return path;
+    }
+    return QDir::cleanPath(QDir(m_defaultDirectory).absoluteFilePath(QDir::fromNativeSeparators(path)));
+}
+
+QueryExporter::Options ExportDialog::options() const
+{
+    QueryExporter::Options options;
+    options.filePath = absolutePath(m_pathEdit->text().trimmed());
+    options.format = static_cast<QueryExporter::Format>(m_formatCombo->currentData().toInt());
+    if (options.format == QueryExporter::Parquet) {
+        options.compression = m_compressionCombo->currentData().toString();
+        options.compressionLevel = m_compressionLevelSpin->value();
+        options.rowGroupSize = m_rowGroupSizeSpin->value();
+    }
+    options.partitionBy = checkedPartitionColumns();
+    options.perThreadOutput = m_perThreadCheck->isChecked();
+    options.overwrite = m_overwriteCheck->isChecked();
+    return options;
+}
+
+void ExportDialog::accept()
+{
+    if (m_pathEdit->text().trimmed().isEmpty()) {
+        QMessageBox::warning(this, tr("Export Query Results"), tr("Please choose an output path."));
+        return;
+    }
+    QDialog::accept();
+}
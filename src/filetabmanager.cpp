@@ -3,6 +3,13 @@
 #include "resultstablemodel.h"
 #include "chartmanager.h"
 #include "sqlexecutor.h"
+#include "queryexporter.h"
+#include "exportdialog.h"
+#include "clipboardcopier.h"
+#include "resultfilter.h"
+#include "columnprofiler.h"
+#include "backgroundtask.h"
+#include "compressedresult.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -12,7 +19,7 @@
 #include <QPushButton>
 #include <QLabel>
 #include <QLineEdit>
-#include <QSortFilterProxyModel>
+#include <QScrollBar>
 #include <QFileInfo>
 #include <QMessageBox>
 #include <QApplication>
@@ -22,11 +29,26 @@
 #include <QFont>
 #include <QHeaderView>
 #include <QFileDialog>
+#include <QInputDialog>
+#include <QProgressDialog>
+#include <QLocale>
+#include <QClipboard>
+#include <QItemSelectionModel>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QSignalBlocker>
+#include <QTableWidget>
+#include <QMenu>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QPlainTextEdit>
+#include <algorithm>
 
 FileTabManager::FileTabManager(QWidget *parent)
     : QWidget(parent)
     , m_mainLayout(nullptr)
     , m_tabWidget(nullptr)
+    , m_hibernateTimer(nullptr)
 {
     setupUI();
     setupConnections();
@@ -55,6 +77,11 @@ void FileTabManager::setupConnections()
 {
     connect(m_tabWidget, &QTabWidget::currentChanged, this, &FileTabManager::onTabChanged);
     connect(m_tabWidget, &QTabWidget::tabCloseRequested, this, &FileTabManager::onTabCloseRequested);
+
+    m_hibernateTimer = new QTimer(this);
+    m_hibernateTimer->setInterval(HIBERNATE_CHECK_MS);
+    connect(m_hibernateTimer, &QTimer::timeout, this, &FileTabManager::hibernateIdleTabs);
+    m_hibernateTimer->start();
 }
 
 void FileTabManager::addFileTab(const QString &filePath)
@@ -71,13 +98,10 @@ void FileTabManager::addFileTab(const QString &filePath)
     FileTabData *tabData = new FileTabData();
     tabData->filePath = filePath;
     tabData->fileName = QFileInfo(filePath).fileName();
-    tabData->dbManager = std::make_unique<DuckDBManager>();
-    tabData->sqlExecutor = std::make_unique<SQLExecutor>(tabData->dbManager.get());
-    tabData->resultsModel = std::make_unique<ResultsTableModel>();
     tabData->chartManager = nullptr; // Will be created in createFileTabWidget with proper parent
     
     // Load the file
-    if (!tabData->dbManager->loadFile(filePath)) {
+    if (!openTabDatabase(tabData)) {
         QMessageBox::critical(this, tr("Error"), 
                              tr("Failed to load file: %1").arg(filePath));
         delete tabData;
@@ -96,10 +120,33 @@ void FileTabManager::addFileTab(const QString &filePath)
     
     // Switch to new tab
     m_tabWidget->setCurrentIndex(tabIndex);
+
+    startColumnProfile(tabData);
     
     emit fileLoaded(filePath);
 }
 
+bool FileTabManager::openTabDatabase(FileTabData *tabData)
+{
+    auto dbManager = std::make_shared<DuckDBManager>();
+    if (!dbManager->loadFile(tabData->filePath)) {
+        return false;
+    }
+    attachTabDatabase(tabData, std::move(dbManager));
+    return true;
+}
+
+void FileTabManager::attachTabDatabase(FileTabData *tabData, std::shared_ptr<DuckDBManager> dbManager)
+{
+    tabData->dbManager = std::move(dbManager);
+    tabData->sqlExecutor = std::make_unique<SQLExecutor>(tabData->dbManager.get());
+    tabData->queryExporter = std::make_unique<QueryExporter>(tabData->dbManager);
+    tabData->clipboardCopier = std::make_unique<ClipboardCopier>(tabData->dbManager);
+    tabData->columnProfiler = std::make_unique<ColumnProfiler>(tabData->dbManager);
+    tabData->resultsModel = std::make_unique<ResultsTableModel>();
+    tabData->resultsModel->setDatabaseManager(tabData->dbManager);
+}
+
 QWidget* FileTabManager::createFileTabWidget(FileTabData *tabData)
 {
     QWidget *tabWidget = new QWidget();
@@ -130,20 +177,20 @@ QWidget* FileTabManager::createFileTabWidget(FileTabData *tabData)
     QPushButton *executeButton = new QPushButton("Execute Query");
     tabData->cancelQueryButton = new QPushButton("Cancel Query");
     QPushButton *clearButton = new QPushButton("Clear");
-    QPushButton *exportCSVButton = new QPushButton("Export CSV");
-    QPushButton *exportTSVButton = new QPushButton("Export TSV");
+    QPushButton *exportQueryButton = new QPushButton("Export Query...");
     QPushButton *refreshChartsButton = new QPushButton("Update Charts");
     QPushButton *toggleChartsButton = new QPushButton("Show Charts");
+    QPushButton *toggleProfileButton = new QPushButton("Show Profile");
 
     tabData->cancelQueryButton->setEnabled(false);
 
     buttonLayout->addWidget(executeButton);
     buttonLayout->addWidget(tabData->cancelQueryButton);
     buttonLayout->addWidget(clearButton);
-    buttonLayout->addWidget(exportCSVButton);
-    buttonLayout->addWidget(exportTSVButton);
+    buttonLayout->addWidget(exportQueryButton);
     buttonLayout->addWidget(toggleChartsButton);
     buttonLayout->addWidget(refreshChartsButton);
+    buttonLayout->addWidget(toggleProfileButton);
     buttonLayout->addStretch();
     queryLayout->addLayout(buttonLayout);
     
@@ -158,39 +205,93 @@ QWidget* FileTabManager::createFileTabWidget(FileTabData *tabData)
     // Table filter
     tabData->tableFilterEdit = new QLineEdit();
     tabData->tableFilterEdit->setPlaceholderText("Filter table data...");
+    tabData->tableFilterEdit->setToolTip(
+        tr("Text searches every text column; \"column > value\" compares one column; "
+           "\"where <condition>\" applies a SQL condition"));
     resultsLayout->addWidget(tabData->tableFilterEdit);
-    
-    // Set up proxy model for sorting and filtering
-    tabData->proxyModel = new QSortFilterProxyModel(tabWidget);
-    tabData->proxyModel->setSourceModel(tabData->resultsModel.get());
-    tabData->proxyModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
-    tabData->proxyModel->setFilterKeyColumn(-1);
+    tabData->filterTimer = new QTimer(tabWidget);
+    tabData->filterTimer->setSingleShot(true);
+    tabData->filterTimer->setInterval(FILTER_DEBOUNCE_MS);
     
     tabData->resultsTableView = new QTableView();
-    tabData->resultsTableView->setModel(tabData->proxyModel);
-    tabData->resultsTableView->setSortingEnabled(true);
+    tabData->resultsTableView->setModel(tabData->resultsModel.get());
+    // Sorting is pushed down to DuckDB, so the view only shows the indicator
+    tabData->resultsTableView->setSortingEnabled(false);
+    tabData->resultsTableView->horizontalHeader()->setSectionsClickable(true);
+    tabData->resultsTableView->horizontalHeader()->setSortIndicatorShown(true);
+    tabData->resultsTableView->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
     tabData->resultsTableView->setAlternatingRowColors(true);
     tabData->resultsTableView->setSelectionBehavior(QAbstractItemView::SelectRows);
     tabData->resultsTableView->horizontalHeader()->setStretchLastSection(true);
-    resultsLayout->addWidget(tabData->resultsTableView);
-    
-    // Pagination controls
-    QHBoxLayout *paginationLayout = new QHBoxLayout();
-    tabData->firstPageButton = new QPushButton("First");
-    tabData->prevPageButton = new QPushButton("Previous");
-    tabData->pageInfoLabel = new QLabel("Page 0 of 0");
-    tabData->nextPageButton = new QPushButton("Next");
-    tabData->lastPageButton = new QPushButton("Last");
-    tabData->rowCountLabel = new QLabel("0 rows");
+    // Fixed row heights keep scrolling O(1) however many rows the result has
+    tabData->resultsTableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    tabData->resultsTableView->verticalHeader()->setDefaultSectionSize(
+        tabData->resultsTableView->fontMetrics().height() + 6);
+
+    // Row detail pane beside the grid: every field of the current row at full length
+    tabData->rowDetailPanel = new QWidget();
+    QVBoxLayout *rowDetailLayout = new QVBoxLayout(tabData->rowDetailPanel);
+    rowDetailLayout->setContentsMargins(0, 0, 0, 0);
+    tabData->rowDetailTable = new QTableWidget(0, 2);
+    tabData->rowDetailTable->setHorizontalHeaderLabels({"Field", "Value"});
+    tabData->rowDetailTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    tabData->rowDetailTable->setWordWrap(true);
+    tabData->rowDetailTable->verticalHeader()->setVisible(false);
+    tabData->rowDetailTable->horizontalHeader()->setStretchLastSection(true);
+    rowDetailLayout->addWidget(tabData->rowDetailTable);
+    tabData->rowDetailPanel->setVisible(false);
+    tabData->rowDetailTask = new BackgroundTask(tabData->rowDetailPanel);
+    tabData->rowDetailTask->setThreadPool(BackgroundTask::interactivePool());
+    tabData->snapshotTask = new BackgroundTask(tabData->resultsTableView);
+    tabData->compressTask = new BackgroundTask(tabData->resultsTableView);
+    tabData->hibernateTask = new BackgroundTask(tabData->resultsTableView);
+    tabData->indexTask = new BackgroundTask(tabData->resultsTableView);
+    tabData->describeTask = new BackgroundTask(tabData->tableFilterEdit);
+
+    QSplitter *resultsSplitter = new QSplitter(Qt::Horizontal);
+    resultsSplitter->addWidget(tabData->resultsTableView);
+    resultsSplitter->addWidget(tabData->rowDetailPanel);
+    resultsSplitter->setSizes({500, 250});
+    resultsLayout->addWidget(resultsSplitter);
+
+    tabData->resultsTableView->horizontalHeader()->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(tabData->resultsTableView->horizontalHeader(), &QWidget::customContextMenuRequested,
+            this, [this, tabData](const QPoint &pos) {
+        showColumnMenu(tabData, pos);
+    });
+
+    QAction *copySelectedAction = new QAction(tr("Copy Selected Rows"), tabData->resultsTableView);
+    copySelectedAction->setShortcut(QKeySequence::Copy);
+    copySelectedAction->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+    connect(copySelectedAction, &QAction::triggered, this, &FileTabManager::copySelectedRows);
+    QAction *copyAllAction = new QAction(tr("Copy All Result Rows"), tabData->resultsTableView);
+    connect(copyAllAction, &QAction::triggered, this, &FileTabManager::copyAllRows);
+    tabData->resultsTableView->addAction(copySelectedAction);
+    tabData->resultsTableView->addAction(copyAllAction);
+    QAction *viewCellAction = new QAction(tr("View Full Value"), tabData->resultsTableView);
+    connect(viewCellAction, &QAction::triggered, this, [this, tabData]() {
+        showCellValue(tabData, tabData->resultsTableView->currentIndex());
+    });
+    QAction *rowDetailsAction = new QAction(tr("Show Row Details"), tabData->resultsTableView);
+    rowDetailsAction->setCheckable(true);
+    connect(rowDetailsAction, &QAction::toggled, this, [this, tabData](bool checked) {
+        tabData->rowDetailPanel->setVisible(checked);
+        if (checked) {
+            showRowDetails(tabData);
+        }
+    });
+    tabData->resultsTableView->addAction(viewCellAction);
+    tabData->resultsTableView->addAction(rowDetailsAction);
+    tabData->resultsTableView->setContextMenuPolicy(Qt::ActionsContextMenu);
     
-    paginationLayout->addWidget(tabData->firstPageButton);
-    paginationLayout->addWidget(tabData->prevPageButton);
-    paginationLayout->addWidget(tabData->pageInfoLabel);
-    paginationLayout->addWidget(tabData->nextPageButton);
-    paginationLayout->addWidget(tabData->lastPageButton);
-    paginationLayout->addStretch();
-    paginationLayout->addWidget(tabData->rowCountLabel);
-    resultsLayout->addLayout(paginationLayout);
+    // Row range and count
+    QHBoxLayout *rowInfoLayout = new QHBoxLayout();
+    tabData->rowRangeLabel = new QLabel("No rows");
+    tabData->rowCountLabel = new QLabel("0 rows");
+    rowInfoLayout->addWidget(tabData->rowRangeLabel);
+    rowInfoLayout->addStretch();
+    rowInfoLayout->addWidget(tabData->rowCountLabel);
+    resultsLayout->addLayout(rowInfoLayout);
     
     // Add panels to left splitter
     leftSplitter->addWidget(queryPanel);
@@ -200,9 +301,29 @@ QWidget* FileTabManager::createFileTabWidget(FileTabData *tabData)
     // Create chart manager with proper parent (will be deleted when tabWidget is deleted)
     tabData->chartManager = new ChartManager(tabWidget);
     
-    // Add left splitter and chart manager to main splitter
+    // Column profile panel, filled in the background after the file loads
+    tabData->profilePanel = new QWidget();
+    QVBoxLayout *profileLayout = new QVBoxLayout(tabData->profilePanel);
+    QLabel *profileLabel = new QLabel("Column Profile");
+    profileLabel->setStyleSheet("font-weight: bold;");
+    profileLayout->addWidget(profileLabel);
+    tabData->profileStatusLabel = new QLabel("Profiling columns...");
+    tabData->profileStatusLabel->setWordWrap(true);
+    profileLayout->addWidget(tabData->profileStatusLabel);
+    tabData->profileTable = new QTableWidget(0, 9);
+    tabData->profileTable->setHorizontalHeaderLabels(
+        {"Column", "Type", "Min", "Max", "Nulls", "Distinct (approx.)", "Mean", "Median", "Q25 / Q75"});
+    tabData->profileTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    tabData->profileTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    tabData->profileTable->verticalHeader()->setVisible(false);
+    tabData->profileTable->horizontalHeader()->setStretchLastSection(true);
+    profileLayout->addWidget(tabData->profileTable);
+    tabData->profilePanel->setVisible(false);
+
+    // Add left splitter, chart manager and profile panel to main splitter
     mainSplitter->addWidget(leftSplitter);
     mainSplitter->addWidget(tabData->chartManager);
+    mainSplitter->addWidget(tabData->profilePanel);
     mainSplitter->setSizes({600, 400});
     
     mainLayout->addWidget(mainSplitter);
@@ -230,76 +351,13 @@ QWidget* FileTabManager::createFileTabWidget(FileTabData *tabData)
     
     connect(clearButton, &QPushButton::clicked, [this, tabData]() {
         tabData->sqlEditor->clear();
+        tabData->snapshotTask->cancel();
         tabData->resultsModel->clear();
         tabData->chartManager->clearCharts();
-        updatePaginationControls(tabData);
-    });
-
-    connect(exportCSVButton, &QPushButton::clicked, [this, tabData]() {
-        try {
-            if (!tabData || !tabData->resultsModel) {
-                QMessageBox::warning(this, tr("Export Failed"), tr("No results to export"));
-                return;
-            }
-
-            QString fileName = QFileDialog::getSaveFileName(
-                this,
-                tr("Export Results as CSV"),
-                QString("results.csv"),
-                tr("CSV Files (*.csv)")
-            );
-            if (!fileName.isEmpty()) {
-                if (tabData->resultsModel->exportToCSV(fileName)) {
-                    QMessageBox::information(this, tr("Export Successful"),
-                                           tr("Results exported to %1").arg(fileName));
-                } else {
-                    QMessageBox::warning(this, tr("Export Failed"),
-                                       tr("Failed to export results to %1").arg(fileName));
-                }
-            }
-        } catch (const std::exception &e) {
-            qCritical() << "Export CSV exception:" << e.what();
-            QMessageBox::critical(this, tr("Export Failed"),
-                                tr("Export failed with error: %1").arg(e.what()));
-        } catch (...) {
-            qCritical() << "Export CSV unknown exception";
-            QMessageBox::critical(this, tr("Export Failed"),
-                                tr("Export failed with unknown error"));
-        }
+        updateRowInfo(tabData);
     });
 
-    connect(exportTSVButton, &QPushButton::clicked, [this, tabData]() {
-        try {
-            if (!tabData || !tabData->resultsModel) {
-                QMessageBox::warning(this, tr("Export Failed"), tr("No results to export"));
-                return;
-            }
-
-            QString fileName = QFileDialog::getSaveFileName(
-                this,
-                tr("Export Results as TSV"),
-                QString("results.tsv"),
-                tr("TSV Files (*.tsv)")
-            );
-            if (!fileName.isEmpty()) {
-                if (tabData->resultsModel->exportToTSV(fileName)) {
-                    QMessageBox::information(this, tr("Export Successful"),
-                                           tr("Results exported to %1").arg(fileName));
-                } else {
-                    QMessageBox::warning(this, tr("Export Failed"),
-                                       tr("Failed to export results to %1").arg(fileName));
-                }
-            }
-        } catch (const std::exception &e) {
-            qCritical() << "Export TSV exception:" << e.what();
-            QMessageBox::critical(this, tr("Export Failed"),
-                                tr("Export failed with error: %1").arg(e.what()));
-        } catch (...) {
-            qCritical() << "Export TSV unknown exception";
-            QMessageBox::critical(this, tr("Export Failed"),
-                                tr("Export failed with unknown error"));
-        }
-    });
+    connect(exportQueryButton, &QPushButton::clicked, this, &FileTabManager::exportCurrentQuery);
 
     connect(refreshChartsButton, &QPushButton::clicked, [this, tabData]() {
         try {
@@ -307,8 +365,10 @@ QWidget* FileTabManager::createFileTabWidget(FileTabData *tabData)
                 QMessageBox::warning(this, tr("Error"), tr("Chart manager not available"));
                 return;
             }
-            auto results = tabData->sqlExecutor->getResults();
-            tabData->chartManager->setData(results, tabData->filePath);
+            auto results = chartResults(tabData);
+            tabData->chartManager->setQuerySource(tabData->dbManager, resultSourceQuery(tabData));
+            tabData->chartManager->setData(results, tabData->filePath, tabData->resultsModel->resultId(),
+                                           tabData->resultsModel->compressedResult());
         } catch (const std::exception &e) {
             qCritical() << "Refresh charts exception:" << e.what();
             QMessageBox::critical(this, tr("Error"),
@@ -328,9 +388,11 @@ QWidget* FileTabManager::createFileTabWidget(FileTabData *tabData)
 
             // Auto-update charts when showing them
             if (!isVisible && tabData->sqlExecutor) {
-                auto results = tabData->sqlExecutor->getResults();
+                auto results = chartResults(tabData);
                 if (!results.columnNames.isEmpty()) {
-                    tabData->chartManager->setData(results, tabData->filePath);
+                    tabData->chartManager->setQuerySource(tabData->dbManager, resultSourceQuery(tabData));
+                    tabData->chartManager->setData(results, tabData->filePath, tabData->resultsModel->resultId(),
+                                                   tabData->resultsModel->compressedResult());
                 }
             }
         } catch (const std::exception &e) {
@@ -340,32 +402,118 @@ QWidget* FileTabManager::createFileTabWidget(FileTabData *tabData)
         }
     });
     
-    connect(tabData->tableFilterEdit, &QLineEdit::textChanged, 
-            tabData->proxyModel, &QSortFilterProxyModel::setFilterFixedString);
+    connect(toggleProfileButton, &QPushButton::clicked, [tabData, toggleProfileButton]() {
+        bool isVisible = tabData->profilePanel->isVisible();
+        tabData->profilePanel->setVisible(!isVisible);
+        toggleProfileButton->setText(isVisible ? "Show Profile" : "Hide Profile");
+    });
+
+    connect(tabData->tableFilterEdit, &QLineEdit::textChanged, this, [tabData]() {
+        tabData->filterTimer->start();
+        // The in-flight filter is stale as soon as the text changes
+        if (tabData->resultQueryRunning && tabData->sqlExecutor->isExecuting()) {
+            tabData->runningQuerySuperseded = true;
+            tabData->sqlExecutor->cancelExecution();
+        }
+    });
+    connect(tabData->filterTimer, &QTimer::timeout, this, [this, tabData]() {
+        applyFilter(tabData);
+    });
     
-    connect(tabData->firstPageButton, &QPushButton::clicked, this, &FileTabManager::onFirstPage);
-    connect(tabData->prevPageButton, &QPushButton::clicked, this, &FileTabManager::onPreviousPage);
-    connect(tabData->nextPageButton, &QPushButton::clicked, this, &FileTabManager::onNextPage);
-    connect(tabData->lastPageButton, &QPushButton::clicked, this, &FileTabManager::onLastPage);
+    connect(tabData->resultsTableView->horizontalHeader(), &QHeaderView::sectionClicked, this, [this, tabData](int section) {
+        // Shift+click adds the column to the sort keys, or flips it if it is already one
+        sortResults(tabData, section, QApplication::keyboardModifiers() & Qt::ShiftModifier);
+    });
+
+    connect(tabData->resultsTableView->verticalScrollBar(), &QScrollBar::valueChanged, this, [this, tabData]() {
+        updateRowInfo(tabData);
+    });
+    connect(tabData->resultsModel.get(), &QAbstractItemModel::modelReset, this, [this, tabData]() {
+        // A reset (e.g. reversing the sort) keeps the model's hidden columns; the header must match
+        for (int column : tabData->resultsModel->hiddenColumns()) {
+            tabData->resultsTableView->setColumnHidden(column, true);
+        }
+        updateRowInfo(tabData);
+        showRowDetails(tabData);
+    });
+
+    connect(tabData->resultsTableView, &QAbstractItemView::doubleClicked, this, [this, tabData](const QModelIndex &index) {
+        showCellValue(tabData, index);
+    });
+    connect(tabData->resultsTableView->selectionModel(), &QItemSelectionModel::currentRowChanged, this,
+            [this, tabData]() {
+        showRowDetails(tabData);
+    });
     
     // Connect SQLExecutor signals for this tab
     connect(tabData->sqlExecutor.get(), &SQLExecutor::queryExecuted,
             [this, tabData, executeButton](bool success, const QString &error) {
-                executeButton->setEnabled(true);
-                if (tabData->cancelQueryButton) {
-                    tabData->cancelQueryButton->setEnabled(false);
+                bool wasResultQuery = tabData->resultQueryRunning;
+                bool superseded = tabData->runningQuerySuperseded;
+                tabData->resultQueryRunning = false;
+                tabData->runningQuerySuperseded = false;
+
+                bool hasPending = !tabData->pendingQuery.isEmpty();
+                if (hasPending) {
+                    // Queued so resultsReady for the finished query is handled first
+                    QMetaObject::invokeMethod(this, [this, tabData]() {
+                        QString query = tabData->pendingQuery;
+                        tabData->pendingQuery.clear();
+                        if (!query.isEmpty() && !tabData->sqlExecutor->isExecuting()) {
+                            startTabQuery(tabData, query, tabData->pendingIsResultQuery);
+                        }
+                    }, Qt::QueuedConnection);
+                } else {
+                    executeButton->setEnabled(true);
+                    if (tabData->cancelQueryButton) {
+                        tabData->cancelQueryButton->setEnabled(false);
+                    }
+                }
+
+                if (!wasResultQuery) {
+                    emit queryExecuted(success, error);
+                } else if (!success && !hasPending) {
+                    // The previous result stays on screen; keep the header showing its sort
+                    tabData->sortColumns = tabData->resultsModel->sortMarkers();
+                    updateSortIndicator(tabData);
+                    if (!superseded) {
+                        emit executionProgress(tr("Sort/filter failed: %1").arg(error));
+                    }
                 }
-                emit queryExecuted(success, error);
             });
     
     connect(tabData->sqlExecutor.get(), &SQLExecutor::resultsReady,
             [this, tabData]() {
-                // Update the current tab's results
-                auto results = tabData->sqlExecutor->getResults();
-                tabData->resultsModel->setResults(results);
-                // Don't automatically update charts - let user manually refresh them
-                updatePaginationControls(tabData);
-                emit resultsReady();
+                // The model is built on a pool thread and swapped in whole, so the GUI thread
+                // never touches every row. A newer result detaches a snapshot still being built.
+                auto results = tabData->sqlExecutor->takeResults();
+                const QString query = tabData->runningQuery;
+                const QList<QPair<int, Qt::SortOrder>> sortColumns = tabData->runningSortColumns;
+                auto snapshot = std::make_shared<std::shared_ptr<ResultsTableModel::Snapshot>>();
+                disconnect(tabData->snapshotTask, &BackgroundTask::finished, nullptr, nullptr);
+                connect(tabData->snapshotTask, &BackgroundTask::finished, tabData->resultsTableView,
+                        [this, tabData, query, sortColumns, snapshot](bool cancelled) {
+                    if (cancelled || !*snapshot) {
+                        return;
+                    }
+                    tabData->lastQuery = query;
+                    tabData->compressTask->cancel();
+                    tabData->resultsModel->setSnapshot(*snapshot);
+                    snapshot->reset();
+                    tabData->resultsModel->setSortMarkers(sortColumns);
+                    updateSortIndicator(tabData);
+                    // Don't automatically update charts - let user manually refresh them
+                    updateRowInfo(tabData);
+                    if (tabData != getCurrentTabData()) {
+                        compressTabResults(tabData);
+                        // A result arriving in the background counts as activity
+                        tabData->idleTimer.start();
+                    }
+                    emit resultsReady();
+                });
+                tabData->snapshotTask->start([results, snapshot](BackgroundTask::Control &) {
+                    *snapshot = ResultsTableModel::prepareSnapshot(results);
+                });
             });
     
     connect(tabData->sqlExecutor.get(), &SQLExecutor::executionProgress, 
@@ -398,7 +546,7 @@ QWidget* FileTabManager::createFileTabWidget(FileTabData *tabData)
     }
     tabData->sqlEditor->setPlainText(defaultQuery);
     
-    updatePaginationControls(tabData);
+    updateRowInfo(tabData);
     
     return tabWidget;
 }
@@ -406,19 +554,21 @@ QWidget* FileTabManager::createFileTabWidget(FileTabData *tabData)
 void FileTabManager::closeFileTab(int index)
 {
     if (index >= 0 && index < m_tabWidget->count() && index < m_tabData.size()) {
+        // Taken out first so the currentChanged fired by removeTab sees matching indices
+        FileTabData *tabData = m_tabData.takeAt(index);
         QWidget *widget = m_tabWidget->widget(index);
         m_tabWidget->removeTab(index);
         delete widget;
         
-        delete m_tabData[index];
-        m_tabData.removeAt(index);
+        delete tabData;
     }
 }
 
 FileTabData* FileTabManager::getCurrentTabData()
 {
     int currentIndex = m_tabWidget->currentIndex();
-    if (currentIndex >= 0 && currentIndex < m_tabData.size()) {
+    // A hibernated tab has no database or widgets to act on
+    if (currentIndex >= 0 && currentIndex < m_tabData.size() && !m_tabData[currentIndex]->hibernated) {
         return m_tabData[currentIndex];
     }
     return nullptr;
@@ -455,8 +605,19 @@ void FileTabManager::executeQuery(const QString &query)
             return;
         }
 
-        // Use the tab's SQLExecutor to execute the query
-        tabData->sqlExecutor->executeQuery(query);
+        // A new query starts unsorted and unfiltered
+        tabData->baseQuery = query;
+        tabData->sortColumns.clear();
+        tabData->filterPredicate.clear();
+        tabData->columnNames.clear();
+        tabData->columnTypes.clear();
+        tabData->describeTask->cancel();
+        tabData->filterTimer->stop();
+        {
+            QSignalBlocker blocker(tabData->tableFilterEdit);
+            tabData->tableFilterEdit->clear();
+        }
+        startTabQuery(tabData, query, false);
     } catch (const std::exception &e) {
         qCritical() << "FileTabManager::executeQuery exception:" << e.what();
         QMessageBox::critical(this, tr("Error"), tr("Query execution failed: %1").arg(e.what()));
@@ -489,87 +650,1218 @@ void FileTabManager::clearCurrentTab()
     tabData->sqlEditor->clear();
     tabData->resultsModel->clear();
     tabData->chartManager->clearCharts();
-    updatePaginationControls(tabData);
+    updateRowInfo(tabData);
 }
 
-void FileTabManager::onTabChanged(int index)
+void FileTabManager::buildLookupIndex()
 {
-    if (index >= 0 && index < m_tabData.size()) {
-        emit tabChanged(m_tabData[index]->filePath);
+    FileTabData *tabData = getCurrentTabData();
+    if (!tabData || !tabData->dbManager) {
+        return;
+    }
+
+    if (tabData->sqlExecutor && tabData->sqlExecutor->isExecuting()) {
+        QMessageBox::warning(this, tr("Build Lookup Index"),
+                             tr("Wait for the running query to finish before building an index."));
+        return;
+    }
+    if (tabData->indexTask->isRunning()) {
+        QMessageBox::warning(this, tr("Build Lookup Index"), tr("An index is already being built for this tab."));
+        return;
+    }
+
+    QString tableName = tabData->dbManager->getLastLoadedTableName();
+    QStringList columns = tabData->dbManager->getTableColumns(tableName);
+    if (columns.isEmpty()) {
+        QMessageBox::warning(this, tr("Build Lookup Index"),
+                             tr("No columns found for table \"%1\"").arg(tableName));
+        return;
+    }
+
+    bool ok = false;
+    QString keyText = QInputDialog::getText(
+        this,
+        tr("Build Lookup Index"),
+        tr("Key columns for \"%1\" (comma-separated).\nAvailable: %2")
+            .arg(tableName, columns.join(", ")),
+        QLineEdit::Normal,
+        columns.first(),
+        &ok
+    );
+    if (!ok || keyText.trimmed().isEmpty()) {
+        return;
+    }
+
+    QStringList keyColumns;
+    for (const QString &part : keyText.split(',', Qt::SkipEmptyParts)) {
+        QString column = part.trimmed();
+        if (!columns.contains(column)) {
+            QMessageBox::warning(this, tr("Build Lookup Index"),
+                                 tr("Unknown column: %1").arg(column));
+            return;
+        }
+        keyColumns.append(column);
     }
+
+    emit executionProgress(tr("Building lookup index on %1...").arg(tableName));
+
+    // Sorting and indexing a large table takes a while; the grid stays usable meanwhile
+    std::shared_ptr<DuckDBManager> dbManager = tabData->dbManager;
+    auto result = std::make_shared<DuckDBManager::IndexBuildResult>();
+    disconnect(tabData->indexTask, &BackgroundTask::finished, nullptr, nullptr);
+    connect(tabData->indexTask, &BackgroundTask::finished, tabData->resultsTableView, [this, result](bool cancelled) {
+        if (cancelled) {
+            return;
+        }
+        if (!result->success) {
+            emit executionProgress(tr("Lookup index build failed"));
+            QMessageBox::critical(this, tr("Build Lookup Index"), result->error);
+            return;
+        }
+
+        QString summary = tr("Sorted and indexed \"%1\" on (%2) in %3 ms")
+                              .arg(result->tableName, result->keyColumns.join(", "))
+                              .arg(result->buildTimeMs);
+        QString details = summary;
+        if (result->scanLookupUs >= 0 && result->indexedLookupUs >= 0) {
+            double speedup = double(result->scanLookupUs) / qMax<qint64>(1, result->indexedLookupUs);
+            details += tr("\n\nSample point lookup: %1 µs before, %2 µs indexed (%3x faster)")
+                           .arg(result->scanLookupUs)
+                           .arg(result->indexedLookupUs)
+                           .arg(speedup, 0, 'f', 1);
+        }
+
+        emit executionProgress(summary);
+        QMessageBox::information(this, tr("Lookup Index Built"), details);
+    });
+    tabData->indexTask->start([dbManager, tableName, keyColumns, result](BackgroundTask::Control &) {
+        *result = dbManager->buildLookupIndex(tableName, keyColumns);
+    });
 }
 
-void FileTabManager::onTabCloseRequested(int index)
+void FileTabManager::exportCurrentQuery()
 {
-    closeFileTab(index);
+    FileTabData *tabData = getCurrentTabData();
+    if (!tabData || !tabData->queryExporter) {
+        return;
+    }
+
+    QString query = tabData->sqlEditor->toPlainText();
+    if (query.trimmed().isEmpty()) {
+        QMessageBox::warning(this, tr("Export Query"), tr("Please enter a SQL query."));
+        return;
+    }
+
+    if (query == tabData->baseQuery) {
+        query = resultSourceQuery(tabData);
+    }
+
+    exportQuery(tabData, query);
 }
 
-void FileTabManager::onFirstPage()
+void FileTabManager::exportQuery(FileTabData *tabData, const QString &query)
 {
-    FileTabData *tabData = getCurrentTabData();
-    if (tabData) {
-        tabData->resultsModel->setCurrentPage(0);
-        updatePaginationControls(tabData);
+    QueryExporter *exporter = tabData->queryExporter.get();
+    if (!exporter) {
+        return;
+    }
+    if (exporter->isRunning()) {
+        QMessageBox::warning(this, tr("Export Query"), tr("An export is already running for this tab."));
+        return;
     }
+
+    // Column names let the dialog offer PARTITION_BY choices. Binding the query can still wait
+    // on the file, so they fill in once DESCRIBE returns.
+    ExportDialog dialog(tabData->filePath, this);
+    std::shared_ptr<DuckDBManager> dbManager = tabData->dbManager;
+    auto columns = std::make_shared<QStringList>();
+    BackgroundTask *describeTask = new BackgroundTask(&dialog);
+    connect(describeTask, &BackgroundTask::finished, &dialog, [&dialog, columns](bool cancelled) {
+        if (!cancelled) {
+            dialog.setColumns(*columns);
+        }
+    });
+    describeTask->start([dbManager, query, columns](BackgroundTask::Control &) {
+        *columns = dbManager->describeQuery(query);
+    });
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+
+    QueryExporter::Options options = dialog.options();
+    QString fileName = options.filePath;
+
+    QProgressDialog *progressDialog = createTaskProgressDialog(
+        tr("Export Query"), tr("Exporting to %1...").arg(QFileInfo(fileName).fileName()));
+
+    connect(progressDialog, &QProgressDialog::canceled, exporter, &QueryExporter::cancel);
+    connect(exporter, &QueryExporter::progress, progressDialog, [progressDialog](double percent, const QString &status) {
+        updateTaskProgress(progressDialog, percent, status);
+    });
+    connect(exporter, &QueryExporter::finished, progressDialog, [this, exporter, progressDialog](const QueryExporter::Summary &summary) {
+        disconnect(exporter, nullptr, progressDialog, nullptr);
+        progressDialog->close();
+        progressDialog->deleteLater();
+
+        if (summary.cancelled) {
+            emit executionProgress(tr("Export cancelled"));
+            QMessageBox::information(this, tr("Export Cancelled"),
+                                     tr("The export was cancelled. %1 may be incomplete.").arg(summary.filePath));
+            return;
+        }
+        if (!summary.success) {
+            emit executionProgress(tr("Export failed"));
+            QMessageBox::warning(this, tr("Export Failed"),
+                                 tr("Failed to export results to %1:\n%2").arg(summary.filePath, summary.error));
+            return;
+        }
+
+        QString message = tr("Exported %1 rows (%2 in %3 file(s)) to %4 in %5 s\n%6 rows/s, %7 MB/s")
+                              .arg(QLocale().toString(summary.rowsWritten),
+                                   QueryExporter::formatBytes(summary.bytesWritten),
+                                   QString::number(summary.filesWritten),
+                                   summary.filePath,
+                                   QString::number(summary.elapsedMs / 1000.0, 'f', 2),
+                                   QLocale().toString(qRound64(summary.rowsPerSecond())),
+                                   QString::number(summary.megabytesPerSecond(), 'f', 1));
+        emit executionProgress(tr("Exported %1 rows to %2").arg(summary.rowsWritten).arg(summary.filePath));
+        QMessageBox::information(this, tr("Export Successful"), message);
+    });
+
+    emit executionProgress(tr("Exporting query results to %1...").arg(fileName));
+    exporter->exportQuery(query, options);
 }
 
-void FileTabManager::onPreviousPage()
+void FileTabManager::copySelectedRows()
 {
     FileTabData *tabData = getCurrentTabData();
-    if (tabData) {
-        int currentPage = tabData->resultsModel->getCurrentPage();
-        if (currentPage > 0) {
-            tabData->resultsModel->setCurrentPage(currentPage - 1);
-            updatePaginationControls(tabData);
+    if (!tabData || !tabData->resultsModel || !tabData->resultsTableView) {
+        return;
+    }
+
+    // Work on selection ranges rather than per-row indexes, which could number in the millions
+    QList<QPair<qint64, qint64>> ranges;
+    const QItemSelection selection = tabData->resultsTableView->selectionModel()->selection();
+    for (const QItemSelectionRange &range : selection) {
+        ranges.append(qMakePair(qint64(range.top()), qint64(range.bottom())));
+    }
+    if (ranges.isEmpty()) {
+        QMessageBox::information(this, tr("Copy Rows"), tr("Select one or more result rows to copy."));
+        return;
+    }
+
+    std::sort(ranges.begin(), ranges.end());
+    QList<QPair<qint64, qint64>> merged;
+    for (const auto &range : std::as_const(ranges)) {
+        if (!merged.isEmpty() && range.first <= merged.last().second + 1) {
+            merged.last().second = qMax(merged.last().second, range.second);
+        } else {
+            merged.append(range);
+        }
+    }
+
+    // Rows are selected whole, so the copy covers the selected rows across the visible columns
+    ResultsTableModel *model = tabData->resultsModel.get();
+    QStringList columns;
+    QList<int> columnIndexes;
+    for (int column = 0; column < model->getColumnNames().size(); ++column) {
+        if (!model->isColumnHidden(column)) {
+            columns.append(model->getColumnNames().at(column));
+            columnIndexes.append(column);
         }
     }
+    if (columnIndexes.size() == model->getColumnNames().size()) {
+        columnIndexes.clear();
+    }
+
+    std::shared_ptr<DuckDBManager::SpillFile> spill = tabData->resultsModel->getSpillFile();
+    if (spill) {
+        // Spilled rows are mostly not in memory; let DuckDB read the selected ranges from the file
+        if (tabData->resultsModel->isReversed()) {
+            // View row r of a reversed result is spill row T-1-r
+            const qint64 lastRow = tabData->resultsModel->getTotalRows() - 1;
+            for (auto &range : merged) {
+                range = qMakePair(lastRow - range.second, lastRow - range.first);
+            }
+        }
+        QString query = DuckDBManager::spillRangesQuery(*spill, merged, tabData->resultsModel->isReversed(),
+                                                        columnIndexes.isEmpty() ? QStringList() : columns);
+        startClipboardCopy(tabData, [query](ClipboardCopier *copier) {
+            copier->copyQuery(query);
+        }, [this, tabData, query]() {
+            exportQuery(tabData, query);
+        });
+        return;
+    }
+
+    // The copier looks the rows up on its own thread, in on-screen order (bottom-up when the
+    // model is reversed), so a large selection costs the GUI thread nothing here
+    ClipboardCopier::RowSelection selection;
+    selection.compressed = model->compressedResult();
+    if (!selection.compressed) {
+        selection.rows = model->allRows();
+    }
+    selection.ranges = merged;
+    selection.reversed = model->isReversed();
+    selection.columnIndexes = columnIndexes;
+
+    // In-memory rows may come from a query that is not cheap (or not stable) to re-run, so the
+    // fallback writes the rows already held rather than exporting the query again
+    startClipboardCopy(tabData, [columns, selection](ClipboardCopier *copier) {
+        copier->copyRows(columns, selection);
+    }, [this, tabData, columns, selection]() {
+        saveRowsToFile(tabData, columns, selection);
+    });
 }
 
-void FileTabManager::onNextPage()
+void FileTabManager::copyAllRows()
 {
     FileTabData *tabData = getCurrentTabData();
-    if (tabData) {
-        int currentPage = tabData->resultsModel->getCurrentPage();
-        int totalPages = tabData->resultsModel->getTotalPages();
-        if (currentPage < totalPages - 1) {
-            tabData->resultsModel->setCurrentPage(currentPage + 1);
-            updatePaginationControls(tabData);
+    if (!tabData) {
+        return;
+    }
+
+    if (tabData->lastQuery.trimmed().isEmpty()) {
+        QMessageBox::information(this, tr("Copy Rows"), tr("Run a query first."));
+        return;
+    }
+
+    // Go through COPY so the clipboard gets every row, not just what the grid loaded
+    QString query = resultSourceQuery(tabData);
+    startClipboardCopy(tabData, [query](ClipboardCopier *copier) {
+        copier->copyQuery(query);
+    }, [this, tabData, query]() {
+        exportQuery(tabData, query);
+    });
+}
+
+void FileTabManager::saveRowsToFile(FileTabData *tabData, const QStringList &columns,
+                                    const ClipboardCopier::RowSelection &selection)
+{
+    QString filePath = QFileDialog::getSaveFileName(this, tr("Save Selected Rows"), QString(),
+                                                    tr("Tab-separated values (*.tsv);;All Files (*)"));
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    startClipboardCopy(tabData, [columns, selection, filePath](ClipboardCopier *copier) {
+        copier->saveRows(columns, selection, filePath);
+    }, nullptr);
+}
+
+void FileTabManager::startClipboardCopy(FileTabData *tabData, const std::function<void(ClipboardCopier*)> &start,
+                                        const std::function<void()> &fallback)
+{
+    ClipboardCopier *copier = tabData->clipboardCopier.get();
+    if (!copier) {
+        return;
+    }
+    if (copier->isRunning()) {
+        QMessageBox::warning(this, tr("Copy Rows"), tr("A copy is already running for this tab."));
+        return;
+    }
+
+    QProgressDialog *progressDialog = createTaskProgressDialog(tr("Copy Rows"), tr("Copying rows..."));
+
+    connect(progressDialog, &QProgressDialog::canceled, copier, &ClipboardCopier::cancel);
+    connect(copier, &ClipboardCopier::progress, progressDialog, [progressDialog](double percent, const QString &status) {
+        updateTaskProgress(progressDialog, percent, status);
+    });
+    connect(copier, &ClipboardCopier::finished, progressDialog, [this, copier, progressDialog, fallback](const ClipboardCopier::Result &result) {
+        disconnect(copier, nullptr, progressDialog, nullptr);
+        progressDialog->close();
+        progressDialog->deleteLater();
+
+        if (result.cancelled) {
+            emit executionProgress(tr("Copy cancelled"));
+            return;
         }
+        if (result.exceededLimit) {
+            emit executionProgress(tr("Copy exceeds the clipboard limit"));
+            QMessageBox::StandardButton answer = QMessageBox::question(
+                this, tr("Copy Rows"),
+                tr("The rows are larger than the %1 clipboard limit.\n\nSave them to a file instead?")
+                    .arg(QueryExporter::formatBytes(ClipboardCopier::MAX_CLIPBOARD_BYTES)));
+            if (answer == QMessageBox::Yes && fallback) {
+                fallback();
+            }
+            return;
+        }
+        if (!result.success) {
+            emit executionProgress(tr("Copy failed"));
+            QMessageBox::warning(this, tr("Copy Failed"), result.error);
+            return;
+        }
+
+        if (!result.filePath.isEmpty()) {
+            emit executionProgress(tr("Saved %1 rows (%2) to %3")
+                                       .arg(result.rowsCopied)
+                                       .arg(QueryExporter::formatBytes(result.bytes))
+                                       .arg(result.filePath));
+            return;
+        }
+
+        QApplication::clipboard()->setText(result.text);
+        emit executionProgress(tr("Copied %1 rows (%2) in %3 ms")
+                                   .arg(result.rowsCopied)
+                                   .arg(QueryExporter::formatBytes(result.bytes))
+                                   .arg(result.elapsedMs));
+    });
+
+    start(copier);
+}
+
+QProgressDialog* FileTabManager::createTaskProgressDialog(const QString &title, const QString &label)
+{
+    QProgressDialog *progressDialog = new QProgressDialog(label, tr("Cancel"), 0, 100, this);
+    progressDialog->setWindowTitle(title);
+    progressDialog->setWindowModality(Qt::WindowModal);
+    progressDialog->setMinimumDuration(0);
+    progressDialog->setAutoClose(false);
+    progressDialog->setAutoReset(false);
+    progressDialog->setValue(0);
+    return progressDialog;
+}
+
+void FileTabManager::updateTaskProgress(QProgressDialog *progressDialog, double percent, const QString &status)
+{
+    // DuckDB reports -1 when it cannot estimate progress; show a busy indicator instead
+    if (percent < 0) {
+        progressDialog->setRange(0, 0);
+    } else {
+        progressDialog->setRange(0, 100);
+        progressDialog->setValue(qBound(0, int(percent), 100));
+    }
+    if (!status.isEmpty()) {
+        progressDialog->setLabelText(status);
     }
 }
 
-void FileTabManager::onLastPage()
+void FileTabManager::benchmarkScrolling()
 {
     FileTabData *tabData = getCurrentTabData();
-    if (tabData) {
-        int totalPages = tabData->resultsModel->getTotalPages();
-        if (totalPages > 0) {
-            tabData->resultsModel->setCurrentPage(totalPages - 1);
-            updatePaginationControls(tabData);
+    if (!tabData || !tabData->resultsTableView) {
+        return;
+    }
+
+    QTableView *view = tabData->resultsTableView;
+    if (tabData->resultsModel->rowCount() == 0) {
+        QMessageBox::information(this, tr("Scroll Benchmark"), tr("Run a query first."));
+        return;
+    }
+
+    // Scroll half a page per frame and paint synchronously, so the time covers data() and painting
+    QScrollBar *scrollBar = view->verticalScrollBar();
+    int startValue = scrollBar->value();
+    int step = qMax(1, scrollBar->pageStep() / 2);
+    qint64 worstFrameUs = 0;
+
+    QElapsedTimer total;
+    total.start();
+    for (int frame = 0; frame < SCROLL_BENCHMARK_FRAMES; ++frame) {
+        QElapsedTimer frameTimer;
+        frameTimer.start();
+        int next = scrollBar->value() + step;
+        scrollBar->setValue(next > scrollBar->maximum() ? 0 : next);
+        view->viewport()->repaint();
+        worstFrameUs = qMax(worstFrameUs, frameTimer.nsecsElapsed() / 1000);
+    }
+    qint64 elapsedUs = qMax<qint64>(1, total.nsecsElapsed() / 1000);
+    scrollBar->setValue(startValue);
+
+    double fps = SCROLL_BENCHMARK_FRAMES * 1000000.0 / elapsedUs;
+    QString summary = tr("Scroll benchmark: %1 frames/s over %2 frames (%3 columns), worst frame %4 ms")
+                          .arg(QString::number(fps, 'f', 1),
+                               QString::number(SCROLL_BENCHMARK_FRAMES),
+                               QString::number(tabData->resultsModel->columnCount()),
+                               QString::number(worstFrameUs / 1000.0, 'f', 1));
+    emit executionProgress(summary);
+    QMessageBox::information(this, tr("Scroll Benchmark"), summary);
+}
+
+void FileTabManager::onTabChanged(int index)
+{
+    if (index >= 0 && index < m_tabData.size() && m_tabData[index]->hibernated) {
+        restoreTab(m_tabData[index]);
+    }
+
+    // Tabs in the background keep their results compressed; the active one decompresses
+    // pages as the grid reaches them
+    for (int i = 0; i < m_tabData.size(); ++i) {
+        FileTabData *tabData = m_tabData[i];
+        if (tabData->hibernated) {
+            continue;
+        }
+        if (i == index) {
+            tabData->idleTimer.invalidate();
+            tabData->compressTask->cancel();
+            tabData->hibernateTask->cancel();
+        } else {
+            if (!tabData->idleTimer.isValid()) {
+                tabData->idleTimer.start();
+            }
+            compressTabResults(tabData);
+        }
+    }
+
+    if (index >= 0 && index < m_tabData.size()) {
+        emit tabChanged(m_tabData[index]->filePath);
+    }
+}
+
+void FileTabManager::compressTabResults(FileTabData *tabData)
+{
+    // The chart cache is shared by every tab; one in the background gives up its prepared charts
+    tabData->chartManager->releaseCachedData();
+
+    ResultsTableModel *model = tabData->resultsModel.get();
+    if (model->isCompressed()) {
+        // Rows decompressed for charts while the tab was on screen are dropped again
+        std::shared_ptr<CompressedResult> compressed = model->compressedResult();
+        if (compressed->hasRows()) {
+            tabData->chartManager->compactData(compressed->rows(), compressed);
+            compressed->releaseRows();
+        }
+        return;
+    }
+    if (model->isSpilled() || model->getTotalRows() < COMPRESS_MIN_ROWS ||
+        tabData->compressTask->isRunning() || tabData->snapshotTask->isRunning()) {
+        return;
+    }
+
+    auto rows = std::make_shared<QList<QVariantList>>(model->allRows());
+    auto compressed = std::make_shared<std::shared_ptr<CompressedResult>>();
+    const int columnCount = static_cast<int>(model->getColumnNames().size());
+    disconnect(tabData->compressTask, &BackgroundTask::finished, nullptr, nullptr);
+    connect(tabData->compressTask, &BackgroundTask::finished, tabData->resultsTableView,
+            [this, tabData, rows, compressed](bool cancelled) {
+        ResultsTableModel *model = tabData->resultsModel.get();
+        // The tab may have been activated, or shown a new result, while this ran
+        if (!cancelled && *compressed && tabData != getCurrentTabData() &&
+            model->allRows().constData() == rows->constData()) {
+            tabData->chartManager->compactData(*rows, *compressed);
+            model->setCompressed(*compressed);
+            updateRowInfo(tabData);
+        }
+        BackgroundTask::release(std::make_shared<QList<QVariantList>>(std::move(*rows)));
+        rows->clear();
+        compressed->reset();
+    });
+    tabData->compressTask->start([rows, columnCount, compressed](BackgroundTask::Control &control) {
+        *compressed = CompressedResult::compress(*rows, columnCount, [&control]() {
+            return control.isCancelled();
+        });
+    });
+}
+
+bool FileTabManager::isTabBusy(FileTabData *tabData) const
+{
+    return tabData->sqlExecutor->isExecuting() || !tabData->pendingQuery.isEmpty() ||
+           tabData->filterTimer->isActive() || tabData->queryExporter->isRunning() ||
+           tabData->clipboardCopier->isRunning() || tabData->snapshotTask->isRunning() ||
+           tabData->compressTask->isRunning() || tabData->hibernateTask->isRunning() ||
+           tabData->indexTask->isRunning() || tabData->describeTask->isRunning() ||
+           !tabData->resultsTableView->findChildren<QDialog*>().isEmpty();
+}
+
+void FileTabManager::hibernateIdleTabs()
+{
+    FileTabData *current = getCurrentTabData();
+    for (FileTabData *tabData : std::as_const(m_tabData)) {
+        if (tabData == current || tabData->hibernated || !tabData->idleTimer.isValid() ||
+            tabData->idleTimer.elapsed() < HIBERNATE_IDLE_MS || isTabBusy(tabData)) {
+            continue;
+        }
+        // Restoring only loads the file again, so a session with its own tables, views, macros,
+        // indexes or settings stays loaded rather than lose them
+        if (tabData->dbManager->hasSessionChanges()) {
+            continue;
+        }
+        hibernateTab(tabData);
+    }
+}
+
+void FileTabManager::hibernateTab(FileTabData *tabData)
+{
+    // A spilled result is already on disk. Rows held in memory are written out by running the
+    // tab's query again through COPY, which keeps every column's type; hibernateIdleTabs() only
+    // gets here while the session is as loaded, so the query still gives the same rows.
+    ResultsTableModel *model = tabData->resultsModel.get();
+    if (model->isSpilled() || model->getColumnNames().isEmpty()) {
+        releaseTab(tabData, model->getSpillFile(), model->isReversed());
+        return;
+    }
+    if (tabData->lastQuery.trimmed().isEmpty()) {
+        return;
+    }
+
+    std::shared_ptr<DuckDBManager> dbManager = tabData->dbManager;
+    const quint64 resultId = model->resultId();
+    // lastQuery already carries the grid's sort, so the snapshot holds the rows in on-screen order
+    const QString query = tabData->lastQuery;
+    auto snapshot = std::make_shared<DuckDBManager::QueryResult>();
+    disconnect(tabData->hibernateTask, &BackgroundTask::finished, nullptr, nullptr);
+    connect(tabData->hibernateTask, &BackgroundTask::finished, tabData->resultsTableView,
+            [this, tabData, resultId, snapshot](bool cancelled) {
+        if (cancelled) {
+            return;
+        }
+        // Released from the event loop: the task is deleted along with the tab's widgets
+        QMetaObject::invokeMethod(this, [this, tabData, resultId, snapshot]() {
+            // The tab may have been closed, activated or given new work while the snapshot was written
+            if (!m_tabData.contains(tabData) || tabData->hibernated || tabData == getCurrentTabData() ||
+                tabData->resultsModel->resultId() != resultId || isTabBusy(tabData)) {
+                return;
+            }
+            // A session changed in the meantime keeps the tab resident
+            if (!snapshot->success) {
+                qWarning() << "Not hibernating" << tabData->fileName << ":" << snapshot->error;
+                tabData->idleTimer.start();
+                return;
+            }
+            releaseTab(tabData, snapshot->spill, false);
+        }, Qt::QueuedConnection);
+    });
+    tabData->hibernateTask->start([dbManager, query, snapshot](BackgroundTask::Control &) {
+        *snapshot = dbManager->snapshotQuery(query);
+    });
+}
+
+void FileTabManager::releaseTab(FileTabData *tabData, const std::shared_ptr<DuckDBManager::SpillFile> &snapshot,
+                                bool reversed)
+{
+    const int index = m_tabData.indexOf(tabData);
+    if (index < 0) {
+        return;
+    }
+
+    ResultsTableModel *model = tabData->resultsModel.get();
+    QTableView *view = tabData->resultsTableView;
+    auto state = std::make_unique<HibernatedTab>();
+    state->sqlText = tabData->sqlEditor->toPlainText();
+    state->filterText = tabData->tableFilterEdit->text();
+    state->verticalScroll = view->verticalScrollBar()->value();
+    state->horizontalScroll = view->horizontalScrollBar()->value();
+    if (snapshot) {
+        state->snapshot = snapshot;
+        state->columnNames = model->getColumnNames();
+        state->columnTypes = model->getColumnTypes();
+        state->reversed = reversed;
+        state->hiddenColumns = model->hiddenColumns();
+        state->sortMarkers = model->sortMarkers();
+    }
+
+    QWidget *page = m_tabWidget->widget(index);
+    QLabel *placeholder = new QLabel(tr("%1 was hibernated to free memory.\n"
+                                        "Its query and results come back when the tab is selected.")
+                                         .arg(tabData->fileName));
+    placeholder->setAlignment(Qt::AlignCenter);
+    {
+        // Swapping the page must not look like a tab change
+        QSignalBlocker blocker(m_tabWidget);
+        const QString title = m_tabWidget->tabText(index);
+        m_tabWidget->removeTab(index);
+        m_tabWidget->insertTab(index, placeholder, title);
+    }
+
+    // Deleting the page detaches the tasks parented to its widgets; runs still reading the database
+    // hold their own reference to it. The chart manager and its charts go with the page.
+    delete page;
+    tabData->chartManager = nullptr;
+    tabData->sqlEditor = nullptr;
+    tabData->resultsTableView = nullptr;
+    tabData->tableFilterEdit = nullptr;
+    tabData->cancelQueryButton = nullptr;
+    tabData->rowRangeLabel = nullptr;
+    tabData->rowCountLabel = nullptr;
+    tabData->profilePanel = nullptr;
+    tabData->profileStatusLabel = nullptr;
+    tabData->profileTable = nullptr;
+    tabData->rowDetailPanel = nullptr;
+    tabData->rowDetailTable = nullptr;
+    tabData->rowDetailTask = nullptr;
+    tabData->snapshotTask = nullptr;
+    tabData->compressTask = nullptr;
+    tabData->hibernateTask = nullptr;
+    tabData->indexTask = nullptr;
+    tabData->describeTask = nullptr;
+    tabData->filterTimer = nullptr;
+
+    // The database closes once background runs still holding it finish, possibly on a pool thread
+    tabData->columnProfiler.reset();
+    tabData->clipboardCopier.reset();
+    tabData->queryExporter.reset();
+    tabData->sqlExecutor.reset();
+    tabData->resultsModel.reset();
+    tabData->dbManager.reset();
+
+    tabData->hibernated = std::move(state);
+    tabData->idleTimer.invalidate();
+}
+
+void FileTabManager::restoreTab(FileTabData *tabData)
+{
+    const int index = m_tabData.indexOf(tabData);
+    if (index < 0 || tabData->hibernated->restoreTask) {
+        return;
+    }
+
+    // Reading the file can take as long as it did the first time, so it loads in the background
+    // while the placeholder stays up
+    QLabel *placeholder = qobject_cast<QLabel*>(m_tabWidget->widget(index));
+    if (placeholder) {
+        placeholder->setText(tr("Reloading %1...").arg(tabData->fileName));
+    }
+    emit executionProgress(tr("Restoring %1...").arg(tabData->fileName));
+
+    auto dbManager = std::make_shared<DuckDBManager>();
+    auto loaded = std::make_shared<bool>(false);
+    const QString filePath = tabData->filePath;
+    BackgroundTask *task = new BackgroundTask(m_tabWidget->widget(index));
+    tabData->hibernated->restoreTask = task;
+    connect(task, &BackgroundTask::finished, task, [this, tabData, task, dbManager, loaded](bool cancelled) {
+        task->deleteLater();
+        if (!m_tabData.contains(tabData) || !tabData->hibernated || tabData->hibernated->restoreTask != task) {
+            return;
+        }
+        tabData->hibernated->restoreTask = nullptr;
+        if (cancelled || !*loaded) {
+            if (QLabel *placeholder = qobject_cast<QLabel*>(m_tabWidget->widget(m_tabData.indexOf(tabData)))) {
+                placeholder->setText(tr("%1 could not be reloaded.\nSelect another tab and back to try again.")
+                                         .arg(tabData->fileName));
+            }
+            if (!cancelled) {
+                emit executionProgress(tr("Failed to restore %1").arg(tabData->fileName));
+                QMessageBox::critical(this, tr("Error"), tr("Failed to reload file: %1\n%2")
+                                                             .arg(tabData->filePath, dbManager->getLastError()));
+            }
+            return;
+        }
+        finishRestoreTab(tabData, dbManager);
+    });
+    task->start([dbManager, filePath, loaded](BackgroundTask::Control &) {
+        *loaded = dbManager->loadFile(filePath);
+    });
+}
+
+void FileTabManager::finishRestoreTab(FileTabData *tabData, std::shared_ptr<DuckDBManager> dbManager)
+{
+    const int index = m_tabData.indexOf(tabData);
+    attachTabDatabase(tabData, std::move(dbManager));
+
+    std::unique_ptr<HibernatedTab> state = std::move(tabData->hibernated);
+    QWidget *page = createFileTabWidget(tabData);
+    QWidget *placeholder = m_tabWidget->widget(index);
+    // The user may have moved to another tab while the file loaded
+    const bool isCurrent = m_tabWidget->currentIndex() == index;
+    {
+        QSignalBlocker blocker(m_tabWidget);
+        const QString title = m_tabWidget->tabText(index);
+        m_tabWidget->removeTab(index);
+        m_tabWidget->insertTab(index, page, title);
+        if (isCurrent) {
+            m_tabWidget->setCurrentIndex(index);
         }
     }
+    // Its restore task is still delivering the signal that got us here
+    placeholder->deleteLater();
+
+    tabData->sqlEditor->setPlainText(state->sqlText);
+    {
+        QSignalBlocker blocker(tabData->tableFilterEdit);
+        tabData->tableFilterEdit->setText(state->filterText);
+    }
+
+    ResultsTableModel *model = tabData->resultsModel.get();
+    QTableView *view = tabData->resultsTableView;
+    if (state->snapshot) {
+        // The grid reads the snapshot back a chunk at a time, like any spilled result
+        DuckDBManager::QueryResult results;
+        results.success = true;
+        results.columnNames = state->columnNames;
+        results.columnTypes = state->columnTypes;
+        results.totalRows = state->snapshot->rowCount;
+        results.spill = state->snapshot;
+        model->setSnapshot(ResultsTableModel::prepareSnapshot(results));
+        model->setReversed(state->reversed);
+        model->setSortMarkers(state->sortMarkers);
+        for (int column : std::as_const(state->hiddenColumns)) {
+            model->setColumnHidden(column, true);
+            view->setColumnHidden(column, true);
+        }
+    }
+    updateSortIndicator(tabData);
+    updateRowInfo(tabData);
+
+    // Scroll ranges are only known once the view has laid out the restored rows
+    const int verticalScroll = state->verticalScroll;
+    const int horizontalScroll = state->horizontalScroll;
+    QTimer::singleShot(0, view, [view, verticalScroll, horizontalScroll]() {
+        view->verticalScrollBar()->setValue(verticalScroll);
+        view->horizontalScrollBar()->setValue(horizontalScroll);
+    });
+
+    startColumnProfile(tabData);
+    emit executionProgress(tr("Restored %1").arg(tabData->fileName));
+    if (isCurrent) {
+        emit tabChanged(tabData->filePath);
+    } else {
+        tabData->idleTimer.start();
+    }
+}
+
+void FileTabManager::onTabCloseRequested(int index)
+{
+    closeFileTab(index);
 }
 
-void FileTabManager::updatePaginationControls(FileTabData *tabData)
+void FileTabManager::updateRowInfo(FileTabData *tabData)
 {
     if (!tabData) return;
     
-    int currentPage = tabData->resultsModel->getCurrentPage();
-    int totalPages = tabData->resultsModel->getTotalPages();
-    int totalRows = tabData->resultsModel->getTotalRows();
+    qint64 totalRows = tabData->resultsModel->getTotalRows();
+    int shownRows = tabData->resultsModel->rowCount();
+    QTableView *view = tabData->resultsTableView;
     
-    tabData->firstPageButton->setEnabled(currentPage > 0);
-    tabData->prevPageButton->setEnabled(currentPage > 0);
-    tabData->nextPageButton->setEnabled(currentPage < totalPages - 1);
-    tabData->lastPageButton->setEnabled(currentPage < totalPages - 1);
-    
-    if (totalPages > 0) {
-        tabData->pageInfoLabel->setText(tr("Page %1 of %2").arg(currentPage + 1).arg(totalPages));
+    if (shownRows > 0) {
+        int firstRow = qMax(0, view->rowAt(0));
+        int lastRow = view->rowAt(view->viewport()->height() - 1);
+        if (lastRow < 0) {
+            lastRow = shownRows - 1;
+        }
+        QString range = tr("Rows %1-%2 of %3")
+                            .arg(QLocale().toString(firstRow + 1),
+                                 QLocale().toString(lastRow + 1),
+                                 QLocale().toString(shownRows));
+        if (!tabData->filterPredicate.isEmpty()) {
+            range += tr(" (filtered)");
+        }
+        tabData->rowRangeLabel->setText(range);
     } else {
-        tabData->pageInfoLabel->setText("Page 0 of 0");
+        tabData->rowRangeLabel->setText(tr("No rows"));
     }
     
-    tabData->rowCountLabel->setText(tr("%1 rows").arg(totalRows));
+    if (tabData->resultsModel->isSpilled()) {
+        tabData->rowCountLabel->setText(tr("%1 rows (spilled to disk)").arg(QLocale().toString(totalRows)));
+    } else if (tabData->resultsModel->isCompressed()) {
+        std::shared_ptr<CompressedResult> compressed = tabData->resultsModel->compressedResult();
+        tabData->rowCountLabel->setText(tr("%1 rows (compressed %2 -> %3)")
+                                            .arg(QLocale().toString(totalRows),
+                                                 QLocale().formattedDataSize(compressed->rawBytes()),
+                                                 QLocale().formattedDataSize(compressed->compressedBytes())));
+    } else {
+        tabData->rowCountLabel->setText(tr("%1 rows").arg(QLocale().toString(totalRows)));
+    }
+}
+
+QString FileTabManager::resultSourceQuery(FileTabData *tabData) const
+{
+    // Re-reading a spilled result is cheaper than running the query again
+    std::shared_ptr<DuckDBManager::SpillFile> spill = tabData->resultsModel->getSpillFile();
+    if (spill) {
+        return DuckDBManager::spillScanQuery(*spill, tabData->resultsModel->isReversed());
+    }
+    return tabData->lastQuery;
+}
+
+void FileTabManager::sortResults(FileTabData *tabData, int column, bool addToSort)
+{
+    if (!tabData || !tabData->sqlExecutor || column < 0 || tabData->baseQuery.trimmed().isEmpty()) {
+        updateSortIndicator(tabData);
+        return;
+    }
+    QList<QPair<int, Qt::SortOrder>> sortColumns = tabData->sortColumns;
+    int existing = -1;
+    for (int i = 0; i < sortColumns.size(); ++i) {
+        if (sortColumns[i].first == column) {
+            existing = i;
+            break;
+        }
+    }
+
+    auto flipped = [](Qt::SortOrder order) {
+        return order == Qt::AscendingOrder ? Qt::DescendingOrder : Qt::AscendingOrder;
+    };
+
+    bool reverseOnly = false;
+    if (addToSort) {
+        if (existing >= 0) {
+            sortColumns[existing].second = flipped(sortColumns[existing].second);
+            reverseOnly = sortColumns.size() == 1;
+        } else {
+            sortColumns.append(qMakePair(column, Qt::AscendingOrder));
+        }
+    } else if (existing >= 0 && sortColumns.size() == 1) {
+        sortColumns[0].second = flipped(sortColumns[0].second);
+        reverseOnly = true;
+    } else {
+        sortColumns = {qMakePair(column, Qt::AscendingOrder)};
+    }
+
+    // Only the result on screen can be reversed; it may lag the keys while a query runs
+    reverseOnly = reverseOnly && !tabData->sqlExecutor->isExecuting() && !tabData->snapshotTask->isRunning() &&
+                  resultQuery(tabData, tabData->sortColumns) == tabData->lastQuery;
+    tabData->sortColumns = sortColumns;
+
+    if (reverseOnly) {
+        // ASC NULLS LAST reversed is exactly DESC NULLS FIRST, so flip the rows already fetched
+        // instead of sorting the full result again
+        tabData->lastQuery = resultQuery(tabData, sortColumns);
+        tabData->resultsModel->setReversed(!tabData->resultsModel->isReversed());
+        tabData->resultsModel->setSortMarkers(sortColumns);
+        updateSortIndicator(tabData);
+        updateRowInfo(tabData);
+        return;
+    }
+
+    updateSortIndicator(tabData);
+    emit executionProgress(tr("Sorting results..."));
+    startTabQuery(tabData, resultQuery(tabData, sortColumns), true);
+}
+
+void FileTabManager::applyFilter(FileTabData *tabData)
+{
+    if (!tabData || !tabData->sqlExecutor || tabData->baseQuery.trimmed().isEmpty()) {
+        return;
+    }
+
+    QString text = tabData->tableFilterEdit->text();
+    if (!text.trimmed().isEmpty() && tabData->columnNames.isEmpty()) {
+        // Binding the query is only needed once per query, but it can still wait on the file
+        describeFilterColumns(tabData);
+        return;
+    }
+
+    QString error;
+    QString predicate = ResultFilter::compile(text, tabData->columnNames, tabData->columnTypes, &error);
+    if (!error.isEmpty()) {
+        emit executionProgress(tr("Filter not applied: %1").arg(error));
+        return;
+    }
+    if (predicate == tabData->filterPredicate) {
+        return;
+    }
+
+    tabData->filterPredicate = predicate;
+    emit executionProgress(predicate.isEmpty() ? tr("Clearing filter...") : tr("Filtering results..."));
+    startTabQuery(tabData, resultQuery(tabData, tabData->sortColumns), true);
+}
+
+void FileTabManager::describeFilterColumns(FileTabData *tabData)
+{
+    std::shared_ptr<DuckDBManager> dbManager = tabData->dbManager;
+    const QString query = tabData->baseQuery;
+    auto columnTypes = std::make_shared<QStringList>();
+    auto columnNames = std::make_shared<QStringList>();
+    disconnect(tabData->describeTask, &BackgroundTask::finished, nullptr, nullptr);
+    connect(tabData->describeTask, &BackgroundTask::finished, tabData->tableFilterEdit,
+            [this, tabData, query, columnNames, columnTypes](bool cancelled) {
+        if (cancelled || tabData->baseQuery != query) {
+            return;
+        }
+        if (columnNames->isEmpty()) {
+            emit executionProgress(tr("Filter not applied: the query's columns could not be read"));
+            return;
+        }
+        tabData->columnNames = *columnNames;
+        tabData->columnTypes = *columnTypes;
+        applyFilter(tabData);
+    });
+    tabData->describeTask->start([dbManager, query, columnNames, columnTypes](BackgroundTask::Control &) {
+        *columnNames = dbManager->describeQuery(query, columnTypes.get());
+    });
+}
+
+QString FileTabManager::resultQuery(FileTabData *tabData, const QList<QPair<int, Qt::SortOrder>> &sortColumns) const
+{
+    return DuckDBManager::orderedQuery(ResultFilter::apply(tabData->baseQuery, tabData->filterPredicate), sortColumns);
+}
+
+void FileTabManager::startTabQuery(FileTabData *tabData, const QString &query, bool isResultQuery)
+{
+    if (tabData->sqlExecutor->isExecuting()) {
+        // A newer sort or filter replaces the running one; anything else waits for it to finish
+        tabData->pendingQuery = query;
+        tabData->pendingIsResultQuery = isResultQuery;
+        if (tabData->resultQueryRunning) {
+            tabData->runningQuerySuperseded = true;
+            tabData->sqlExecutor->cancelExecution();
+        }
+        return;
+    }
+
+    tabData->runningQuery = query;
+    tabData->runningSortColumns = isResultQuery ? tabData->sortColumns : QList<QPair<int, Qt::SortOrder>>();
+    tabData->resultQueryRunning = isResultQuery;
+    tabData->runningQuerySuperseded = false;
+    if (tabData->cancelQueryButton) {
+        tabData->cancelQueryButton->setEnabled(true);
+    }
+    tabData->sqlExecutor->executeQuery(query);
+}
+
+void FileTabManager::showColumnMenu(FileTabData *tabData, const QPoint &pos)
+{
+    QHeaderView *header = tabData->resultsTableView->horizontalHeader();
+    ResultsTableModel *model = tabData->resultsModel.get();
+    int section = header->logicalIndexAt(pos);
+
+    QMenu menu(this);
+    if (section >= 0) {
+        QString name = model->headerData(section, Qt::Horizontal).toString();
+        QAction *hideAction = menu.addAction(tr("Hide Column \"%1\"").arg(name));
+        connect(hideAction, &QAction::triggered, this, [tabData, model, section]() {
+            // Hidden columns are left out of the SQL that fetches spilled rows
+            tabData->resultsTableView->setColumnHidden(section, true);
+            model->setColumnHidden(section, true);
+        });
+    }
+
+    QList<int> hidden = model->hiddenColumns().values();
+    std::sort(hidden.begin(), hidden.end());
+    QMenu *showMenu = menu.addMenu(tr("Show Column"));
+    showMenu->setEnabled(!hidden.isEmpty());
+    for (int column : std::as_const(hidden)) {
+        QAction *showAction = showMenu->addAction(model->getColumnNames().value(column));
+        connect(showAction, &QAction::triggered, this, [tabData, model, column]() {
+            model->setColumnHidden(column, false);
+            tabData->resultsTableView->setColumnHidden(column, false);
+        });
+    }
+    QAction *showAllAction = menu.addAction(tr("Show All Columns"));
+    showAllAction->setEnabled(!hidden.isEmpty());
+    connect(showAllAction, &QAction::triggered, this, [tabData, model, hidden]() {
+        for (int column : hidden) {
+            model->setColumnHidden(column, false);
+            tabData->resultsTableView->setColumnHidden(column, false);
+        }
+    });
+
+    menu.exec(header->mapToGlobal(pos));
+}
+
+void FileTabManager::startColumnProfile(FileTabData *tabData)
+{
+    ColumnProfiler *profiler = tabData->columnProfiler.get();
+    QString tableName = tabData->dbManager->getLastLoadedTableName();
+    if (!profiler || tableName.isEmpty()) {
+        return;
+    }
+
+    connect(profiler, &ColumnProfiler::progress, tabData->profileStatusLabel, [tabData](double, const QString &status) {
+        tabData->profileStatusLabel->setText(status);
+    });
+    connect(profiler, &ColumnProfiler::profileUpdated, this, [this, tabData]() {
+        showColumnProfile(tabData);
+    });
+    connect(profiler, &ColumnProfiler::finished, this, [this, tabData]() {
+        showColumnProfile(tabData);
+    });
+
+    profiler->profileTable(tabData->filePath, tableName);
+}
+
+void FileTabManager::showColumnProfile(FileTabData *tabData)
+{
+    const ColumnProfiler::Profile &profile = tabData->columnProfiler->profile();
+
+    QString status;
+    if (!profile.error.isEmpty()) {
+        status = tr("Profile incomplete: %1").arg(profile.error);
+    } else if (profile.complete) {
+        status = profile.fromCache ? tr("%1 rows (cached profile)").arg(QLocale().toString(profile.rowCount))
+                                   : tr("%1 rows, profiled in %2 s").arg(QLocale().toString(profile.rowCount),
+                                                                         QString::number(profile.elapsedMs / 1000.0, 'f', 2));
+    } else if (profile.rowCount >= 0) {
+        status = tr("%1 rows; Parquet statistics shown while columns are profiled...")
+                     .arg(QLocale().toString(profile.rowCount));
+    } else {
+        status = tr("Profiling columns...");
+    }
+    tabData->profileStatusLabel->setText(status);
+
+    QHash<QString, QString> tooltips;
+    QTableWidget *table = tabData->profileTable;
+    table->setRowCount(profile.columns.size());
+    for (int row = 0; row < profile.columns.size(); ++row) {
+        const ColumnProfiler::ColumnStats &stats = profile.columns[row];
+        QString nulls;
+        if (stats.nullCount >= 0) {
+            nulls = QLocale().toString(stats.nullCount);
+        }
+        QString distinct;
+        if (stats.approxDistinct >= 0) {
+            distinct = QLocale().toString(stats.approxDistinct);
+        }
+        QString quartiles;
+        if (!stats.q25.isEmpty() || !stats.q75.isEmpty()) {
+            quartiles = QString("%1 / %2").arg(stats.q25, stats.q75);
+        }
+
+        const QStringList cells = {stats.name, stats.type, stats.min, stats.max, nulls, distinct,
+                                   stats.mean, stats.q50, quartiles};
+        for (int column = 0; column < cells.size(); ++column) {
+            table->setItem(row, column, new QTableWidgetItem(cells[column]));
+        }
+        tooltips.insert(stats.name, ColumnProfiler::tooltip(stats, profile.rowCount));
+    }
+    table->resizeColumnsToContents();
+
+    tabData->resultsModel->setColumnTooltips(tooltips);
+}
+
+void FileTabManager::updateSortIndicator(FileTabData *tabData)
+{
+    if (!tabData || !tabData->resultsTableView) {
+        return;
+    }
+
+    QHeaderView *header = tabData->resultsTableView->horizontalHeader();
+    if (tabData->sortColumns.isEmpty()) {
+        header->setSortIndicator(-1, Qt::AscendingOrder);
+    } else {
+        header->setSortIndicator(tabData->sortColumns.first().first, tabData->sortColumns.first().second);
+    }
+}
+
+DuckDBManager::QueryResult FileTabManager::chartResults(FileTabData *tabData) const
+{
+    // The grid's model holds the only in-memory copy of the result
+    ResultsTableModel *model = tabData->resultsModel.get();
+    DuckDBManager::QueryResult results;
+    results.success = true;
+    results.columnNames = model->getColumnNames();
+    results.columnTypes = model->getColumnTypes();
+    results.totalRows = model->getTotalRows();
+    results.spill = model->getSpillFile();
+    // Chart workers decompress compressed pages and sample spilled results themselves;
+    // doing either here would stall the GUI thread
+    if (!model->isCompressed() && !results.isSpilled()) {
+        results.rows = model->allRows();
+    }
+    return results;
+}
+
+void FileTabManager::showRowDetails(FileTabData *tabData)
+{
+    if (!tabData->rowDetailPanel->isVisible()) {
+        return;
+    }
+
+    ResultsTableModel *model = tabData->resultsModel.get();
+    QModelIndex current = tabData->resultsTableView->currentIndex();
+    const QStringList columnNames = model->getColumnNames();
+    const qint64 row = current.isValid() ? model->resultRow(current.row()) : -1;
+
+    auto fill = [tabData, columnNames](const QVariantList &values, const QString &placeholder) {
+        QTableWidget *table = tabData->rowDetailTable;
+        table->setRowCount(columnNames.size());
+        for (int i = 0; i < columnNames.size(); ++i) {
+            table->setItem(i, 0, new QTableWidgetItem(columnNames[i]));
+            QString text = placeholder;
+            if (placeholder.isEmpty()) {
+                const QVariant value = values.value(i);
+                text = value.isNull() ? QString("<NULL>") : value.toString();
+            }
+            table->setItem(i, 1, new QTableWidgetItem(text));
+        }
+        table->resizeRowsToContents();
+    };
+
+    if (row < 0) {
+        tabData->rowDetailTask->cancel();
+        tabData->rowDetailTable->setRowCount(0);
+        return;
+    }
+
+    std::shared_ptr<DuckDBManager::SpillFile> spill = model->getSpillFile();
+    if (!spill) {
+        // In-memory results hold every value in full
+        tabData->rowDetailTask->cancel();
+        QList<QVariantList> rows = model->getRows({row});
+        fill(rows.value(0), QString());
+        return;
+    }
+
+    // Spilled rows only keep text previews; read the whole row back from the spill file
+    fill(QVariantList(), tr("Loading..."));
+    std::shared_ptr<DuckDBManager> dbManager = tabData->dbManager;
+    auto fetched = std::make_shared<DuckDBManager::QueryResult>();
+    disconnect(tabData->rowDetailTask, &BackgroundTask::finished, nullptr, nullptr);
+    connect(tabData->rowDetailTask, &BackgroundTask::finished, tabData->rowDetailPanel,
+            [tabData, fetched, fill](bool cancelled) {
+        if (cancelled) {
+            return;
+        }
+        if (!fetched->success || fetched->rows.isEmpty()) {
+            fill(QVariantList(), tr("Failed to read row: %1").arg(fetched->error));
+            return;
+        }
+        fill(fetched->rows.first(), QString());
+    });
+    tabData->rowDetailTask->start([dbManager, spill, row, fetched](BackgroundTask::Control &) {
+        *fetched = dbManager->readSpillRows(*spill, row, 1, QStringList(), 0);
+    });
+}
+
+void FileTabManager::showCellValue(FileTabData *tabData, const QModelIndex &index)
+{
+    ResultsTableModel *model = tabData->resultsModel.get();
+    if (!index.isValid()) {
+        return;
+    }
+
+    const qint64 row = model->resultRow(index.row());
+    const int column = index.column();
+    const QString columnName = model->getColumnNames().value(column);
+    const QVariant value = model->cellValue(row, column);
+
+    // Parented to the view so it closes with the tab, before the tab's database goes away
+    QDialog *dialog = new QDialog(tabData->resultsTableView);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowTitle(tr("%1 (row %2)").arg(columnName).arg(index.row() + 1));
+    dialog->resize(600, 400);
+    QVBoxLayout *layout = new QVBoxLayout(dialog);
+    QPlainTextEdit *textEdit = new QPlainTextEdit(dialog);
+    textEdit->setReadOnly(true);
+    layout->addWidget(textEdit);
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, dialog);
+    connect(buttons, &QDialogButtonBox::rejected, dialog, &QDialog::close);
+    layout->addWidget(buttons);
+
+    std::shared_ptr<DuckDBManager::SpillFile> spill = model->getSpillFile();
+    if (!spill || (value.isValid() && !ResultsTableModel::isTruncated(value))) {
+        if (value.isValid()) {
+            textEdit->setPlainText(value.isNull() ? QString("<NULL>") : value.toString());
+        } else {
+            textEdit->setPlainText(tr("Value not loaded yet."));
+        }
+        dialog->show();
+        return;
+    }
+
+    // Only a preview is in memory (or nothing, while the chunk loads): read the one cell in full
+    textEdit->setPlainText(tr("Loading..."));
+    std::shared_ptr<DuckDBManager> dbManager = tabData->dbManager;
+    auto fetched = std::make_shared<DuckDBManager::QueryResult>();
+    BackgroundTask *task = new BackgroundTask(dialog);
+    task->setThreadPool(BackgroundTask::interactivePool());
+    connect(task, &BackgroundTask::finished, textEdit, [textEdit, fetched](bool cancelled) {
+        if (cancelled) {
+            return;
+        }
+        if (!fetched->success || fetched->rows.isEmpty() || fetched->rows.first().isEmpty()) {
+            textEdit->setPlainText(tr("Failed to read value: %1").arg(fetched->error));
+            return;
+        }
+        const QVariant full = fetched->rows.first().first();
+        textEdit->setPlainText(full.isNull() ? QString("<NULL>") : full.toString());
+    });
+    const QString selectColumn = DuckDBManager::quoteIdentifier(columnName);
+    task->start([dbManager, spill, row, selectColumn, fetched](BackgroundTask::Control &) {
+        *fetched = dbManager->readSpillRows(*spill, row, 1, {selectColumn}, 0);
+    });
+    dialog->show();
 }
 
 QString FileTabManager::generateTabTitle(const QString &filePath)
@@ -0,0 +1,53 @@
+#include "hyperloglog.h"
+#include <QtAlgorithms>
+#include <cmath>
+
+HyperLogLog::HyperLogLog()
+    : m_registers(REGISTERS, '\0')
+{
+}
+
+void HyperLogLog::addHash(quint64 hash)
+{
+    hash = mix(hash);
+    const int index = static_cast<int>(hash >> (64 - PRECISION));
+    // The remaining bits, with a sentinel so an all-zero remainder still has a finite rank
+    const quint64 rest = (hash << PRECISION) | (quint64(1) << (PRECISION - 1));
+    const char rank = static_cast<char>(qCountLeadingZeroBits(rest) + 1);
+    char &slot = m_registers[index];
+    if (rank > slot) {
+        slot = rank;
+    }
+}
+
+qint64 HyperLogLog::estimate() const
+{
+    double sum = 0.0;
+    int zeros = 0;
+    for (char rank : m_registers) {
+        sum += std::ldexp(1.0, -rank);
+        if (rank == 0) {
+            ++zeros;
+        }
+    }
+
+    const double m = REGISTERS;
+    const double alpha = 0.7213 / (1.0 + 1.079 / m);
+    double estimate = alpha * m * m / sum;
+    // Linear counting is more accurate while many registers are still empty
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * std::log(m / zeros);
+    }
+    return std::llround(estimate);
+}
+
+quint64 HyperLogLog::mix(quint64 hash)
+{
+    // splitmix64 finalizer
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    return hash;
+}
@@ -2,6 +2,7 @@
 #include "filebrowser.h"
 #include "filetabmanager.h"
 #include "sqleditor.h"
+#include "duckdbmanager.h"
 
 #include <QMessageBox>
 #include <QFileDialog>
@@ -19,6 +20,11 @@
 #include <QSortFilterProxyModel>
 #include <QMenuBar>
 #include <QMenu>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QCheckBox>
+#include <QSpinBox>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -193,6 +199,22 @@ void MainWindow::setupKeyboardShortcuts()
         m_fileTabManager->cancelCurrentQuery();
     });
 
+    QAction *exportQueryAction = new QAction(tr("&Export Query Results..."), this);
+    exportQueryAction->setShortcut(QKeySequence("Ctrl+Shift+E"));
+    connect(exportQueryAction, &QAction::triggered, [this]() {
+        m_fileTabManager->exportCurrentQuery();
+    });
+
+    QAction *copyRowsAction = new QAction(tr("Copy All Result &Rows"), this);
+    connect(copyRowsAction, &QAction::triggered, [this]() {
+        m_fileTabManager->copyAllRows();
+    });
+
+    QAction *lookupIndexAction = new QAction(tr("Build &Lookup Index..."), this);
+    connect(lookupIndexAction, &QAction::triggered, [this]() {
+        m_fileTabManager->buildLookupIndex();
+    });
+
     QAction *focusFilterAction = new QAction(tr("Focus File &Filter"), this);
     focusFilterAction->setShortcut(QKeySequence("Ctrl+F"));
     connect(focusFilterAction, &QAction::triggered, [this]() {
@@ -220,12 +242,21 @@ void MainWindow::setupKeyboardShortcuts()
                "Ctrl+Enter: Execute query\n"
                "Ctrl+.: Cancel running query\n"
                "Ctrl+Shift+C: Clear current tab\n"
+               "Ctrl+Shift+E: Export query results\n"
                "Ctrl+F: Focus file filter\n"
                "F5: Refresh file tree\n"
                "F1: Show this help")
         );
     });
 
+    QAction *scrollBenchmarkAction = new QAction(tr("&Benchmark Result Scrolling"), this);
+    connect(scrollBenchmarkAction, &QAction::triggered, [this]() {
+        m_fileTabManager->benchmarkScrolling();
+    });
+
+    QAction *spillSettingsAction = new QAction(tr("Result &Spill Settings..."), this);
+    connect(spillSettingsAction, &QAction::triggered, this, &MainWindow::onSpillSettings);
+
     QAction *exitAction = new QAction(tr("E&xit"), this);
     exitAction->setShortcut(QKeySequence::Quit);
     connect(exitAction, &QAction::triggered, this, &QWidget::close);
@@ -241,6 +272,10 @@ void MainWindow::setupKeyboardShortcuts()
     queryMenu->addAction(executeQueryAction);
     queryMenu->addAction(cancelQueryAction);
     queryMenu->addAction(clearAction);
+    queryMenu->addSeparator();
+    queryMenu->addAction(exportQueryAction);
+    queryMenu->addAction(copyRowsAction);
+    queryMenu->addAction(lookupIndexAction);
 
     QMenu *viewMenu = menuBar()->addMenu(tr("&View"));
     viewMenu->addAction(nextTabAction);
@@ -248,6 +283,9 @@ void MainWindow::setupKeyboardShortcuts()
     viewMenu->addSeparator();
     viewMenu->addAction(focusFilterAction);
     viewMenu->addAction(refreshAction);
+    viewMenu->addSeparator();
+    viewMenu->addAction(spillSettingsAction);
+    viewMenu->addAction(scrollBenchmarkAction);
 
     QMenu *helpMenu = menuBar()->addMenu(tr("&Help"));
     helpMenu->addAction(helpShortcutsAction);
@@ -265,6 +303,65 @@ void MainWindow::setupKeyboardShortcuts()
     addAction(exitAction);
 }
 
+void MainWindow::onSpillSettings()
+{
+    DuckDBManager::SpillSettings settings = DuckDBManager::spillSettings();
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Result Spill Settings"));
+    QFormLayout *layout = new QFormLayout(&dialog);
+
+    QCheckBox *enabledCheck = new QCheckBox(tr("Write large results to a scratch Parquet file"));
+    enabledCheck->setChecked(settings.enabled);
+    layout->addRow(enabledCheck);
+
+    QSpinBox *thresholdSpin = new QSpinBox();
+    thresholdSpin->setRange(1000, 2000000000);
+    thresholdSpin->setSingleStep(100000);
+    thresholdSpin->setGroupSeparatorShown(true);
+    thresholdSpin->setValue(static_cast<int>(qBound<qint64>(1000, settings.rowThreshold, 2000000000)));
+    layout->addRow(tr("Spill above (rows):"), thresholdSpin);
+
+    QSpinBox *columnThresholdSpin = new QSpinBox();
+    columnThresholdSpin->setRange(0, 100000);
+    columnThresholdSpin->setSingleStep(50);
+    columnThresholdSpin->setSpecialValueText(tr("Never"));
+    columnThresholdSpin->setValue(settings.columnThreshold);
+    columnThresholdSpin->setToolTip(tr("Wide results are read from disk a few columns at a time as you scroll"));
+    layout->addRow(tr("Always spill above (columns):"), columnThresholdSpin);
+
+    QLineEdit *directoryEdit = new QLineEdit(settings.scratchDirectory);
+    QPushButton *browseButton = new QPushButton(tr("Browse..."));
+    QHBoxLayout *directoryLayout = new QHBoxLayout();
+    directoryLayout->addWidget(directoryEdit);
+    directoryLayout->addWidget(browseButton);
+    layout->addRow(tr("Scratch directory:"), directoryLayout);
+    connect(browseButton, &QPushButton::clicked, &dialog, [&dialog, directoryEdit]() {
+        QString directory = QFileDialog::getExistingDirectory(&dialog, tr("Scratch Directory"), directoryEdit->text());
+        if (!directory.isEmpty()) {
+            directoryEdit->setText(directory);
+        }
+    });
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    layout->addRow(buttons);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+
+    settings.enabled = enabledCheck->isChecked();
+    settings.rowThreshold = thresholdSpin->value();
+    settings.columnThreshold = columnThresholdSpin->value();
+    if (!directoryEdit->text().trimmed().isEmpty()) {
+        settings.scratchDirectory = directoryEdit->text().trimmed();
+    }
+    DuckDBManager::setSpillSettings(settings);
+    statusLabel->setText(tr("Spill settings saved; they apply to the next query"));
+}
+
 void MainWindow::onLoadFileClicked()
 {
     auto indexes = fileTreeView->selectionModel() ? fileTreeView->selectionModel()->selectedIndexes() : QModelIndexList();
@@ -0,0 +1,230 @@
+#include "queryexporter.h"
+#include "backgroundtask.h"
+#include "duckdbmanager.h"
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QDebug>
+
+double QueryExporter::Summary::megabytesPerSecond() const
+{
+    return elapsedMs > 0 ? (bytesWritten / (1024.0 * 1024.0)) / (elapsedMs / 1000.0) : 0.0;
+}
+
+double QueryExporter::Summary::rowsPerSecond() const
+{
+    return elapsedMs > 0 ? rowsWritten / (elapsedMs / 1000.0) : 0.0;
+}
+
+QueryExporter::QueryExporter(std::shared_ptr<DuckDBManager> dbManager, QObject *parent)
+    : QObject(parent)
+    , m_dbManager(std::move(dbManager))
+    , m_task(new BackgroundTask(this))
+{
+    connect(m_task, &BackgroundTask::progress, this, &QueryExporter::progress);
+    connect(m_task, &BackgroundTask::finished, this, [this](bool cancelled) {
+        Summary summary = m_summary ? *m_summary : Summary();
+        if (cancelled) {
+            summary.success = false;
+            summary.cancelled = true;
+        }
+        emit finished(summary);
+    });
+}
+
+QueryExporter::~QueryExporter()
+{
+    // Detach the run so a COPY still going stops at its next progress check; it keeps its own
+    // reference to the database until then
+    delete m_task;
+    m_task = nullptr;
+}
+
+void QueryExporter::exportQuery(const QString &query, const Options &options)
+{
+    auto summary = std::make_shared<Summary>();
+    summary->filePath = options.filePath;
+    m_summary = summary;
+
+    QString copyStatement = buildCopyStatement(query, options);
+    std::shared_ptr<DuckDBManager> dbManager = m_dbManager;
+
+    m_task->start([dbManager, copyStatement, summary](BackgroundTask::Control &control) {
+        // Files already in the output location are not part of this export
+        const OutputSnapshot existing = snapshotOutput(summary->filePath);
+
+        QElapsedTimer timer;
+        timer.start();
+        QElapsedTimer sinceReport;
+        sinceReport.start();
+        QElapsedTimer sinceMeasure;
+        qint64 measureCostMs = 0;
+        qint64 bytes = 0;
+        int files = 0;
+
+        DuckDBManager::QueryResult result = dbManager->executeBackgroundQuery(copyStatement, [&](double percent) {
+            if (control.isCancelled()) {
+                return false;
+            }
+            if (sinceReport.elapsed() >= PROGRESS_INTERVAL_MS) {
+                sinceReport.restart();
+                // Walking a partitioned tree of thousands of files is not free; keep it to a
+                // small share of the run and report the last measurement in between
+                if (!sinceMeasure.isValid()
+                    || sinceMeasure.elapsed() >= qMax<qint64>(MEASURE_INTERVAL_MS, measureCostMs * 20)) {
+                    QElapsedTimer walk;
+                    walk.start();
+                    measureOutput(summary->filePath, existing, &bytes, &files);
+                    measureCostMs = walk.elapsed();
+                    sinceMeasure.start();
+                }
+                double seconds = qMax<qint64>(1, timer.elapsed()) / 1000.0;
+                control.reportProgress(percent, tr("%1 written (%2 MB/s)")
+                                                    .arg(formatBytes(bytes))
+                                                    .arg(bytes / (1024.0 * 1024.0) / seconds, 0, 'f', 1));
+            }
+            return true;
+        });
+
+        summary->elapsedMs = timer.elapsed();
+        measureOutput(summary->filePath, existing, &summary->bytesWritten, &summary->filesWritten);
+
+        if (!result.success) {
+            summary->error = result.error;
+            qWarning() << "Export failed:" << result.error;
+            return;
+        }
+
+        // COPY reports the number of rows it wrote as a single "Count" value
+        if (!result.rows.isEmpty() && !result.rows.first().isEmpty()) {
+            summary->rowsWritten = result.rows.first().first().toLongLong();
+        }
+        summary->success = true;
+    });
+}
+
+void QueryExporter::cancel()
+{
+    m_task->cancel();
+}
+
+bool QueryExporter::isRunning() const
+{
+    return m_task->isRunning();
+}
+
+QString QueryExporter::buildCopyStatement(const QString &query, const Options &options)
+{
+    QStringList copyOptions;
+    switch (options.format) {
+    case CSV:
+        copyOptions << "FORMAT csv" << "HEADER true";
+        break;
+    case TSV:
+        copyOptions << "FORMAT csv" << "HEADER true" << "DELIMITER '\t'";
+        break;
+    case Parquet:
+        copyOptions << "FORMAT parquet";
+        if (!options.compression.isEmpty()) {
+            copyOptions << QString("COMPRESSION %1").arg(options.compression);
+        }
+        if (options.compressionLevel > 0 && options.compression == "zstd") {
+            copyOptions << QString("COMPRESSION_LEVEL %1").arg(options.compressionLevel);
+        }
+        if (options.rowGroupSize > 0) {
+            copyOptions << QString("ROW_GROUP_SIZE %1").arg(options.rowGroupSize);
+        }
+        break;
+    case JSON:
+        copyOptions << "FORMAT json";
+        break;
+    }
+
+    if (!options.partitionBy.isEmpty()) {
+        QStringList columns;
+        for (const QString &column : options.partitionBy) {
+            columns.append(DuckDBManager::quoteIdentifier(column));
+        }
+        copyOptions << QString("PARTITION_BY (%1)").arg(columns.join(", "));
+    } else if (options.perThreadOutput) {
+        copyOptions << "PER_THREAD_OUTPUT true";
+    }
+    if (options.overwrite && options.writesDirectory()) {
+        copyOptions << "OVERWRITE_OR_IGNORE true";
+    }
+
+    return QString("COPY %1 TO %2 (%3);")
+        .arg(DuckDBManager::asSubquery(query),
+             DuckDBManager::quoteLiteral(options.filePath),
+             copyOptions.join(", "));
+}
+
+QueryExporter::Format QueryExporter::formatForPath(const QString &filePath, Format fallback)
+{
+    QString suffix = QFileInfo(filePath).suffix().toLower();
+    if (suffix == "csv") return CSV;
+    if (suffix == "tsv" || suffix == "tab") return TSV;
+    if (suffix == "parquet") return Parquet;
+    if (suffix == "json" || suffix == "jsonl" || suffix == "ndjson") return JSON;
+    return fallback;
+}
+
+QString QueryExporter::formatBytes(qint64 bytes)
+{
+    if (bytes >= 1024LL * 1024 * 1024) {
+        return QString("%1 GB").arg(bytes / (1024.0 * 1024.0 * 1024.0), 0, 'f', 2);
+    }
+    if (bytes >= 1024 * 1024) {
+        return QString("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+    }
+    if (bytes >= 1024) {
+        return QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+    }
+    return QString("%1 bytes").arg(bytes);
+}
+
+QueryExporter::OutputSnapshot QueryExporter::snapshotOutput(const QString &path)
+{
+    OutputSnapshot snapshot;
+    QFileInfo info(path);
+    if (info.isFile()) {
+        snapshot.insert(info.absoluteFilePath(), info.lastModified());
+    } else if (info.isDir()) {
+        QDirIterator it(path, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            it.next();
+            snapshot.insert(it.fileInfo().absoluteFilePath(), it.fileInfo().lastModified());
+        }
+    }
+    return snapshot;
+}
+
+void QueryExporter::measureOutput(const QString &path, const OutputSnapshot &existing, qint64 *bytes, int *files)
+{
+    *bytes = 0;
+    *files = 0;
+
+    // Counts files that are new or were rewritten since the snapshot
+    auto add = [&](const QFileInfo &file) {
+        auto it = existing.constFind(file.absoluteFilePath());
+        if (it != existing.constEnd() && it.value() == file.lastModified()) {
+            return;
+        }
+        *bytes += file.size();
+        ++*files;
+    };
+
+    QFileInfo info(path);
+    if (info.isFile()) {
+        add(info);
+        return;
+    }
+
+    if (info.isDir()) {
+        QDirIterator it(path, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            it.next();
+            add(it.fileInfo());
+        }
+    }
+}
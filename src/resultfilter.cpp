@@ -0,0 +1,135 @@
+#include "resultfilter.h"
+#include "duckdbmanager.h"
+
+#include <QRegularExpression>
+#include <QLocale>
+#include <cmath>
+
+QString ResultFilter::compile(const QString &text, const QStringList &columns, const QStringList &types,
+                              QString *error)
+{
+    if (error) {
+        error->clear();
+    }
+
+    const QString trimmed = text.trimmed();
+    if (trimmed.isEmpty()) {
+        return QString();
+    }
+
+    // "where <predicate>" is handed to DuckDB as written
+    static const QRegularExpression rawPattern("^where\\s+(.+)$",
+                                               QRegularExpression::CaseInsensitiveOption |
+                                               QRegularExpression::DotMatchesEverythingOption);
+    QRegularExpressionMatch rawMatch = rawPattern.match(trimmed);
+    if (rawMatch.hasMatch()) {
+        return QString("(%1)").arg(rawMatch.captured(1));
+    }
+
+    // "column op value", where column may be double-quoted and value single-quoted
+    static const QRegularExpression comparisonPattern(
+        "^(\"(?:[^\"]|\"\")+\"|[^\\s=<>!]+)\\s*(==|=|!=|<>|<=|>=|<|>)\\s*(.*)$");
+    QRegularExpressionMatch comparison = comparisonPattern.match(trimmed);
+    if (comparison.hasMatch()) {
+        QString name = comparison.captured(1);
+        if (name.startsWith('"')) {
+            name = name.mid(1, name.size() - 2).replace("\"\"", "\"");
+        }
+
+        int column = columns.indexOf(name);
+        if (column < 0) {
+            for (int i = 0; i < columns.size(); ++i) {
+                if (columns[i].compare(name, Qt::CaseInsensitive) == 0) {
+                    column = i;
+                    break;
+                }
+            }
+        }
+
+        if (column >= 0) {
+            QString op = comparison.captured(2) == "==" ? QString("=") : comparison.captured(2);
+            QString value = comparison.captured(3).trimmed();
+            if (value.size() >= 2 && value.startsWith('\'') && value.endsWith('\'')) {
+                value = value.mid(1, value.size() - 2).replace("''", "'");
+            }
+
+            QString identifier = DuckDBManager::quoteIdentifier(columns[column]);
+            QString type = column < types.size() ? types[column] : QString();
+            if (isNumericType(type)) {
+                QString literal = numericLiteral(value);
+                if (literal.isEmpty()) {
+                    if (error) {
+                        *error = QString("Column %1 is numeric; \"%2\" is not a number").arg(columns[column], value);
+                    }
+                    return QString();
+                }
+                return QString("%1 %2 %3").arg(identifier, op, literal);
+            }
+            // DuckDB casts the string literal to the column's type (dates, timestamps, booleans...)
+            return QString("%1 %2 %3").arg(identifier, op, DuckDBManager::quoteLiteral(value));
+        }
+    }
+
+    // Plain text: case-insensitive substring across text columns, equality on numeric ones
+    QStringList conditions;
+    const QString needle = DuckDBManager::quoteLiteral(trimmed.toLower());
+    const QString number = numericLiteral(trimmed);
+    for (int i = 0; i < columns.size(); ++i) {
+        QString type = i < types.size() ? types[i] : QString();
+        QString identifier = DuckDBManager::quoteIdentifier(columns[i]);
+        if (isTextType(type)) {
+            conditions.append(QString("contains(lower(CAST(%1 AS VARCHAR)), %2)").arg(identifier, needle));
+        } else if (!number.isEmpty() && isNumericType(type)) {
+            conditions.append(QString("%1 = %2").arg(identifier, number));
+        }
+    }
+
+    if (conditions.isEmpty()) {
+        if (error) {
+            *error = QString("No text columns to search for \"%1\"").arg(trimmed);
+        }
+        return QString();
+    }
+    return QString("(%1)").arg(conditions.join(" OR "));
+}
+
+QString ResultFilter::apply(const QString &query, const QString &predicate)
+{
+    if (predicate.isEmpty()) {
+        return query;
+    }
+    // A newline keeps a trailing "-- comment" in a raw predicate from swallowing later clauses
+    return QString("SELECT * FROM %1 WHERE %2\n").arg(DuckDBManager::asSubquery(query), predicate);
+}
+
+bool ResultFilter::isNumericType(const QString &type)
+{
+    static const QStringList numericTypes = {
+        "TINYINT", "SMALLINT", "INTEGER", "BIGINT", "HUGEINT",
+        "UTINYINT", "USMALLINT", "UINTEGER", "UBIGINT", "UHUGEINT",
+        "FLOAT", "REAL", "DOUBLE"
+    };
+    QString upper = type.trimmed().toUpper();
+    return numericTypes.contains(upper) || upper.startsWith("DECIMAL");
+}
+
+bool ResultFilter::isTextType(const QString &type)
+{
+    QString upper = type.trimmed().toUpper();
+    return upper == "VARCHAR" || upper.startsWith("ENUM");
+}
+
+QString ResultFilter::numericLiteral(const QString &value)
+{
+    // Re-rendered rather than passed through, so only a number can reach the SQL
+    bool ok = false;
+    qlonglong integer = QLocale::c().toLongLong(value, &ok);
+    if (ok) {
+        return QString::number(integer);
+    }
+    double real = QLocale::c().toDouble(value, &ok);
+    if (ok && std::isfinite(real)) {
+        return QString::number(real, 'g', 17);
+    }
+    return QString();
+}
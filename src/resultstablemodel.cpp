@@ -1,78 +1,148 @@
 #include "resultstablemodel.h"
+#include "backgroundtask.h"
+#include "compressedresult.h"
 #include <QFont>
 #include <QBrush>
 #include <QColor>
 #include <QDebug>
-#include <QRegularExpression>
-#include <QFile>
-#include <QTextStream>
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <cstring>
 
 ResultsTableModel::ResultsTableModel(QObject *parent)
     : QAbstractTableModel(parent)
-    , m_currentPage(0)
-    , m_rowsPerPage(DEFAULT_ROWS_PER_PAGE)
     , m_totalRows(0)
+    , m_resultId(nextResultId())
+    , m_reversed(false)
+    , m_lastTouchedChunk(-1)
+    , m_lastDisplayChunk(-1)
+    , m_lastTouchedPage(-1)
 {
 }
 
+ResultsTableModel::~ResultsTableModel()
+{
+    // Fetches still running finish on their own; nothing is left to receive them
+    cancelFetches();
+}
+
 int ResultsTableModel::rowCount(const QModelIndex &parent) const
 {
-    Q_UNUSED(parent)
-    return m_visibleData.size();
+    if (parent.isValid()) {
+        return 0;
+    }
+    // Views address rows with int; anything past INT_MAX stays reachable through exports
+    return static_cast<int>(qMin<qint64>(m_totalRows, INT_MAX));
 }
 
 int ResultsTableModel::columnCount(const QModelIndex &parent) const
 {
-    Q_UNUSED(parent)
+    if (parent.isValid()) {
+        return 0;
+    }
     return m_columnNames.size();
 }
 
 QVariant ResultsTableModel::data(const QModelIndex &index, int role) const
 {
     try {
-        if (!index.isValid() || index.row() >= m_visibleData.size() ||
+        if (!index.isValid() || index.row() >= rowCount() ||
             index.column() >= m_columnNames.size()) {
             return QVariant();
         }
 
-        const QVariantList &row = m_visibleData[index.row()];
-        if (index.column() >= row.size()) {
+        qint64 row = resultRow(index.row());
+        int column = index.column();
+        const QVariant *cell = cellData(row, column);
+        qint64 block = row / BLOCK_ROWS;
+        int group = column / COLUMN_GROUP_SIZE;
+        if (!cell) {
+            // Not loaded yet: ask for its chunk (or compressed page) and show a placeholder until it arrives
+            ResultsTableModel *self = const_cast<ResultsTableModel*>(this);
+            if (m_compressed) {
+                int page = static_cast<int>(row / CompressedResult::PAGE_ROWS);
+                self->requestPage(page - 1);
+                self->requestPage(page + 1);
+                self->requestPage(page);
+                self->startPageLoads();
+            } else {
+                self->prefetchAround(block, group);
+                self->requestChunk(block, group);
+                self->startFetches();
+            }
+            if (role == Qt::DisplayRole) {
+                return QString("...");
+            }
+            if (role == Qt::ForegroundRole) {
+                return QBrush(QColor(160, 160, 160));
+            }
             return QVariant();
         }
 
-        const QVariant &value = row[index.column()];
+        if (m_spill) {
+            qint64 key = chunkKey(block, group);
+            if (key != m_lastTouchedChunk) {
+                touchChunk(key);
+                ResultsTableModel *self = const_cast<ResultsTableModel*>(this);
+                self->prefetchAround(block, group);
+                self->startFetches();
+            }
+        } else if (m_compressed) {
+            int page = static_cast<int>(row / CompressedResult::PAGE_ROWS);
+            if (page != m_lastTouchedPage) {
+                m_lastTouchedPage = page;
+                ResultsTableModel *self = const_cast<ResultsTableModel*>(this);
+                self->requestPage(page - 1);
+                self->requestPage(page + 1);
+                self->startPageLoads();
+            }
+        }
+
+        const QVariant &value = *cell;
+
+        // Role values are shared across cells instead of being rebuilt on every call
+        static const QVariant rightAligned(static_cast<int>(Qt::AlignRight | Qt::AlignVCenter));
+        static const QVariant leftAligned(static_cast<int>(Qt::AlignLeft | Qt::AlignVCenter));
+        static const QVariant evenBackground(QBrush(QColor(248, 248, 248)));
+        static const QVariant oddBackground(QBrush(Qt::white));
+        static const QVariant nullForeground(QBrush(QColor(128, 128, 128)));
+        static const QVariant valueForeground(QBrush(Qt::black));
+        static const QVariant nullFont = []() {
+            QFont font;
+            font.setItalic(true);
+            return QVariant(font);
+        }();
+        static const QVariant valueFont{QFont()};
 
         switch (role) {
         case Qt::DisplayRole:
         case Qt::EditRole:
-            return formatValue(value);
+            return displayText(row, column, value);
 
         case Qt::TextAlignmentRole:
             if (value.typeId() == QMetaType::Int || value.typeId() == QMetaType::LongLong ||
                 value.typeId() == QMetaType::Double || value.typeId() == QMetaType::ULongLong) {
-                return static_cast<int>(Qt::AlignRight | Qt::AlignVCenter);
+                return rightAligned;
             }
-            return static_cast<int>(Qt::AlignLeft | Qt::AlignVCenter);
+            return leftAligned;
 
         case Qt::BackgroundRole:
-            if (index.row() % 2 == 0) {
-                return QBrush(QColor(248, 248, 248));
-            }
-            return QBrush(Qt::white);
+            return index.row() % 2 == 0 ? evenBackground : oddBackground;
 
-        case Qt::FontRole: {
-            QFont font;
-            if (value.isNull()) {
-                font.setItalic(true);
-            }
-            return font;
-        }
+        case Qt::FontRole:
+            return value.isNull() ? nullFont : valueFont;
 
         case Qt::ForegroundRole:
-            if (value.isNull()) {
-                return QBrush(QColor(128, 128, 128));
+            return value.isNull() ? nullForeground : valueForeground;
+
+        case Qt::ToolTipRole:
+            if (isTruncated(value)) {
+                const auto text = value.value<DuckDBManager::TruncatedText>();
+                return tr("First %1 characters of %2 bytes; double-click for the full value")
+                    .arg(text.prefix.size()).arg(text.fullBytes);
             }
-            return QBrush(Qt::black);
+            return QVariant();
 
         default:
             return QVariant();
@@ -88,11 +158,28 @@ QVariant ResultsTableModel::data(const QModelIndex &index, int role) const
 
 QVariant ResultsTableModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
-    if (orientation != Qt::Horizontal || role != Qt::DisplayRole ||
-        section >= m_columnNames.size()) {
+    if (orientation != Qt::Horizontal || section < 0 || section >= m_columnNames.size()) {
         return QVariant();
     }
 
+    if (role == Qt::ToolTipRole) {
+        auto tooltip = m_columnTooltips.constFind(m_columnNames[section]);
+        return tooltip != m_columnTooltips.constEnd() ? QVariant(*tooltip) : QVariant();
+    }
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    // With several sort columns, number them so the sort precedence is visible
+    if (m_sortMarkers.size() > 1) {
+        for (int i = 0; i < m_sortMarkers.size(); ++i) {
+            if (m_sortMarkers[i].first == section) {
+                QChar arrow = m_sortMarkers[i].second == Qt::AscendingOrder ? QChar(0x25B2) : QChar(0x25BC);
+                return QString("%1 %2%3").arg(m_columnNames[section], QString(arrow), QString::number(i + 1));
+            }
+        }
+    }
+
     return m_columnNames[section];
 }
 
@@ -105,115 +192,583 @@ Qt::ItemFlags ResultsTableModel::flags(const QModelIndex &index) const
     return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
 }
 
-void ResultsTableModel::setResults(const DuckDBManager::QueryResult &results)
+void ResultsTableModel::setReversed(bool reversed)
 {
+    if (m_reversed == reversed) {
+        return;
+    }
+
     beginResetModel();
-    
-    m_columnNames = results.columnNames;
-    m_allData = results.rows;
-    m_totalRows = results.totalRows;
-    m_currentPage = 0;
-    
-    updateVisibleData();
-    
+    m_reversed = reversed;
+    endResetModel();
+}
+
+void ResultsTableModel::setColumnTooltips(const QHash<QString, QString> &tooltips)
+{
+    m_columnTooltips = tooltips;
+    if (!m_columnNames.isEmpty()) {
+        emit headerDataChanged(Qt::Horizontal, 0, m_columnNames.size() - 1);
+    }
+}
+
+void ResultsTableModel::setSortMarkers(const QList<QPair<int, Qt::SortOrder>> &sortColumns)
+{
+    m_sortMarkers = sortColumns;
+    if (!m_columnNames.isEmpty()) {
+        emit headerDataChanged(Qt::Horizontal, 0, m_columnNames.size() - 1);
+    }
+}
+
+std::shared_ptr<ResultsTableModel::Snapshot> ResultsTableModel::prepareSnapshot(const DuckDBManager::QueryResult &results)
+{
+    auto snapshot = std::make_shared<Snapshot>();
+    snapshot->results = results;
+
+    // Same layout displayText() uses for chunk (0, 0)
+    const int groupWidth = qMin(COLUMN_GROUP_SIZE, static_cast<int>(results.columnNames.size()));
+    const int rows = static_cast<int>(qMin<qint64>(BLOCK_ROWS, results.rows.size()));
+    DisplayBlock &chunk = snapshot->firstChunk;
+    chunk.text.resize(static_cast<size_t>(BLOCK_ROWS) * groupWidth);
+    chunk.ready.resize(chunk.text.size(), false);
+    for (int row = 0; row < rows; ++row) {
+        const QVariantList &values = results.rows[row];
+        for (int column = 0; column < groupWidth && column < values.size(); ++column) {
+            size_t slot = static_cast<size_t>(row) * groupWidth + column;
+            chunk.text[slot] = formatValue(values[column]);
+            chunk.ready[slot] = true;
+        }
+    }
+    return snapshot;
+}
+
+void ResultsTableModel::setSnapshot(const std::shared_ptr<Snapshot> &snapshot)
+{
+    cancelFetches();
+
+    beginResetModel();
+
+    releaseStorage();
+    m_columnNames = snapshot->results.columnNames;
+    m_columnTypes = snapshot->results.columnTypes;
+    m_allData = snapshot->results.rows;
+    m_spill = snapshot->results.spill;
+    m_totalRows = snapshot->results.totalRows;
+    m_resultId = nextResultId();
+    m_reversed = false;
+    m_lastTouchedChunk = -1;
+    m_hiddenColumns.clear();
+    m_groupVersions.clear();
+    if (!snapshot->firstChunk.text.empty()) {
+        const qint64 key = chunkKey(0, 0);
+        m_displayCache.insert(key, std::move(snapshot->firstChunk));
+        m_displayLru.append(key);
+    }
+
     endResetModel();
-    
-    emit pageChanged(m_currentPage, getTotalPages());
 }
 
 void ResultsTableModel::clear()
 {
+    cancelFetches();
+
     beginResetModel();
     
-    m_columnNames.clear();
-    m_allData.clear();
-    m_visibleData.clear();
+    releaseStorage();
     m_totalRows = 0;
-    m_currentPage = 0;
+    m_resultId = nextResultId();
+    m_reversed = false;
+    m_sortMarkers.clear();
+    m_lastTouchedChunk = -1;
+    m_hiddenColumns.clear();
+    m_groupVersions.clear();
     
     endResetModel();
-    
-    emit pageChanged(0, 0);
 }
 
-int ResultsTableModel::getTotalPages() const
+void ResultsTableModel::releaseStorage()
 {
-    if (m_totalRows == 0 || m_rowsPerPage == 0) {
-        return 0;
+    // The old rows and caches are moved out and freed off the GUI thread
+    struct Retired {
+        QList<QVariantList> rows;
+        QHash<qint64, QList<QVariantList>> blocks;
+        QHash<qint64, DisplayBlock> display;
+        QHash<int, QList<QVariantList>> pages;
+    };
+    auto retired = std::make_shared<Retired>();
+    retired->rows = std::move(m_allData);
+    retired->blocks = std::move(m_blockCache);
+    retired->display = std::move(m_displayCache);
+    retired->pages = std::move(m_pageCache);
+    m_allData.clear();
+    m_blockCache.clear();
+    m_displayCache.clear();
+    m_blockLru.clear();
+    m_displayLru.clear();
+    m_lastDisplayChunk = -1;
+    m_columnNames.clear();
+    m_columnTypes.clear();
+    m_spill.reset();
+    m_compressed.reset();
+    m_pageCache.clear();
+    m_pageLru.clear();
+    m_lastTouchedPage = -1;
+
+    if (!retired->rows.isEmpty() || !retired->blocks.isEmpty() || !retired->display.isEmpty() ||
+        !retired->pages.isEmpty()) {
+        BackgroundTask::release(std::move(retired));
+    }
+}
+
+quint64 ResultsTableModel::nextResultId()
+{
+    // Models live on the GUI thread; ids are unique across every tab
+    static quint64 lastResultId = 0;
+    return ++lastResultId;
+}
+
+qint64 ResultsTableModel::resultRow(int viewRow) const
+{
+    return m_reversed ? m_totalRows - 1 - viewRow : viewRow;
+}
+
+QVariant ResultsTableModel::cellValue(qint64 row, int column) const
+{
+    const QVariant *cell = cellData(row, column);
+    if (!cell && m_compressed && row >= 0 && row < m_totalRows) {
+        // Asked for outside painting (a double-click), so the page is read on the spot
+        return getRows({row}).value(0).value(column);
+    }
+    return cell ? *cell : QVariant();
+}
+
+bool ResultsTableModel::isTruncated(const QVariant &value)
+{
+    return value.metaType() == QMetaType::fromType<DuckDBManager::TruncatedText>();
+}
+
+QList<QVariantList> ResultsTableModel::getRows(const QList<qint64> &rows) const
+{
+    QList<QVariantList> result;
+    result.reserve(rows.size());
+    if (m_compressed) {
+        // Consecutive rows usually share a page, so each page is decompressed once per run
+        int currentPage = -1;
+        QList<QVariantList> pageRows;
+        for (qint64 row : rows) {
+            if (row < 0 || row >= m_compressed->rowCount()) {
+                continue;
+            }
+            int page = static_cast<int>(row / CompressedResult::PAGE_ROWS);
+            if (page != currentPage) {
+                auto cached = m_pageCache.constFind(page);
+                pageRows = cached != m_pageCache.constEnd() ? *cached : m_compressed->page(page);
+                currentPage = page;
+            }
+            result.append(pageRows.value(static_cast<int>(row % CompressedResult::PAGE_ROWS)));
+        }
+        return result;
     }
-    return (m_totalRows + m_rowsPerPage - 1) / m_rowsPerPage;
+    for (qint64 row : rows) {
+        if (row >= 0 && row < m_allData.size()) {
+            result.append(m_allData[row]);
+        }
+    }
+    return result;
+}
+
+QList<QVariantList> ResultsTableModel::allRows() const
+{
+    return m_compressed ? m_compressed->rows() : m_allData;
 }
 
-void ResultsTableModel::setCurrentPage(int page)
+void ResultsTableModel::setCompressed(const std::shared_ptr<CompressedResult> &compressed)
 {
-    int totalPages = getTotalPages();
-    if (page < 0 || page >= totalPages) {
+    if (!compressed || m_spill || compressed->rowCount() != m_allData.size()) {
         return;
     }
-    
-    if (m_currentPage != page) {
-        beginResetModel();
-        m_currentPage = page;
-        updateVisibleData();
-        endResetModel();
-        
-        emit pageChanged(m_currentPage, totalPages);
+
+    // Same cells, so views need no reset. The rows and their formatted text (rebuilt on paint)
+    // are freed off the GUI thread, and pages are decompressed there as the grid reaches them.
+    struct Retired {
+        QList<QVariantList> rows;
+        QHash<qint64, DisplayBlock> display;
+    };
+    auto retired = std::make_shared<Retired>();
+    retired->rows = std::move(m_allData);
+    retired->display = std::move(m_displayCache);
+    BackgroundTask::release(std::move(retired));
+    m_compressed = compressed;
+    m_allData.clear();
+    m_displayCache.clear();
+    m_displayLru.clear();
+    m_lastDisplayChunk = -1;
+    m_lastTouchedPage = -1;
+}
+
+void ResultsTableModel::setColumnHidden(int column, bool hidden)
+{
+    if (column < 0 || column >= m_columnNames.size() || m_hiddenColumns.contains(column) == hidden) {
+        return;
+    }
+
+    if (hidden) {
+        m_hiddenColumns.insert(column);
+        return;
+    }
+    m_hiddenColumns.remove(column);
+    if (!m_spill) {
+        return;
+    }
+
+    // Chunks fetched while the column was hidden hold NULL in its place; drop them, and
+    // bump the group version so fetches still in flight are discarded when they land
+    int group = column / COLUMN_GROUP_SIZE;
+    ++m_groupVersions[group];
+    for (auto it = m_blockCache.begin(); it != m_blockCache.end();) {
+        if (it.key() % MAX_COLUMN_GROUPS == group) {
+            m_blockLru.removeOne(it.key());
+            it = m_blockCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = m_displayCache.begin(); it != m_displayCache.end();) {
+        if (it.key() % MAX_COLUMN_GROUPS == group) {
+            m_displayLru.removeOne(it.key());
+            it = m_displayCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    m_lastTouchedChunk = -1;
+    m_lastDisplayChunk = -1;
+
+    if (rowCount() > 0) {
+        emit dataChanged(index(0, column), index(rowCount() - 1, column));
+    }
+}
+
+const QVariant *ResultsTableModel::cellData(qint64 row, int column) const
+{
+    if (row < 0 || row >= m_totalRows || column < 0 || column >= m_columnNames.size()) {
+        return nullptr;
+    }
+    if (row < m_allData.size()) {
+        const QVariantList &values = m_allData[row];
+        return column < values.size() ? &values[column] : nullptr;
     }
+    if (m_compressed) {
+        // Pages are decompressed on the interactive pool (startPageLoads()); until then the cell is not loaded
+        int page = static_cast<int>(row / CompressedResult::PAGE_ROWS);
+        auto it = m_pageCache.constFind(page);
+        if (it == m_pageCache.constEnd()) {
+            return nullptr;
+        }
+        if (m_pageLru.last() != page) {
+            m_pageLru.removeOne(page);
+            m_pageLru.append(page);
+        }
+        qint64 offset = row % CompressedResult::PAGE_ROWS;
+        if (offset >= it->size() || column >= it->at(offset).size()) {
+            return nullptr;
+        }
+        return &it->at(offset)[column];
+    }
+    if (!m_spill) {
+        return nullptr;
+    }
+
+    auto it = m_blockCache.constFind(chunkKey(row / BLOCK_ROWS, column / COLUMN_GROUP_SIZE));
+    if (it == m_blockCache.constEnd()) {
+        return nullptr;
+    }
+    qint64 offset = row % BLOCK_ROWS;
+    if (offset >= it->size()) {
+        return nullptr;
+    }
+    const QVariantList &values = it->at(offset);
+    int groupColumn = column % COLUMN_GROUP_SIZE;
+    return groupColumn < values.size() ? &values[groupColumn] : nullptr;
+}
+
+int ResultsTableModel::columnGroupCount() const
+{
+    return (m_columnNames.size() + COLUMN_GROUP_SIZE - 1) / COLUMN_GROUP_SIZE;
+}
+
+QStringList ResultsTableModel::chunkColumns(int group) const
+{
+    int first = group * COLUMN_GROUP_SIZE;
+    int last = qMin(first + COLUMN_GROUP_SIZE, static_cast<int>(m_columnNames.size()));
+
+    bool allColumns = first == 0 && last == m_columnNames.size();
+    QStringList columns;
+    for (int column = first; column < last; ++column) {
+        if (m_hiddenColumns.contains(column)) {
+            // Keep the position so the row still lines up with the group's columns
+            columns.append("NULL");
+            allColumns = false;
+        } else {
+            columns.append(DuckDBManager::quoteIdentifier(m_columnNames[column]));
+        }
+    }
+    // A narrow result with nothing hidden reads everything, as a plain SELECT * would
+    return allColumns ? QStringList() : columns;
 }
 
-void ResultsTableModel::setRowsPerPage(int rowsPerPage)
+void ResultsTableModel::requestChunk(qint64 block, int group)
 {
-    if (rowsPerPage <= 0 || m_rowsPerPage == rowsPerPage) {
+    if (!m_spill || !m_dbManager || block < 0 || block * BLOCK_ROWS >= m_totalRows ||
+        group < 0 || group >= columnGroupCount()) {
         return;
     }
-    
-    beginResetModel();
-    
-    int oldTotalPages = getTotalPages();
-    m_rowsPerPage = rowsPerPage;
-    int newTotalPages = getTotalPages();
-    
-    if (m_currentPage >= newTotalPages) {
-        m_currentPage = qMax(0, newTotalPages - 1);
+
+    qint64 key = chunkKey(block, group);
+    if ((block + 1) * BLOCK_ROWS <= m_allData.size() || m_blockCache.contains(key) ||
+        m_pendingFetches.contains(key)) {
+        return;
+    }
+
+    int first = group * COLUMN_GROUP_SIZE;
+    int last = qMin(first + COLUMN_GROUP_SIZE, static_cast<int>(m_columnNames.size()));
+    bool anyVisible = false;
+    for (int column = first; column < last && !anyVisible; ++column) {
+        anyVisible = !m_hiddenColumns.contains(column);
+    }
+    if (!anyVisible) {
+        return;
+    }
+
+    // Newest requests are served first; old ones that scrolled away fall off the front
+    m_wantedChunks.removeOne(key);
+    m_wantedChunks.append(key);
+    while (m_wantedChunks.size() > MAX_WANTED_CHUNKS) {
+        m_wantedChunks.removeFirst();
     }
-    
-    updateVisibleData();
-    
-    endResetModel();
-    
-    emit pageChanged(m_currentPage, newTotalPages);
 }
 
-void ResultsTableModel::updateVisibleData()
+void ResultsTableModel::prefetchAround(qint64 block, int group)
 {
-    m_visibleData.clear();
-    
-    if (m_allData.isEmpty() || m_rowsPerPage <= 0) {
+    // The column groups either side first, so horizontal scrolling finds them loaded...
+    requestChunk(block, group - 1);
+    requestChunk(block, group + 1);
+    // ...then the rows above and below, nearest last so they are fetched first
+    for (int distance = PREFETCH_BLOCKS; distance >= 1; --distance) {
+        requestChunk(block - distance, group);
+        requestChunk(block + distance, group);
+    }
+}
+
+void ResultsTableModel::startFetches()
+{
+    while (m_pendingFetches.size() < MAX_CONCURRENT_FETCHES && !m_wantedChunks.isEmpty()) {
+        qint64 key = m_wantedChunks.takeLast();
+        if (m_blockCache.contains(key) || m_pendingFetches.contains(key)) {
+            continue;
+        }
+
+        qint64 block = key / MAX_COLUMN_GROUPS;
+        int group = static_cast<int>(key % MAX_COLUMN_GROUPS);
+        int version = m_groupVersions.value(group);
+
+        // Grid blocks get their own pool so exports and profiling cannot hold up scrolling
+        BackgroundTask *task = new BackgroundTask(this);
+        task->setThreadPool(BackgroundTask::interactivePool());
+        m_pendingFetches.insert(key, task);
+
+        auto result = std::make_shared<DuckDBManager::QueryResult>();
+        connect(task, &BackgroundTask::finished, this, [this, task, key, version, result](bool cancelled) {
+            m_pendingFetches.remove(key);
+            task->deleteLater();
+            if (!cancelled) {
+                onChunkFetched(key, version, *result);
+            }
+            startFetches();
+        });
+
+        // Only this group's columns are read; hidden ones are projected away as NULL
+        std::shared_ptr<DuckDBManager> dbManager = m_dbManager;
+        std::shared_ptr<DuckDBManager::SpillFile> spill = m_spill;
+        QStringList columns = chunkColumns(group);
+        task->start([dbManager, spill, block, columns, result](BackgroundTask::Control &) {
+            *result = dbManager->readSpillRows(*spill, block * BLOCK_ROWS, BLOCK_ROWS, columns);
+        });
+    }
+}
+
+void ResultsTableModel::onChunkFetched(qint64 key, int version, const DuckDBManager::QueryResult &result)
+{
+    qint64 block = key / MAX_COLUMN_GROUPS;
+    int group = static_cast<int>(key % MAX_COLUMN_GROUPS);
+
+    if (!result.success) {
+        qWarning() << "Failed to fetch result block" << block << "columns group" << group << ":" << result.error;
         return;
     }
-    
-    int startRow = m_currentPage * m_rowsPerPage;
-    int endRow = qMin(startRow + m_rowsPerPage, m_allData.size());
-    
-    for (int i = startRow; i < endRow; ++i) {
-        m_visibleData.append(m_allData[i]);
+
+    // A column of this group was unhidden while the fetch ran, so it read NULL for it; the
+    // dataChanged below makes the view ask again
+    if (version == m_groupVersions.value(group)) {
+        m_blockCache.insert(key, result.rows);
+        m_blockLru.removeOne(key);
+        m_blockLru.append(key);
+
+        // Evict the least recently viewed chunks so memory stays bounded however far the user scrolls
+        while (m_blockCache.size() > MAX_CACHED_CHUNKS && !m_blockLru.isEmpty()) {
+            m_blockCache.remove(m_blockLru.takeFirst());
+        }
+    }
+
+    qint64 firstRow = block * BLOCK_ROWS;
+    qint64 lastRow = qMin<qint64>(firstRow + qMax<qint64>(result.rows.size(), 1), m_totalRows) - 1;
+    if (m_reversed) {
+        qint64 reversedFirst = m_totalRows - 1 - lastRow;
+        lastRow = m_totalRows - 1 - firstRow;
+        firstRow = reversedFirst;
+    }
+    int firstColumn = group * COLUMN_GROUP_SIZE;
+    int lastColumn = qMin(firstColumn + COLUMN_GROUP_SIZE, static_cast<int>(m_columnNames.size())) - 1;
+    if (firstRow < INT_MAX && lastRow >= firstRow && lastColumn >= firstColumn) {
+        emit dataChanged(index(static_cast<int>(firstRow), firstColumn),
+                         index(static_cast<int>(qMin<qint64>(lastRow, INT_MAX - 1)), lastColumn));
     }
 }
 
-QString ResultsTableModel::formatValue(const QVariant &value) const
+void ResultsTableModel::touchChunk(qint64 key) const
+{
+    m_lastTouchedChunk = key;
+    if (m_blockCache.contains(key)) {
+        m_blockLru.removeOne(key);
+        m_blockLru.append(key);
+    }
+}
+
+void ResultsTableModel::cancelFetches()
+{
+    // Deleting a task detaches its fetch, so the late result is dropped without waiting for it
+    for (BackgroundTask *task : std::as_const(m_pendingFetches)) {
+        task->cancel();
+        delete task;
+    }
+    for (BackgroundTask *task : std::as_const(m_pendingPages)) {
+        task->cancel();
+        delete task;
+    }
+    m_pendingFetches.clear();
+    m_wantedChunks.clear();
+    m_pendingPages.clear();
+    m_wantedPages.clear();
+}
+
+void ResultsTableModel::requestPage(int page)
+{
+    if (!m_compressed || page < 0 || page >= m_compressed->pageCount() ||
+        m_pageCache.contains(page) || m_pendingPages.contains(page)) {
+        return;
+    }
+
+    // Newest requests are served first, as for spilled chunks
+    m_wantedPages.removeOne(page);
+    m_wantedPages.append(page);
+    while (m_wantedPages.size() > MAX_WANTED_CHUNKS) {
+        m_wantedPages.removeFirst();
+    }
+}
+
+void ResultsTableModel::startPageLoads()
+{
+    while (m_pendingPages.size() < MAX_CONCURRENT_FETCHES && !m_wantedPages.isEmpty()) {
+        int page = m_wantedPages.takeLast();
+        if (m_pageCache.contains(page) || m_pendingPages.contains(page)) {
+            continue;
+        }
+
+        BackgroundTask *task = new BackgroundTask(this);
+        task->setThreadPool(BackgroundTask::interactivePool());
+        m_pendingPages.insert(page, task);
+
+        std::shared_ptr<CompressedResult> compressed = m_compressed;
+        auto rows = std::make_shared<QList<QVariantList>>();
+        connect(task, &BackgroundTask::finished, this, [this, task, page, compressed, rows](bool cancelled) {
+            m_pendingPages.remove(page);
+            task->deleteLater();
+            if (!cancelled && compressed == m_compressed) {
+                onPageLoaded(page, *rows);
+            }
+            startPageLoads();
+        });
+        task->start([compressed, page, rows](BackgroundTask::Control &) {
+            *rows = compressed->page(page);
+        });
+    }
+}
+
+void ResultsTableModel::onPageLoaded(int page, const QList<QVariantList> &rows)
+{
+    while (m_pageCache.size() >= MAX_CACHED_PAGES && !m_pageLru.isEmpty()) {
+        BackgroundTask::release(std::make_shared<QList<QVariantList>>(m_pageCache.take(m_pageLru.takeFirst())));
+    }
+    m_pageCache.insert(page, rows);
+    m_pageLru.removeOne(page);
+    m_pageLru.append(page);
+
+    qint64 firstRow = static_cast<qint64>(page) * CompressedResult::PAGE_ROWS;
+    qint64 lastRow = qMin<qint64>(firstRow + CompressedResult::PAGE_ROWS, m_totalRows) - 1;
+    if (m_reversed) {
+        qint64 reversedFirst = m_totalRows - 1 - lastRow;
+        lastRow = m_totalRows - 1 - firstRow;
+        firstRow = reversedFirst;
+    }
+    if (firstRow < INT_MAX && lastRow >= firstRow && !m_columnNames.isEmpty()) {
+        emit dataChanged(index(static_cast<int>(firstRow), 0),
+                         index(static_cast<int>(qMin<qint64>(lastRow, INT_MAX - 1)), m_columnNames.size() - 1));
+    }
+}
+
+QString ResultsTableModel::displayText(qint64 row, int column, const QVariant &value) const
+{
+    // Formatted strings are cached per chunk of result rows and columns, so repaints and
+    // scrolling back over a region do not format the same cells again
+    int group = column / COLUMN_GROUP_SIZE;
+    int groupWidth = qMin(COLUMN_GROUP_SIZE, static_cast<int>(m_columnNames.size()) - group * COLUMN_GROUP_SIZE);
+    qint64 key = chunkKey(row / BLOCK_ROWS, group);
+    auto it = m_displayCache.find(key);
+    if (it == m_displayCache.end()) {
+        while (m_displayCache.size() >= MAX_DISPLAY_CHUNKS && !m_displayLru.isEmpty()) {
+            m_displayCache.remove(m_displayLru.takeFirst());
+        }
+        DisplayBlock displayBlock;
+        displayBlock.text.resize(static_cast<size_t>(BLOCK_ROWS) * qMax(groupWidth, 0));
+        displayBlock.ready.resize(displayBlock.text.size(), false);
+        it = m_displayCache.insert(key, std::move(displayBlock));
+        m_displayLru.append(key);
+        m_lastDisplayChunk = key;
+    } else if (key != m_lastDisplayChunk) {
+        m_displayLru.removeOne(key);
+        m_displayLru.append(key);
+        m_lastDisplayChunk = key;
+    }
+
+    size_t slot = static_cast<size_t>(row % BLOCK_ROWS) * qMax(groupWidth, 0) + column % COLUMN_GROUP_SIZE;
+    if (slot >= it->text.size()) {
+        return formatValue(value);
+    }
+    if (!it->ready[slot]) {
+        it->text[slot] = formatValue(value);
+        it->ready[slot] = true;
+    }
+    return it->text[slot];
+}
+
+QString ResultsTableModel::formatValue(const QVariant &value)
 {
     if (value.isNull()) {
         return "<NULL>";
     }
 
     switch (value.typeId()) {
-    case QMetaType::Double: {
-        double d = value.toDouble();
-        if (d == static_cast<int>(d)) {
-            return QString::number(static_cast<int>(d));
-        }
-        return QString::number(d, 'f', 6).remove(QRegularExpression("\\.?0+$"));
-    }
+    case QMetaType::Double:
+        return formatDouble(value.toDouble());
     case QMetaType::QString: {
         QString str = value.toString();
         if (str.length() > 200) {
@@ -224,85 +779,45 @@ QString ResultsTableModel::formatValue(const QVariant &value) const
     case QMetaType::Bool:
         return value.toBool() ? "true" : "false";
     default:
+        if (isTruncated(value)) {
+            return value.value<DuckDBManager::TruncatedText>().prefix + "...";
+        }
         return value.toString();
     }
 }
 
-bool ResultsTableModel::exportToCSV(const QString &filePath) const
+QString ResultsTableModel::formatDouble(double d)
 {
-    return exportToDelimitedFile(filePath, ",");
-}
-
-bool ResultsTableModel::exportToTSV(const QString &filePath) const
-{
-    return exportToDelimitedFile(filePath, "\t");
-}
-
-bool ResultsTableModel::exportToDelimitedFile(const QString &filePath, const QString &delimiter) const
-{
-    try {
-        if (m_allData.isEmpty()) {
-            qWarning() << "No data to export";
-            return false;
-        }
+    // Whole numbers print without a fraction; others with up to 6 decimals and no trailing zeros
+    if (std::isfinite(d) && d == std::trunc(d) && std::fabs(d) < 1e15) {
+        return QString::number(static_cast<qint64>(d));
+    }
 
-        QFile file(filePath);
-        if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            qWarning() << "Failed to open file for export:" << filePath;
-            return false;
+    char buffer[64];
+    int length = -1;
+#if defined(__cpp_lib_to_chars)
+    std::to_chars_result converted = std::to_chars(buffer, buffer + sizeof(buffer), d, std::chars_format::fixed, 6);
+    if (converted.ec == std::errc()) {
+        length = static_cast<int>(converted.ptr - buffer);
+    }
+#endif
+    if (length < 0) {
+        // No floating-point to_chars in this standard library, or a value too wide for the buffer
+        QByteArray text = QByteArray::number(d, 'f', 6);
+        if (text.size() > static_cast<int>(sizeof(buffer))) {
+            return QString::fromLatin1(text);
         }
+        length = static_cast<int>(text.size());
+        std::memcpy(buffer, text.constData(), static_cast<size_t>(length));
+    }
 
-        QTextStream out(&file);
-
-        // Write header
-        try {
-            for (int i = 0; i < m_columnNames.size(); ++i) {
-                if (i > 0) out << delimiter;
-                QString colName = m_columnNames[i];
-                // Quote if contains delimiter, newline, or quote
-                if (colName.contains(delimiter) || colName.contains('\n') || colName.contains('"')) {
-                    colName.replace("\"", "\"\"");
-                    out << "\"" << colName << "\"";
-                } else {
-                    out << colName;
-                }
-            }
-            out << "\n";
-        } catch (const std::exception &e) {
-            qCritical() << "Error writing header:" << e.what();
-            file.close();
-            return false;
+    if (std::memchr(buffer, '.', static_cast<size_t>(length))) {
+        while (length > 0 && buffer[length - 1] == '0') {
+            --length;
         }
-
-        // Write data
-        try {
-            for (const QVariantList &row : m_allData) {
-                for (int i = 0; i < row.size(); ++i) {
-                    if (i > 0) out << delimiter;
-                    QString value = formatValue(row[i]);
-                    // Quote if contains delimiter, newline, or quote
-                    if (value.contains(delimiter) || value.contains('\n') || value.contains('"')) {
-                        value.replace("\"", "\"\"");
-                        out << "\"" << value << "\"";
-                    } else {
-                        out << value;
-                    }
-                }
-                out << "\n";
-            }
-        } catch (const std::exception &e) {
-            qCritical() << "Error writing data rows:" << e.what();
-            file.close();
-            return false;
+        if (length > 0 && buffer[length - 1] == '.') {
+            --length;
         }
-
-        file.close();
-        return true;
-    } catch (const std::exception &e) {
-        qCritical() << "ResultsTableModel::exportToDelimitedFile exception:" << e.what();
-        return false;
-    } catch (...) {
-        qCritical() << "ResultsTableModel::exportToDelimitedFile unknown exception";
-        return false;
     }
-}
\ No newline at end of file
+    return QString::fromLatin1(buffer, length);
+}
@@ -120,10 +120,12 @@ bool SQLExecutor::isExecuting() const
     return m_isExecuting;
 }
 
-DuckDBManager::QueryResult SQLExecutor::getResults() const
+DuckDBManager::QueryResult SQLExecutor::takeResults()
 {
     QMutexLocker locker(&m_resultsMutex);
-    return m_lastResults;
+    DuckDBManager::QueryResult results = std::move(m_lastResults);
+    m_lastResults = DuckDBManager::QueryResult();
+    return results;
 }
 
 void SQLExecutor::cancelExecution()
@@ -154,9 +156,10 @@ void SQLExecutor::onQueryFinished(bool success, const QString &error, const Duck
         emit queryExecuted(success, error);
 
         if (success) {
-            emit executionProgress(QString("Query completed in %1ms, %2 rows returned")
+            emit executionProgress(QString("Query completed in %1ms, %2 rows returned%3")
                                   .arg(result.executionTimeMs)
-                                  .arg(result.totalRows));
+                                  .arg(result.totalRows)
+                                  .arg(result.isSpilled() ? " (spilled to disk)" : ""));
             emit resultsReady();
         } else {
             emit executionProgress("Query failed");